@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_c++17.dir/test_c++17.cpp.o"
+  "CMakeFiles/test_c++17.dir/test_c++17.cpp.o.d"
+  "test_c++17"
+  "test_c++17.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_c++17.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
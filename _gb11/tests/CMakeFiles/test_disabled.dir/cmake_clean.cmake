@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_disabled.dir/test_disabled.cpp.o"
+  "CMakeFiles/test_disabled.dir/test_disabled.cpp.o.d"
+  "test_disabled"
+  "test_disabled.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_disabled.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
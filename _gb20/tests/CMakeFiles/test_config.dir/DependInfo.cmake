@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/test_2.cpp" "tests/CMakeFiles/test_config.dir/test_2.cpp.o" "gcc" "tests/CMakeFiles/test_config.dir/test_2.cpp.o.d"
+  "/root/repo/tests/test_config.cpp" "tests/CMakeFiles/test_config.dir/test_config.cpp.o" "gcc" "tests/CMakeFiles/test_config.dir/test_config.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_config.dir/test_2.cpp.o"
+  "CMakeFiles/test_config.dir/test_2.cpp.o.d"
+  "CMakeFiles/test_config.dir/test_config.cpp.o"
+  "CMakeFiles/test_config.dir/test_config.cpp.o.d"
+  "test_config"
+  "test_config.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_config.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_levels.dir/test_levels.cpp.o"
+  "CMakeFiles/test_levels.dir/test_levels.cpp.o.d"
+  "test_levels"
+  "test_levels.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_levels.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_strings_c++11.dir/test_strings_c++11.cpp.o"
+  "CMakeFiles/test_strings_c++11.dir/test_strings_c++11.cpp.o.d"
+  "test_strings_c++11"
+  "test_strings_c++11.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_strings_c++11.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
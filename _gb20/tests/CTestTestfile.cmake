@@ -0,0 +1,28 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_gb20/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_c++11 "/root/repo/_gb20/tests/test_c++11")
+set_tests_properties(test_c++11 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;42;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_strings_c++11 "/root/repo/_gb20/tests/test_strings_c++11")
+set_tests_properties(test_strings_c++11 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;43;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_config "/root/repo/_gb20/tests/test_config")
+set_tests_properties(test_config PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;44;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_slicing "/root/repo/_gb20/tests/test_slicing")
+set_tests_properties(test_slicing PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;46;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_disabled "/root/repo/_gb20/tests/test_disabled")
+set_tests_properties(test_disabled PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;47;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_levels "/root/repo/_gb20/tests/test_levels")
+set_tests_properties(test_levels PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;48;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_parallel "/root/repo/_gb20/tests/test_parallel")
+set_tests_properties(test_parallel PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;49;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_c++17 "/root/repo/_gb20/tests/test_c++17")
+set_tests_properties(test_c++17 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;60;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_strings_c++17 "/root/repo/_gb20/tests/test_strings_c++17")
+set_tests_properties(test_strings_c++17 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;61;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_c++20 "/root/repo/_gb20/tests/test_c++20")
+set_tests_properties(test_c++20 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;65;declare_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_strings_c++20 "/root/repo/_gb20/tests/test_strings_c++20")
+set_tests_properties(test_strings_c++20 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;29;add_test;/root/repo/tests/CMakeLists.txt;66;declare_test;/root/repo/tests/CMakeLists.txt;0;")
@@ -24,13 +24,20 @@
 #ifndef ICECREAM_HPP_INCLUDED
 #define ICECREAM_HPP_INCLUDED
 
+#include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <cassert>
 #include <cerrno>
+#include <chrono>
 #include <climits>
 #include <clocale>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cwchar>
 #include <exception>
 #include <functional>
@@ -39,6 +46,8 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <locale>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <ostream>
@@ -47,6 +56,7 @@
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -111,6 +121,22 @@
     #endif
 #endif
 
+// ICECREAM_PARALLEL is the macro which can be defined to allow the formatting of huge
+// ranges by multiple threads.
+#if defined(ICECREAM_PARALLEL)
+    #include <condition_variable>
+    #include <deque>
+    #include <system_error>
+    #include <thread>
+#endif
+
+#if defined(__has_include) && __has_include(<charconv>)
+    #include <charconv>
+    #if defined(__cpp_lib_to_chars)
+        #define ICECREAM_TO_CHARS
+    #endif
+#endif
+
 #if defined(__has_include) && __has_include(<format>)
     #include <format>
     #if defined(__cpp_lib_format) || (defined(_LIBCPP_VERSION) && _LIBCPP_VERSION >= 170000 && __cplusplus >= 202002L)
@@ -174,6 +200,22 @@
     #define ICECREAM_FUNCTION __func__
 #endif
 
+// The column of a call site, telling apart the IC calls written on a same line. It is 0
+// when the compiler has no way to get it.
+#if defined(ICECREAM_SOURCE_LOCATION)
+    #define ICECREAM_COLUMN static_cast<int>(std::source_location::current().column())
+#elif defined(__clang__) && defined(__has_builtin)
+    #if __has_builtin(__builtin_COLUMN)
+        #define ICECREAM_COLUMN __builtin_COLUMN()
+    #else
+        #define ICECREAM_COLUMN 0
+    #endif
+#elif defined(_MSC_VER) && (_MSC_VER >= 1926)
+    #define ICECREAM_COLUMN __builtin_COLUMN()
+#else
+    #define ICECREAM_COLUMN 0
+#endif
+
 // Used to force MSVC to unpack __VA_ARGS__
 #define ICECREAM_EXPAND(X) X
 
@@ -249,10 +291,115 @@
 #define ICECREAM_APPLY(fmt, argument_names, N, ...)                       \
     ICECREAM_EXPAND(ICECREAM_APPLY_(fmt, argument_names, N, __VA_ARGS__))
 
-#define ICECREAM_DISPATCH(is_ic_apply, fmt, argument_names)                                                           \
-    ::icecream::detail::Dispatcher{                                                                                   \
-        is_ic_apply, icecream_private_config_5f803a3bcdb4, __FILE__, __LINE__, ICECREAM_FUNCTION, fmt, argument_names \
-    }
+// The call site information is only built when the config is enabled, so that a disabled
+// call costs a single test.
+#define ICECREAM_DISPATCH_(is_ic_apply, tag, fmt, argument_names)                             \
+    (ICECREAM_UNLIKELY(icecream_private_config_5f803a3bcdb4.is_enabled())                     \
+        ? ::icecream::detail::Dispatcher{                                                      \
+            is_ic_apply, icecream_private_config_5f803a3bcdb4,                                 \
+            ::icecream::detail::site_filter_slot<__LINE__>(),                                  \
+            ::icecream::detail::make_site_tag(tag),                                            \
+            __FILE__, __LINE__, ICECREAM_COLUMN, ICECREAM_FUNCTION, fmt, argument_names        \
+        }                                                                                      \
+        : ::icecream::detail::Dispatcher::disabled(icecream_private_config_5f803a3bcdb4))
+
+#define ICECREAM_DISPATCH(is_ic_apply, fmt, argument_names) \
+    ICECREAM_DISPATCH_(is_ic_apply, "", fmt, argument_names)
+
+// The IC arguments will only be evaluated if `condition` is true and the call site is
+// enabled. The `level` is the optional severity of a leveled call.
+#if defined(ICECREAM_DISABLE)
+    #define ICECREAM_IF_(condition, level, argument_names, ...)                            \
+        (false                                                                             \
+            ? ((void)(condition),                                                          \
+               (void)ICECREAM_DISPATCH_(false, "", "", argument_names)                     \
+                   .at_level(level)                                                        \
+                   .unary_run(__VA_ARGS__))                                                \
+            : (void)0)
+#else
+    #define ICECREAM_IF_(condition, level, argument_names, ...)                            \
+        (((condition)                                                                      \
+          && ICECREAM_UNLIKELY(                                                            \
+              ICECREAM_DISPATCH_(false, "", "", argument_names).is_active()))              \
+            ? ICECREAM_DISPATCH_(false, "", "", argument_names)                            \
+                  .at_level(level)                                                         \
+                  .if_run(__VA_ARGS__)                                                     \
+            : (void)0)
+#endif
+
+#define ICECREAM_NO_LEVEL_ ::icecream::detail::Optional<::icecream::Level>{}
+
+// The value will only be printed if it has changed since the last time this call site has
+// seen it.
+#define ICECREAM_ON_CHANGE_(argument_name, value)                                        \
+    ICECREAM_DISPATCH_(false, "", "", argument_name)                                     \
+        .change_run(::icecream::detail::site_change_slot<__LINE__>(), value)
+
+// The changed elements of the range `value` will be printed, relative to the last time
+// this call site has seen it.
+#define ICECREAM_WATCH_(argument_name, value)                                            \
+    ICECREAM_DISPATCH_(false, "", "", argument_name)                                     \
+        .watch_run(::icecream::detail::site_watch_slot<__LINE__>(), value)
+
+// The severity levels of the leveled IC macros. Any call site with a level lower than
+// ICECREAM_MIN_LEVEL will be stripped out at compile time.
+#define ICECREAM_LEVEL_TRACE 0
+#define ICECREAM_LEVEL_DEBUG 1
+#define ICECREAM_LEVEL_INFO 2
+#define ICECREAM_LEVEL_WARN 3
+#define ICECREAM_LEVEL_ERROR 4
+
+#if !defined(ICECREAM_MIN_LEVEL)
+    #define ICECREAM_MIN_LEVEL ICECREAM_LEVEL_TRACE
+#endif
+
+// A stripped out call site. The arguments are within an unevaluated operand only to be
+// seen as used, silencing any unused variable warning.
+#define ICECREAM_STRIPPED_(...) \
+    ((void)sizeof(::icecream::detail::swallow_arguments(__VA_ARGS__)))
+
+#define ICECREAM_LEVELED_(severity, argument_names, ...)                        \
+    ICECREAM_IF_(                                                               \
+        (severity) >= icecream_private_config_5f803a3bcdb4.level(),             \
+        severity,                                                               \
+        argument_names,                                                         \
+        __VA_ARGS__                                                             \
+    )
+
+#if ICECREAM_MIN_LEVEL <= ICECREAM_LEVEL_TRACE
+    #define ICECREAM_TRACE_(argument_names, ...) \
+        ICECREAM_LEVELED_(::icecream::Level::trace, argument_names, __VA_ARGS__)
+#else
+    #define ICECREAM_TRACE_(argument_names, ...) ICECREAM_STRIPPED_(__VA_ARGS__)
+#endif
+
+#if ICECREAM_MIN_LEVEL <= ICECREAM_LEVEL_DEBUG
+    #define ICECREAM_DEBUG_(argument_names, ...) \
+        ICECREAM_LEVELED_(::icecream::Level::debug, argument_names, __VA_ARGS__)
+#else
+    #define ICECREAM_DEBUG_(argument_names, ...) ICECREAM_STRIPPED_(__VA_ARGS__)
+#endif
+
+#if ICECREAM_MIN_LEVEL <= ICECREAM_LEVEL_INFO
+    #define ICECREAM_INFO_(argument_names, ...) \
+        ICECREAM_LEVELED_(::icecream::Level::info, argument_names, __VA_ARGS__)
+#else
+    #define ICECREAM_INFO_(argument_names, ...) ICECREAM_STRIPPED_(__VA_ARGS__)
+#endif
+
+#if ICECREAM_MIN_LEVEL <= ICECREAM_LEVEL_WARN
+    #define ICECREAM_WARN_(argument_names, ...) \
+        ICECREAM_LEVELED_(::icecream::Level::warn, argument_names, __VA_ARGS__)
+#else
+    #define ICECREAM_WARN_(argument_names, ...) ICECREAM_STRIPPED_(__VA_ARGS__)
+#endif
+
+#if ICECREAM_MIN_LEVEL <= ICECREAM_LEVEL_ERROR
+    #define ICECREAM_ERROR_(argument_names, ...) \
+        ICECREAM_LEVELED_(::icecream::Level::error, argument_names, __VA_ARGS__)
+#else
+    #define ICECREAM_ERROR_(argument_names, ...) ICECREAM_STRIPPED_(__VA_ARGS__)
+#endif
 
 #if defined(ICECREAM_LONG_NAME)
     #define ICECREAM(...) ICECREAM_DISPATCH(false, "", #__VA_ARGS__).unary_run(__VA_ARGS__)
@@ -262,8 +409,19 @@
     #define ICECREAM_A0(callable) ICECREAM_APPLY_0(callable)
     #define ICECREAM_FA(fmt, ...) ICECREAM_APPLY(fmt, #__VA_ARGS__, ICECREAM_ARGS_SIZE(__VA_ARGS__), __VA_ARGS__)
     #define ICECREAM_(...) ::icecream::detail::make_formatting_argument(__VA_ARGS__)
-    #define ICECREAM_V(...) ::icecream::detail::IC_V_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, __LINE__, __FILE__, ICECREAM_FUNCTION)
-    #define ICECREAM_FV(...) ::icecream::detail::IC_FV_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, __LINE__, __FILE__, ICECREAM_FUNCTION)
+    #define ICECREAM_V(...) ::icecream::detail::IC_V_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, ::icecream::detail::site_filter_slot<__LINE__>(), __LINE__, ICECREAM_COLUMN, __FILE__, ICECREAM_FUNCTION)
+    #define ICECREAM_FV(...) ::icecream::detail::IC_FV_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, ::icecream::detail::site_filter_slot<__LINE__>(), __LINE__, ICECREAM_COLUMN, __FILE__, ICECREAM_FUNCTION)
+    #define ICECREAM_IF(condition, ...) ICECREAM_IF_(condition, ICECREAM_NO_LEVEL_, #__VA_ARGS__, __VA_ARGS__)
+    #define ICECREAM_TAG(tag, ...) ICECREAM_DISPATCH_(false, tag, "", #__VA_ARGS__).unary_run(__VA_ARGS__)
+    #define ICECREAM_BYTES(value) ICECREAM_DISPATCH(false, "hexdump", #value).bytes_run(value)
+    #define ICECREAM_ON_CHANGE(value) ICECREAM_ON_CHANGE_(#value, value)
+    #define ICECREAM_WATCH(value) ICECREAM_WATCH_(#value, value)
+    #define ICECREAM_CMP(...) ICECREAM_DISPATCH(false, "", #__VA_ARGS__).cmp_run(__VA_ARGS__)
+    #define ICECREAM_TRACE(...) ICECREAM_TRACE_(#__VA_ARGS__, __VA_ARGS__)
+    #define ICECREAM_DEBUG(...) ICECREAM_DEBUG_(#__VA_ARGS__, __VA_ARGS__)
+    #define ICECREAM_INFO(...) ICECREAM_INFO_(#__VA_ARGS__, __VA_ARGS__)
+    #define ICECREAM_WARN(...) ICECREAM_WARN_(#__VA_ARGS__, __VA_ARGS__)
+    #define ICECREAM_ERROR(...) ICECREAM_ERROR_(#__VA_ARGS__, __VA_ARGS__)
 
     #if defined(__GNUC__)
         // Disable global and outer scope name shadowing warnings
@@ -297,8 +455,19 @@
     #define IC_A0(callable) ICECREAM_APPLY_0(callable)
     #define IC_FA(fmt, ...) ICECREAM_APPLY(fmt, #__VA_ARGS__, ICECREAM_ARGS_SIZE(__VA_ARGS__), __VA_ARGS__)
     #define IC_(...) ::icecream::detail::make_formatting_argument(__VA_ARGS__)
-    #define IC_V(...) ::icecream::detail::IC_V_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, __LINE__, __FILE__, ICECREAM_FUNCTION)
-    #define IC_FV(...) ::icecream::detail::IC_FV_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, __LINE__, __FILE__, ICECREAM_FUNCTION)
+    #define IC_V(...) ::icecream::detail::IC_V_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, ::icecream::detail::site_filter_slot<__LINE__>(), __LINE__, ICECREAM_COLUMN, __FILE__, ICECREAM_FUNCTION)
+    #define IC_FV(...) ::icecream::detail::IC_FV_(__VA_ARGS__).complete(icecream_private_config_5f803a3bcdb4, ::icecream::detail::site_filter_slot<__LINE__>(), __LINE__, ICECREAM_COLUMN, __FILE__, ICECREAM_FUNCTION)
+    #define IC_IF(condition, ...) ICECREAM_IF_(condition, ICECREAM_NO_LEVEL_, #__VA_ARGS__, __VA_ARGS__)
+    #define IC_TAG(tag, ...) ICECREAM_DISPATCH_(false, tag, "", #__VA_ARGS__).unary_run(__VA_ARGS__)
+    #define IC_BYTES(value) ICECREAM_DISPATCH(false, "hexdump", #value).bytes_run(value)
+    #define IC_ON_CHANGE(value) ICECREAM_ON_CHANGE_(#value, value)
+    #define IC_WATCH(value) ICECREAM_WATCH_(#value, value)
+    #define IC_CMP(...) ICECREAM_DISPATCH(false, "", #__VA_ARGS__).cmp_run(__VA_ARGS__)
+    #define IC_TRACE(...) ICECREAM_TRACE_(#__VA_ARGS__, __VA_ARGS__)
+    #define IC_DEBUG(...) ICECREAM_DEBUG_(#__VA_ARGS__, __VA_ARGS__)
+    #define IC_INFO(...) ICECREAM_INFO_(#__VA_ARGS__, __VA_ARGS__)
+    #define IC_WARN(...) ICECREAM_WARN_(#__VA_ARGS__, __VA_ARGS__)
+    #define IC_ERROR(...) ICECREAM_ERROR_(#__VA_ARGS__, __VA_ARGS__)
 
     #if defined(__GNUC__)
         // Disable global and outer scope name shadowing warnings
@@ -329,6 +498,23 @@
 
 #define ICECREAM_UNREACHABLE assert(((void)"Should not reach here. Please report the bug", false))
 
+// The printing code is expected to be taken out of the hot paths by disabling the IC
+// macros, so that the test of the enabled flag should be the only cost paid there. These
+// are used to lay out the printing code as a cold branch.
+#if defined(__GNUC__)
+    #define ICECREAM_LIKELY(x) __builtin_expect(!!(x), 1)
+    #define ICECREAM_UNLIKELY(x) __builtin_expect(!!(x), 0)
+    #define ICECREAM_COLD __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+    #define ICECREAM_LIKELY(x) (x)
+    #define ICECREAM_UNLIKELY(x) (x)
+    #define ICECREAM_COLD __declspec(noinline)
+#else
+    #define ICECREAM_LIKELY(x) (x)
+    #define ICECREAM_UNLIKELY(x) (x)
+    #define ICECREAM_COLD
+#endif
+
 
 namespace boost
 {
@@ -371,6 +557,11 @@ namespace icecream{ namespace detail
     using std::to_string;
 
 
+    // Only used within unevaluated operands, see ICECREAM_STRIPPED_.
+    template <typename... Ts>
+    auto swallow_arguments(Ts&&...) -> int;
+
+
     // -------------------------------------------------- is_instantiation
 
     // Checks if a type T (like std::pair<int, float>) is an instantiation of a template
@@ -680,6 +871,27 @@ namespace icecream{ namespace detail
         >::type;
 
 
+    // -------------------------------------------------- is_multipass_iterator
+
+    // A single pass iterator, like std::istream_iterator, has the same syntax as a forward
+    // one. Only its declared iterator concept, or category, tells them apart.
+    template <typename I>
+    auto is_multipass_iterator_impl(int) ->
+        std::is_base_of<std::forward_iterator_tag, typename I::iterator_concept>;
+
+    template <typename I>
+    auto is_multipass_iterator_impl(long) ->
+        std::is_base_of<
+            std::forward_iterator_tag, typename std::iterator_traits<I>::iterator_category
+        >;
+
+    template <typename I>
+    auto is_multipass_iterator_impl(...) -> is_forward_iterator<I>;
+
+    template <typename I>
+    using is_multipass_iterator = decltype(is_multipass_iterator_impl<I>(0));
+
+
     // -------------------------------------------------- is_forward_range
 
     template <typename R>
@@ -721,6 +933,73 @@ namespace icecream{ namespace detail
         >::type;
 
 
+    // -------------------------------------------------- is_random_access_iterator
+
+    template <typename I>
+    auto is_random_access_iterator_impl(int) ->
+        decltype (
+            std::declval<I&>() += std::declval<ptrdiff_t>(),
+            std::declval<I&>() - std::declval<I&>(),
+            std::true_type{}
+        );
+
+    template <typename I>
+    auto is_random_access_iterator_impl(...) -> std::false_type;
+
+    template <typename I>
+    using is_random_access_iterator =
+        typename conjunction<
+            is_bidirectional_iterator<I>,
+            decltype(is_random_access_iterator_impl<I>(0))
+        >::type;
+
+
+    // -------------------------------------------------- is_key_sliceable
+
+    // Checks if `R` is an ordered associative container, with a key type that can be read
+    // from a std::istream.
+
+    template <typename R>
+    auto is_key_sliceable_impl(int) ->
+        decltype (
+            std::declval<R const&>().lower_bound(std::declval<typename R::key_type const&>()),
+            std::declval<R const&>().upper_bound(std::declval<typename R::key_type const&>()),
+            std::declval<R const&>().key_comp(),
+            std::declval<std::istream&>() >> std::declval<typename R::key_type&>(),
+            typename R::key_type(),
+            std::true_type{}
+        );
+
+    template <typename R>
+    auto is_key_sliceable_impl(...) -> std::false_type;
+
+    template <typename R>
+    using is_key_sliceable = decltype(is_key_sliceable_impl<remove_cvref_t<R>>(0));
+
+
+    // -------------------------------------------------- is_sized_sentinel_for
+
+    // Checks if the distance between a random access iterator `I` and a sentinel `S` can be
+    // computed in constant time.
+
+    template <typename S, typename I>
+    auto is_sized_sentinel_for_impl(int) ->
+        decltype (
+            std::declval<S const&>() - std::declval<I const&>(),
+            std::true_type{}
+        );
+
+    template <typename S, typename I>
+    auto is_sized_sentinel_for_impl(...) -> std::false_type;
+
+    template <typename S, typename I>
+    using is_sized_sentinel_for =
+        typename conjunction<
+            is_random_access_iterator<I>,
+            decltype(is_sized_sentinel_for_impl<S, I>(0))
+        >::type;
+
+
     // -------------------------------------------------- has_push_back_T
 
     // Checks if the `C` class has a push_back(`T`) method
@@ -864,6 +1143,126 @@ namespace icecream{ namespace detail
         >::type;
 
 
+    // -------------------------------------------------- is_byte
+
+    // Checks if T is a type used to access raw memory, [const, volatile]?[char, signed
+    // char, unsigned char].
+
+    template <typename T>
+    using is_byte =
+        typename disjunction<
+            std::is_same<typename std::remove_cv<T>::type, char>,
+            is_xsig_char<T>
+        >::type;
+
+
+    // -------------------------------------------------- is_bool_range
+
+    // Checks if R is a range of bool elements, including the std::vector<bool> proxy
+    // references to them.
+
+    template <typename R>
+    using is_bool_range =
+        typename disjunction<
+            std::is_same<remove_cvref_t<get_reference_t<get_iterator_t<R>>>, bool>,
+            std::is_same<
+                remove_cvref_t<get_reference_t<get_iterator_t<R>>>,
+                typename std::vector<bool>::reference
+            >
+        >::type;
+
+
+    // -------------------------------------------------- is_nonzero_range
+
+    // Checks if R is a range whose elements can be compared to zero, i.e.: a range of
+    // arithmetic values, excluding the character types, or a range of bools. The signed
+    // and unsigned chars are numbers here, as the samples of a raw buffer.
+
+    template <typename T>
+    using is_nonzero_number =
+        typename conjunction<
+            std::is_arithmetic<remove_cvref_t<T>>,
+            negation<is_character<remove_cvref_t<T>>>
+        >::type;
+
+    template <typename R>
+    using is_nonzero_range =
+        typename disjunction<
+            is_nonzero_number<get_reference_t<get_iterator_t<R>>>,
+            is_bool_range<R>
+        >::type;
+
+
+    // -------------------------------------------------- is_hashable_by_bytes
+
+    // Checks if the object representation of a T value is determined by the value alone,
+    // without any padding bits, so that it can be hashed by its bytes.
+
+    template <typename T>
+    using is_hashable_by_bytes =
+        typename disjunction<
+            std::is_integral<T>,
+            std::is_enum<T>,
+            std::is_same<T, float>,
+            std::is_same<T, double>
+        >::type;
+
+
+    // -------------------------------------------------- is_contiguous_range
+
+    // Checks if R is a range with `data()` and `size()` methods, having all its elements
+    // stored contiguously from `data()` on, like a std::vector or a std::array.
+
+    template <typename R>
+    auto is_contiguous_range_impl(int) ->
+        decltype(
+            std::declval<R&>().size(),
+            std::integral_constant<
+                bool,
+                std::is_pointer<decltype(std::declval<R&>().data())>::value
+                && std::is_same<
+                    remove_cvref_t<decltype(*std::declval<R&>().data())>,
+                    remove_cvref_t<get_reference_t<get_iterator_t<R>>>
+                >::value
+            >{}
+        );
+
+    template <typename R>
+    auto is_contiguous_range_impl(...) -> std::false_type;
+
+    template <typename R>
+    using is_contiguous_range = decltype(is_contiguous_range_impl<R>(0));
+
+
+    // -------------------------------------------------- is_int128
+
+    // Checks if T is one of the 128 bits integer types provided as a compiler extension.
+
+  #if defined(__SIZEOF_INT128__)
+    __extension__ typedef __int128 int128_t;
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    template <typename T>
+    using is_int128 =
+        typename disjunction<
+            std::is_same<typename std::remove_cv<T>::type, int128_t>,
+            std::is_same<typename std::remove_cv<T>::type, uint128_t>
+        >::type;
+  #else
+    template <typename T>
+    using is_int128 = std::false_type;
+  #endif
+
+
+    // -------------------------------------------------- is_bitset
+
+    template <typename T>
+    struct is_bitset: std::false_type {};
+
+    template <size_t N>
+    struct is_bitset<std::bitset<N>>: std::true_type {};
+
+
     // -------------------------------------------------- is_c_string
 
     // Checks if T is a C string type, i.e.: either char*, a char[], or a char[N]; of any
@@ -993,6 +1392,76 @@ namespace icecream{ namespace detail
         >::type;
 
 
+    // -------------------------------------------------- is_range_stats
+
+    // Checks if T is a RangeStats, the summary statistics of a range.
+
+    template <typename T>
+    class RangeStats;
+
+    template <typename T>
+    using is_range_stats = is_instantiation<RangeStats, typename std::remove_cv<T>::type>;
+
+
+    // -------------------------------------------------- is_comparison
+
+    // Checks if T is a Comparison, the mismatches between two ranges or tuples.
+
+    template <typename L, typename R>
+    struct Comparison;
+
+    template <typename T>
+    struct is_comparison: std::false_type {};
+
+    template <typename L, typename R>
+    struct is_comparison<Comparison<L, R>>: std::true_type {};
+
+
+    // -------------------------------------------------- is_watch_changes
+
+    // Checks if T is a WatchChanges, the changed elements of an IC_WATCH range.
+
+    struct WatchChanges;
+
+    template <typename T>
+    using is_watch_changes = std::is_same<T, WatchChanges>;
+
+
+    // -------------------------------------------------- is_mapped_range
+
+    // Checks if R is an associative container mapping keys to values, like a std::map or a
+    // std::unordered_map.
+
+    template <typename R>
+    auto is_mapped_range_impl(int) ->
+        decltype(
+            std::declval<typename R::key_type*>(),
+            std::declval<typename R::mapped_type*>(),
+            std::true_type{}
+        );
+
+    template <typename R>
+    auto is_mapped_range_impl(...) -> std::false_type;
+
+    template <typename R>
+    using is_mapped_range = decltype(is_mapped_range_impl<remove_cvref_t<R>>(0));
+
+
+    // -------------------------------------------------- is_keyed_range
+
+    // Checks if R is an associative container, whose elements are identified by a key.
+
+    template <typename R>
+    auto is_keyed_range_impl(int) ->
+        decltype(std::declval<typename R::key_type*>(), std::true_type{});
+
+    template <typename R>
+    auto is_keyed_range_impl(...) -> std::false_type;
+
+    template <typename R>
+    using is_keyed_range = decltype(is_keyed_range_impl<remove_cvref_t<R>>(0));
+
+
     // -------------------------------------------------- is_valid_prefix
 
     // Checks if T can be used as prefix, i.e.: T is a string or a nullary function
@@ -1046,6 +1515,9 @@ namespace icecream{ namespace detail
                 is_baseline_printable<T>,
                 is_character<remove_ref_t<T>>,
                 is_c_string<remove_ref_t<T>>,
+                is_range_stats<remove_ref_t<T>>,
+                is_comparison<remove_cvref_t<T>>,
+                is_watch_changes<remove_cvref_t<T>>,
                 std::is_base_of<std::exception, remove_cvref_t<T>>,
                 std::is_base_of<boost::exception, remove_cvref_t<T>>
             >
@@ -1619,6 +2091,28 @@ namespace icecream{ namespace detail
         T const&, Config_ const&, std::ostringstream&
     ) -> typename std::enable_if<std::is_integral<remove_cvref_t<T>>::value, PrintingNode>::type;
 
+    struct BitsFormat;
+
+    template <typename T>
+    auto do_print_bitset_bits(
+        T const&, BitsFormat const&, Config_ const&
+    ) -> typename std::enable_if<!is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type;
+
+    template <typename T>
+    auto do_print_bitset_bits(
+        T const&, BitsFormat const&, Config_ const&
+    ) -> typename std::enable_if<is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type;
+
+    template <typename T>
+    auto do_print_bitset(
+        T const&, std::ostringstream&
+    ) -> typename std::enable_if<!is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type;
+
+    template <typename T>
+    auto do_print_bitset(
+        T const&, std::ostringstream&
+    ) -> typename std::enable_if<is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type;
+
     // Print any class that overloads operator<<(std::ostream&, T)
     template <typename T>
     auto make_printing_branch(
@@ -1659,6 +2153,14 @@ namespace icecream{ namespace detail
         >::type;
   #endif
 
+    // Print 128 bits integers
+    template <typename T>
+    auto make_printing_branch(
+        T&&, StringView, Config_ const&
+    ) -> typename std::enable_if<
+        is_int128<remove_ref_t<T>>::value && !is_baseline_printable<T>::value, PrintingNode
+    >::type;
+
     // Print C string
     template <typename T>
     auto make_printing_branch(
@@ -1790,6 +2292,24 @@ namespace icecream{ namespace detail
         , PrintingNode
     >::type;
 
+    // Print the summary statistics of a range
+    template <typename T>
+    auto make_printing_branch(
+        T&&, StringView, Config_ const&
+    ) -> typename std::enable_if<is_range_stats<remove_ref_t<T>>::value, PrintingNode>::type;
+
+    // Print the mismatches between two ranges or tuples
+    template <typename T>
+    auto make_printing_branch(
+        T&&, StringView, Config_ const&
+    ) -> typename std::enable_if<is_comparison<remove_cvref_t<T>>::value, PrintingNode>::type;
+
+    // Print the changed elements of an IC_WATCH range
+    template <typename T>
+    auto make_printing_branch(
+        T&&, StringView, Config_ const&
+    ) -> typename std::enable_if<is_watch_changes<remove_cvref_t<T>>::value, PrintingNode>::type;
+
     // Print classes deriving from only std::exception and not from boost::exception
     template <typename T>
     auto make_printing_branch(
@@ -2222,38 +2742,334 @@ namespace icecream{ namespace detail
     };
 
 
-    // -------------------------------------------------- Hereditary
+    // -------------------------------------------------- Xxh64
 
-    // A hereditary object can optionally hold a value, but will always produce a value
-    // when requested, by delegating the request to its parent if needed.
-    template <typename T>
-    class Hereditary
+    // The 64 bits xxHash (XXH64), with a zero seed, of a sequence of bytes fed in any number
+    // of pieces. Used to fingerprint the printed values, as by the "hash" formatting.
+    class Xxh64
     {
     public:
-        // A child constructed without a value will delegate the value requests to its
-        // parent.
-        Hereditary(Hereditary<T>& parent)
-            : parent_{&parent}
+        Xxh64()
+            : lanes_{PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1}
+            , n_bytes_(0)
+            , n_buffered_(0)
         {}
 
-        // A root object (without a parent) must always have a value.
-        Hereditary(T const& t)
-            : storage_(t)
-            , parent_{nullptr}
-        {}
+        auto update(void const* data, size_t size) -> void
+        {
+            if (size == 0)
+            {
+                return;
+            }
 
-        // A root object (without a parent) must always have a value.
-        Hereditary(T&& t)
-            : storage_(std::move(t))
-            , parent_{nullptr}
-        {}
+            auto bytes = static_cast<unsigned char const*>(data);
+            this->n_bytes_ += size;
 
-        auto operator=(Hereditary<T> const&) -> Hereditary& = delete;
+            if (this->n_buffered_ + size < STRIPE_SIZE)
+            {
+                std::memcpy(this->buffer_ + this->n_buffered_, bytes, size);
+                this->n_buffered_ += size;
+                return;
+            }
 
-        auto operator=(T const& t) -> Hereditary&
-        {
-            this->storage_ = t;
-            return *this;
+            if (this->n_buffered_ > 0)
+            {
+                auto const n_missing = STRIPE_SIZE - this->n_buffered_;
+                std::memcpy(this->buffer_ + this->n_buffered_, bytes, n_missing);
+                this->consume_stripe(this->buffer_);
+                bytes += n_missing;
+                size -= n_missing;
+            }
+
+            for (; size >= STRIPE_SIZE; bytes += STRIPE_SIZE, size -= STRIPE_SIZE)
+            {
+                this->consume_stripe(bytes);
+            }
+
+            if (size > 0)
+            {
+                std::memcpy(this->buffer_, bytes, size);
+            }
+            this->n_buffered_ = size;
+        }
+
+        auto digest() const -> uint64_t
+        {
+            auto h = uint64_t{PRIME_5};
+            if (this->n_bytes_ >= STRIPE_SIZE)
+            {
+                h =
+                    rotl(this->lanes_[0], 1) + rotl(this->lanes_[1], 7)
+                    + rotl(this->lanes_[2], 12) + rotl(this->lanes_[3], 18);
+                for (auto lane : this->lanes_)
+                {
+                    h = (h ^ round(0, lane)) * PRIME_1 + PRIME_4;
+                }
+            }
+            h += this->n_bytes_;
+
+            auto p = this->buffer_;
+            auto n_left = this->n_buffered_;
+            for (; n_left >= 8; p += 8, n_left -= 8)
+            {
+                h = rotl(h ^ round(0, read_le<uint64_t>(p)), 27) * PRIME_1 + PRIME_4;
+            }
+            if (n_left >= 4)
+            {
+                h = rotl(h ^ (read_le<uint32_t>(p) * PRIME_1), 23) * PRIME_2 + PRIME_3;
+                p += 4;
+                n_left -= 4;
+            }
+            for (; n_left > 0; ++p, --n_left)
+            {
+                h = rotl(h ^ (*p * PRIME_5), 11) * PRIME_1;
+            }
+
+            h = (h ^ (h >> 33)) * PRIME_2;
+            h = (h ^ (h >> 29)) * PRIME_3;
+            return h ^ (h >> 32);
+        }
+
+    private:
+        constexpr static uint64_t PRIME_1 = 11400714785074694791ULL;
+        constexpr static uint64_t PRIME_2 = 14029467366897019727ULL;
+        constexpr static uint64_t PRIME_3 = 1609587929392839161ULL;
+        constexpr static uint64_t PRIME_4 = 9650029242287828579ULL;
+        constexpr static uint64_t PRIME_5 = 2870177450012600261ULL;
+        constexpr static size_t STRIPE_SIZE = 32;
+
+        // The four accumulators, each one consuming a 8 bytes piece of every stripe.
+        uint64_t lanes_[4];
+
+        uint64_t n_bytes_;
+
+        // The bytes of the last incomplete stripe.
+        unsigned char buffer_[STRIPE_SIZE];
+        size_t n_buffered_;
+
+        static auto rotl(uint64_t value, int n_bits) -> uint64_t
+        {
+            return (value << n_bits) | (value >> (64 - n_bits));
+        }
+
+        static auto round(uint64_t lane, uint64_t input) -> uint64_t
+        {
+            return rotl(lane + input * PRIME_2, 31) * PRIME_1;
+        }
+
+        // Reads a little endian unsigned integer.
+        template <typename U>
+        static auto read_le(unsigned char const* bytes) -> U
+        {
+            auto result = U{0};
+            std::memcpy(&result, bytes, sizeof(U));
+
+          #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            auto swapped = U{0};
+            for (auto i = size_t{0}; i < sizeof(U); ++i)
+            {
+                swapped = static_cast<U>((swapped << 8) | (result & 0xFF));
+                result = static_cast<U>(result >> 8);
+            }
+            result = swapped;
+          #endif
+
+            return result;
+        }
+
+        auto consume_stripe(unsigned char const* stripe) -> void
+        {
+            for (auto i = size_t{0}; i < 4; ++i)
+            {
+                this->lanes_[i] = round(this->lanes_[i], read_le<uint64_t>(stripe + 8 * i));
+            }
+        }
+    };
+
+
+    // -------------------------------------------------- RepeatCoalescer
+
+    // The notice of `n_repeats` repeats of the last written line.
+    inline auto make_repeats_notice(StringView prefix, size_t n_repeats) -> std::string
+    {
+        return
+            prefix.to_string()
+            + "... last line repeated "
+            + std::to_string(n_repeats)
+            + (n_repeats == 1 ? " time\n" : " times\n");
+    }
+
+    // Collapses the consecutive repeats of a same line, printed by a same call site, into
+    // a single notice with their count. A coalescer is bound to an output, and shared by
+    // all the Config scopes writing to it.
+    class RepeatCoalescer
+    {
+    public:
+        RepeatCoalescer()
+            : line_(0)
+            , hash_(0)
+            , has_last_(false)
+            , n_repeats_(0)
+        {}
+
+        RepeatCoalescer(RepeatCoalescer const&) = delete;
+
+        auto operator=(RepeatCoalescer const&) -> RepeatCoalescer& = delete;
+
+        // Submits the `hash` of a line printed by the call site at `file` and `line`, and
+        // whose beginning is `prefix`. Returns whether that line must be written, which
+        // isn't the case if it repeats the last one. The `n_repeats` will be set to the
+        // number of held repeats that must be noticed before anything else is written, or
+        // zero if none. When the repeats start being held, `get_transcoder()` is called to
+        // get the output transcoder of their notice, in case it is written by `flush`.
+        template <typename F>
+        auto submit(
+            StringView file,
+            int line,
+            uint64_t hash,
+            StringView prefix,
+            std::chrono::milliseconds flush_interval,
+            F&& get_transcoder,
+            size_t& n_repeats
+        ) -> bool
+        {
+            std::lock_guard<std::mutex> guard(this->mutex_);
+
+            auto const now = std::chrono::steady_clock::now();
+            auto const is_repeat =
+                this->has_last_
+                && hash == this->hash_
+                && line == this->line_
+                && file == this->file_;
+            if (is_repeat)
+            {
+                if (this->n_repeats_ == 0)
+                {
+                    this->first_repeat_ = now;
+                    this->transcoder_ = get_transcoder();
+                }
+                ++this->n_repeats_;
+
+                n_repeats = 0;
+                if (now - this->first_repeat_ >= flush_interval)
+                {
+                    n_repeats = this->n_repeats_;
+                    this->n_repeats_ = 0;
+                }
+                return false;
+            }
+
+            n_repeats = this->n_repeats_;
+            this->file_ = file.to_string();
+            this->line_ = line;
+            this->hash_ = hash;
+            this->prefix_ = prefix.to_string();
+            this->has_last_ = true;
+            this->n_repeats_ = 0;
+            return true;
+        }
+
+        // Returns the transcoded notice of the held repeats, or an empty string if none,
+        // and forgets them. Called when nothing else will be written to the output, so
+        // that the repeats of the very last line aren't lost.
+        auto flush() -> std::string
+        {
+            std::lock_guard<std::mutex> guard(this->mutex_);
+            return this->take_notice();
+        }
+
+        // Like `flush`, but only if the first held repeat happened at least
+        // `flush_interval` ago. Called at every IC call, so that the repeats of a line
+        // that stopped being printed are noticed without waiting for another line.
+        auto flush_expired(std::chrono::milliseconds flush_interval) -> std::string
+        {
+            std::lock_guard<std::mutex> guard(this->mutex_);
+
+            if (
+                this->n_repeats_ == 0
+                || std::chrono::steady_clock::now() - this->first_repeat_ < flush_interval
+            ) {
+                return std::string{};
+            }
+
+            return this->take_notice();
+        }
+
+        // Forgets the last line, because something else was written after it. Returns the
+        // number of held repeats of it.
+        auto reset() -> size_t
+        {
+            std::lock_guard<std::mutex> guard(this->mutex_);
+
+            auto const n_repeats = this->n_repeats_;
+            this->has_last_ = false;
+            this->n_repeats_ = 0;
+            return n_repeats;
+        }
+
+    private:
+        // Must be called with the `mutex_` held.
+        auto take_notice() -> std::string
+        {
+            if (this->n_repeats_ == 0)
+            {
+                return std::string{};
+            }
+
+            auto const notice = make_repeats_notice(this->prefix_, this->n_repeats_);
+            this->n_repeats_ = 0;
+            return this->transcoder_(notice);
+        }
+
+        std::mutex mutex_;
+        std::string file_;
+        int line_;
+        uint64_t hash_;
+        bool has_last_;
+
+        // The prefix of the last line, and the output transcoder of its repeats notice.
+        std::string prefix_;
+        std::function<std::string(StringView)> transcoder_;
+
+        // The number of times the last line was repeated and not yet noticed, and when the
+        // first of them happened.
+        size_t n_repeats_;
+        std::chrono::steady_clock::time_point first_repeat_;
+    };
+
+
+    // -------------------------------------------------- Hereditary
+
+    // A hereditary object can optionally hold a value, but will always produce a value
+    // when requested, by delegating the request to its parent if needed.
+    template <typename T>
+    class Hereditary
+    {
+    public:
+        // A child constructed without a value will delegate the value requests to its
+        // parent.
+        Hereditary(Hereditary<T>& parent)
+            : parent_{&parent}
+        {}
+
+        // A root object (without a parent) must always have a value.
+        Hereditary(T const& t)
+            : storage_(t)
+            , parent_{nullptr}
+        {}
+
+        // A root object (without a parent) must always have a value.
+        Hereditary(T&& t)
+            : storage_(std::move(t))
+            , parent_{nullptr}
+        {}
+
+        auto operator=(Hereditary<T> const&) -> Hereditary& = delete;
+
+        auto operator=(T const& t) -> Hereditary&
+        {
+            this->storage_ = t;
+            return *this;
         }
 
         auto operator=(T&& t) -> Hereditary&
@@ -2301,1096 +3117,3506 @@ namespace icecream{ namespace detail
         Hereditary<T>* parent_;
     };
 
-} // namespace detail
-
-
-    // -------------------------------------------------- Config
-
-    class Config
+    // A lock free version of `Hereditary`, to the attributes that are read on every IC
+    // call. The value of a root object can be read with a single relaxed atomic load. `T`
+    // must be `bool` or an enumeration type with non-negative values.
+    template <typename T>
+    class AtomicHereditary
     {
     public:
-
-        explicit Config(Config* parent)
-            : enabled_(parent->enabled_)
-            , output_(parent->output_)
-            , prefix_(parent->prefix_)
-            , decay_char_array_(parent->decay_char_array_)
-            , show_c_string_(parent->show_c_string_)
-            , force_range_strategy_(parent->force_range_strategy_)
-            , force_tuple_strategy_(parent->force_tuple_strategy_)
-            , force_variant_strategy_(parent->force_variant_strategy_)
-            , wide_string_transcoder_(parent->wide_string_transcoder_)
-            , unicode_transcoder_(parent->unicode_transcoder_)
-            , output_transcoder_(parent->output_transcoder_)
-            , line_wrap_width_(parent->line_wrap_width_)
-            , include_context_(parent->include_context_)
-            , context_delimiter_(parent->context_delimiter_)
+        // A child constructed without a value will delegate the value requests to its
+        // parent.
+        AtomicHereditary(AtomicHereditary<T>& parent)
+            : storage_{UNSET}
+            , parent_{&parent}
         {}
 
-        Config(Config const&) = delete;
-
-        Config(Config&&) = delete;
-
-        auto operator=(Config const&) -> Config& = delete;
-
-        auto operator=(Config&&) -> Config& = delete;
+        // A root object (without a parent) must always have a value.
+        AtomicHereditary(T t)
+            : storage_{static_cast<int>(t)}
+            , parent_{nullptr}
+        {}
 
-        auto is_enabled() const -> bool
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->enabled_.value();
-        }
+        auto operator=(AtomicHereditary<T> const&) -> AtomicHereditary& = delete;
 
-        auto enable() -> Config&
+        auto operator=(T t) -> AtomicHereditary&
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->enabled_ = true;
+            this->storage_.store(static_cast<int>(t), std::memory_order_relaxed);
             return *this;
         }
 
-        auto disable() -> Config&
+        auto value() const -> T
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->enabled_ = false;
-            return *this;
+            auto const stored = this->storage_.load(std::memory_order_relaxed);
+            if (stored != UNSET)
+            {
+                return static_cast<T>(stored);
+            }
+            else if (this->parent_)
+            {
+                return this->parent_->value();
+            }
+            else
+            {
+                ICECREAM_UNREACHABLE;
+                return static_cast<T>(0);
+            }
         }
 
-        // Gatekeeper function to emmit better error messages in invalid input.
-        template <typename T>
-        auto output(T&& t) ->
-            typename std::enable_if<
-                detail::disjunction<
-                    std::is_base_of<std::ostream, typename std::decay<T>::type>,
-                    detail::has_push_back_T<T, char>,
-                    detail::is_T_output_iterator<T, char>
-                >::value,
-                Config&
-            >::type
-        {
-            this->set_output(std::forward<T>(t));
-            return *this;
-        }
+    private:
+        constexpr static int UNSET = -1;
 
-        template <typename... Ts>
-        auto prefix(Ts&&... value) ->
-            typename std::enable_if<
-                sizeof...(Ts) >= 1
-                && detail::conjunction<
-                    detail::is_valid_prefix<detail::remove_ref_t<Ts>>...
-                >::value
-                , Config&
-            >::type
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->prefix_ = detail::Prefix(detail::to_invocable(std::forward<Ts>(value))...);
-            return *this;
-        }
+        std::atomic<int> storage_;
+        AtomicHereditary<T> const* parent_;
+    };
 
-        auto decay_char_array() const -> bool
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->decay_char_array_.value();
-        }
 
-        auto decay_char_array(bool value) -> Config&
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->decay_char_array_ = value;
-            return *this;
-        }
+    // -------------------------------------------------- SiteFilter
 
-        auto show_c_string() const -> bool
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->show_c_string_.value();
-        }
+    // Matches `str` against the glob `pattern`, where a '*' matches any sequence of
+    // characters and a '?' matches any single character.
+    inline auto glob_match(StringView pattern, StringView str) -> bool
+    {
+        auto p_idx = size_t{0};
+        auto s_idx = size_t{0};
+        auto star_p_idx = StringView::npos;
+        auto star_s_idx = size_t{0};
 
-        auto show_c_string(bool value) -> Config&
+        while (s_idx < str.size())
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->show_c_string_ = value;
-            return *this;
+            if (
+                p_idx < pattern.size()
+                && (pattern[p_idx] == '?' || pattern[p_idx] == str[s_idx])
+            ){
+                ++p_idx;
+                ++s_idx;
+            }
+            else if (p_idx < pattern.size() && pattern[p_idx] == '*')
+            {
+                star_p_idx = p_idx++;
+                star_s_idx = s_idx;
+            }
+            else if (star_p_idx != StringView::npos)
+            {
+                // Backtrack, letting the last '*' match one more character
+                p_idx = star_p_idx + 1;
+                s_idx = ++star_s_idx;
+            }
+            else
+            {
+                return false;
+            }
         }
 
-        auto force_range_strategy() const -> bool
+        while (p_idx < pattern.size() && pattern[p_idx] == '*')
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->force_range_strategy_.value();
+            ++p_idx;
         }
 
-        auto force_range_strategy(bool value) -> Config&
+        return p_idx == pattern.size();
+    }
+
+    // Parses a non-negative decimal integer. Returns false if `str` isn't one.
+    inline auto parse_line_number(StringView str, int& result) -> bool
+    {
+        if (str.empty()) return false;
+
+        auto value = long{0};
+        for (auto const c : str)
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->force_range_strategy_ = value;
-            return *this;
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + (c - '0');
+            if (value > std::numeric_limits<int>::max()) return false;
         }
 
-        auto force_tuple_strategy() const -> bool
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->force_tuple_strategy_.value();
-        }
+        result = static_cast<int>(value);
+        return true;
+    }
 
-        auto force_tuple_strategy(bool value) -> Config&
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->force_tuple_strategy_ = value;
-            return *this;
-        }
+    // The generation of the call site filter. It is incremented each time the filter
+    // changes, invalidating all the decisions cached at the call sites.
+    inline auto filter_generation() -> std::atomic<unsigned>&
+    {
+        static std::atomic<unsigned> generation{1};
+        return generation;
+    }
 
-        auto force_variant_strategy() const -> bool
+    // A directive as "-file=*.cpp&line=10-20". All of its terms must match for the
+    // directive to match a call site.
+    struct FilterDirective
+    {
+        bool deny = false;
+        std::string file;
+        std::string function;
+        std::string tag;
+        int first_line = 0;
+        int last_line = std::numeric_limits<int>::max();
+
+        // Parses a directive, returning false if `str` isn't a valid one.
+        auto parse(StringView str) -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->force_variant_strategy_.value();
+            str.trim();
+            if (!str.empty() && str[0] == '-')
+            {
+                this->deny = true;
+                str.remove_prefix(1);
+            }
+
+            if (str.empty()) return false;
+
+            while (!str.empty())
+            {
+                auto const n_term = str.find("&");
+                auto term = str.substr(0, n_term);
+                str = (n_term == StringView::npos) ? StringView{} : str.substr(n_term + 1);
+
+                auto const n_eq = term.find("=");
+                if (n_eq == StringView::npos) return false;
+
+                auto key = term.substr(0, n_eq);
+                auto value = term.substr(n_eq + 1);
+                key.trim();
+                value.trim();
+
+                if (key == "file")
+                {
+                    this->file = value.to_string();
+                }
+                else if (key == "func")
+                {
+                    this->function = value.to_string();
+                }
+                else if (key == "tag")
+                {
+                    this->tag = value.to_string();
+                }
+                else if (key == "line")
+                {
+                    auto const n_dash = value.find("-");
+                    if (!parse_line_number(value.substr(0, n_dash), this->first_line))
+                    {
+                        return false;
+                    }
+
+                    if (n_dash == StringView::npos)
+                    {
+                        this->last_line = this->first_line;
+                    }
+                    else if (!parse_line_number(value.substr(n_dash + 1), this->last_line))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            return true;
         }
 
-        auto force_variant_strategy(bool value) -> Config&
+        auto matches(StringView file_, int line, StringView function_, StringView tag_) const -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->force_variant_strategy_ = value;
-            return *this;
+            return
+                this->matches_file(file_)
+                && this->first_line <= line && line <= this->last_line
+                && (this->function.empty() || function_.find(this->function.c_str()) != StringView::npos)
+                && (this->tag.empty() || tag_ == StringView{this->tag});
         }
-        auto wide_string_transcoder(
-            std::function<std::string(wchar_t const*, size_t)>&& transcoder
-        ) -> Config&
+
+    private:
+        auto matches_file(StringView file_) const -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->wide_string_transcoder_ =
-                [transcoder](detail::WStringView str) -> std::string
-                {
-                    return transcoder(str.data(), str.size());
-                };
-            return *this;
+            if (this->file.empty() || glob_match(this->file, file_))
+            {
+                return true;
+            }
+
+            // A pattern without directory separators will also be matched against the
+            // bare file name.
+            if (
+                this->file.find('/') != std::string::npos
+                || this->file.find('\\') != std::string::npos
+            ){
+                return false;
+            }
+
+            auto const n_slash = file_.rfind('/');
+            auto const n_backslash = file_.rfind('\\');
+            auto const n =
+                (n_slash == StringView::npos) ? n_backslash
+                : (n_backslash == StringView::npos) ? n_slash
+                : (n_slash > n_backslash ? n_slash : n_backslash);
+
+            return n != StringView::npos && glob_match(this->file, file_.substr(n + 1));
         }
+    };
 
-      #if defined(ICECREAM_STRING_VIEW_HEADER)
-        auto wide_string_transcoder(
-            std::function<std::string(std::wstring_view)>&& transcoder
-        ) -> Config&
+    // The call site filter. It is global to the whole program and its initial value is
+    // read from the ICECREAM_FILTER environment variable.
+    class SiteFilter
+    {
+    public:
+        static auto global() -> SiteFilter&
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->wide_string_transcoder_ =
-                [transcoder](detail::WStringView str) -> std::string
-                {
-                    return transcoder({str.data(), str.size()});
-                };
-            return *this;
+          #if defined(_MSC_VER)
+            #pragma warning(suppress: 4996)
+          #endif
+            static SiteFilter global_{std::getenv("ICECREAM_FILTER")};
+            return global_;
         }
-      #endif
 
-        auto unicode_transcoder(
-            std::function<std::string(char32_t const*, size_t)>&& transcoder
-        ) -> Config&
+        auto spec() const -> std::string
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->unicode_transcoder_ =
-                [transcoder](detail::U32StringView str) -> std::string
-                {
-                    return transcoder(str.data(), str.size());
-                };
-            return *this;
+            std::lock_guard<std::mutex> guard(this->mutex_);
+            return this->spec_;
         }
 
-      #if defined(ICECREAM_STRING_VIEW_HEADER)
-        auto unicode_transcoder(
-            std::function<std::string(std::u32string_view)>&& transcoder
-        ) -> Config&
+        auto spec(std::string const& value) -> void
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->unicode_transcoder_ =
-                [transcoder](detail::U32StringView str) -> std::string
+            auto directives = std::vector<FilterDirective>{};
+            auto has_allow_directive = false;
+
+            auto str = StringView{value};
+            while (!str.empty())
+            {
+                auto const n = str.find(",");
+                auto const directive_str = str.substr(0, n);
+                str = (n == StringView::npos) ? StringView{} : str.substr(n + 1);
+
+                auto directive = FilterDirective{};
+                if (directive.parse(directive_str))
                 {
-                    return transcoder({str.data(), str.size()});
-                };
-            return *this;
+                    has_allow_directive = has_allow_directive || !directive.deny;
+                    directives.push_back(std::move(directive));
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(this->mutex_);
+            this->spec_ = value;
+            this->directives_ = std::move(directives);
+            this->has_allow_directive_ = has_allow_directive;
+            filter_generation().fetch_add(1, std::memory_order_relaxed);
         }
-      #endif
 
-        auto output_transcoder(
-            std::function<std::string(char const*, size_t)>&& transcoder
-        ) -> Config&
+        // Returns the decision to a call site, together with the filter generation it is
+        // valid to, packed as `generation << 1 | decision`.
+        auto decide(StringView file, int line, StringView function, StringView tag) const -> unsigned
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->output_transcoder_ =
-                [transcoder](detail::StringView str) -> std::string
+            std::lock_guard<std::mutex> guard(this->mutex_);
+
+            // The last matching directive wins. If none matches, the call site will be
+            // enabled only if there are no "allow" directives.
+            auto allowed = !this->has_allow_directive_;
+            for (auto const& directive : this->directives_)
+            {
+                if (directive.matches(file, line, function, tag))
                 {
-                    return transcoder(str.data(), str.size());
-                };
-            return *this;
+                    allowed = !directive.deny;
+                }
+            }
+
+            auto const generation = filter_generation().load(std::memory_order_relaxed);
+            return (generation << 1) | (allowed ? 1u : 0u);
         }
 
-    #if defined(ICECREAM_STRING_VIEW_HEADER)
-        auto output_transcoder(std::function<std::string(std::string_view)>&& transcoder) -> Config&
+    private:
+        explicit SiteFilter(char const* initial_spec)
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->output_transcoder_ =
-                [transcoder](detail::StringView str) -> std::string
-                {
-                    return transcoder({str.data(), str.size()});
-                };
-            return *this;
+            if (initial_spec != nullptr)
+            {
+                this->spec(initial_spec);
+            }
         }
-    #endif
 
-        auto line_wrap_width() const -> size_t
+        mutable std::mutex mutex_;
+        std::string spec_;
+        std::vector<FilterDirective> directives_;
+        bool has_allow_directive_ = false;
+    };
+
+    // The identity of a call site. The `column`, when known, and the `names`, the text of
+    // the IC arguments, tell apart the call sites written on a same line. The texts are
+    // compared by their contents, so that a call site within an inline function has the
+    // same identity in all the translation units. Each instantiation of a function
+    // template has its own function name, and so its own identity.
+    struct SiteKey
+    {
+        StringView file;
+        int line;
+        int column;
+        StringView function;
+        StringView names;
+        StringView tag;
+
+        auto operator==(SiteKey const& other) const -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->line_wrap_width_.value();
+            return
+                this->line == other.line
+                && this->column == other.column
+                && SiteKey::is_same_text(this->names, other.names)
+                && SiteKey::is_same_text(this->tag, other.tag)
+                && SiteKey::is_same_text(this->function, other.function)
+                && SiteKey::is_same_text(this->file, other.file);
         }
 
-        auto line_wrap_width(size_t value) -> Config&
+    private:
+        // Within a translation unit the texts of a call site are the same string literals,
+        // so the contents are only compared when the addresses differ.
+        static auto is_same_text(StringView lho, StringView rho) -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->line_wrap_width_ = value;
-            return *this;
+            return
+                lho.size() == rho.size()
+                && (lho.data() == rho.data() || lho == rho);
         }
+    };
 
-        auto include_context() const -> bool
+    // The state kept to each call site, of type `State`. The slot is shared by all the call
+    // sites in the same source line, of any file, and holds a list with the state of each
+    // one of them. The list only grows, at the first call of each call site, so it is read
+    // without any lock. Getting the state of a call site costs an atomic load, and one
+    // SiteKey comparison for each call site added to the slot after it.
+    template <typename State>
+    class SiteSlot
+    {
+    public:
+        constexpr SiteSlot()
+            : head_{nullptr}
+        {}
+
+        SiteSlot(SiteSlot const&) = delete;
+
+        auto operator=(SiteSlot const&) -> SiteSlot& = delete;
+
+        // The texts of the `key` must be static, as the string literals of the IC macros.
+        auto get(SiteKey const& key) -> State&
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->include_context_.value();
+            auto const head = this->head_.load(std::memory_order_acquire);
+            auto const record = SiteSlot::find(head, nullptr, key);
+            if (ICECREAM_LIKELY(record != nullptr))
+            {
+                return record->state;
+            }
+
+            return this->add(head, key);
         }
 
-        auto include_context(bool value) -> Config&
+    private:
+        struct Record
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->include_context_ = value;
-            return *this;
-        }
+            explicit Record(SiteKey const& key_)
+                : key(key_)
+                , state{}
+                , next{nullptr}
+            {}
 
-        auto context_delimiter() const -> std::string
+            SiteKey key;
+            State state;
+            Record* next;
+        };
+
+        // The record of a call site in the list from `first` up to, and excluding, `last`.
+        static auto find(Record* first, Record* last, SiteKey const& key) -> Record*
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->context_delimiter_.value();
+            for (auto record = first; record != last; record = record->next)
+            {
+                if (record->key == key)
+                {
+                    return record;
+                }
+            }
+            return nullptr;
         }
 
-        auto context_delimiter(std::string value) -> Config&
+        // Pushes the record of a call site not found in the list starting at `head`. The
+        // records are never released, so that a reference to their states is valid for as
+        // long as the slots.
+        ICECREAM_COLD auto add(Record* head, SiteKey const& key) -> State&
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->context_delimiter_ = value;
-            return *this;
+            auto record = std::unique_ptr<Record>(new Record(key));
+            record->next = head;
+            while (
+                !this->head_.compare_exchange_weak(
+                    record->next,
+                    record.get(),
+                    std::memory_order_release,
+                    std::memory_order_acquire
+                )
+            ) {
+                // The records pushed meanwhile by other threads may include this call site
+                auto const other = SiteSlot::find(record->next, head, key);
+                if (other != nullptr)
+                {
+                    return other->state;
+                }
+                head = record->next;
+            }
+
+            return record.release()->state;
         }
 
-    protected:
+        std::atomic<Record*> head_;
+    };
 
-        Config() = default;
+    // Caches the filtering decision of a call site. While the filter doesn't change,
+    // checking it costs a single comparison.
+    class SiteFilterCache
+    {
+    public:
+        constexpr SiteFilterCache()
+            : state_{0}
+        {}
 
-        auto set_output(std::ostream& stream) -> void
-        {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->output_ = detail::Output<std::ostream>{stream};
-        }
+        SiteFilterCache(SiteFilterCache const&) = delete;
 
-        template <typename T>
-        auto set_output(T& container) ->
-            typename std::enable_if<
-                detail::has_push_back_T<T, char>::value
-            >::type
+        auto operator=(SiteFilterCache const&) -> SiteFilterCache& = delete;
+
+        auto is_allowed(StringView file, int line, StringView function, StringView tag) -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            auto const state = this->state_.load(std::memory_order_relaxed);
+            if (ICECREAM_LIKELY((state >> 1) == filter_generation().load(std::memory_order_relaxed)))
+            {
+                return (state & 1u) != 0;
+            }
 
-            using OSIt = std::back_insert_iterator<T>;
-            this->output_ = detail::Output<OSIt>{OSIt{container}};
+            return this->refresh(file, line, function, tag);
         }
 
-        template <typename T>
-        auto set_output(T iterator) ->
-            typename std::enable_if<
-                detail::is_T_output_iterator<T, char>::value
-            >::type
+    private:
+        ICECREAM_COLD auto refresh(
+            StringView file, int line, StringView function, StringView tag
+        ) -> bool
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->output_ = detail::Output<T>{iterator};
+            auto const state = SiteFilter::global().decide(file, line, function, tag);
+            this->state_.store(state, std::memory_order_relaxed);
+            return (state & 1u) != 0;
         }
 
-        mutable std::mutex attribute_mutex;
+        std::atomic<unsigned> state_;
+    };
 
-        detail::Hereditary<bool> enabled_{true};
+    // The hash of the last value seen by an IC_ON_CHANGE call site.
+    class SiteChangeCache
+    {
+    public:
+        constexpr SiteChangeCache()
+            : hash_{0}
+            , has_hash_{false}
+        {}
 
-        detail::Hereditary<std::function<void(std::string const&)>> output_{
-            detail::Output<std::ostream>{std::cerr}
-        };
+        SiteChangeCache(SiteChangeCache const&) = delete;
 
-        detail::Hereditary<detail::Prefix> prefix_{
-            detail::Prefix(
-                []() -> std::string
-                {
-                    return "ic| ";
-                }
-            )
-        };
+        auto operator=(SiteChangeCache const&) -> SiteChangeCache& = delete;
 
-        detail::Hereditary<bool> decay_char_array_{false};
+        // Stores the `hash` of the current value, and returns whether it differs from the
+        // previous one. The first value seen is always a change.
+        auto update(uint64_t hash) -> bool
+        {
+            auto const previous = this->hash_.exchange(hash, std::memory_order_relaxed);
+            auto const had_hash = this->has_hash_.exchange(true, std::memory_order_relaxed);
+            return !had_hash || previous != hash;
+        }
 
-        detail::Hereditary<bool> show_c_string_{true};
+    private:
+        std::atomic<uint64_t> hash_;
+        std::atomic<bool> has_hash_;
+    };
 
-        detail::Hereditary<bool> force_range_strategy_{true};
+    // The elements of the range last seen by an IC_WATCH call site. The `state` type
+    // depends on the watched range type, and is set by the first call.
+    class SiteWatchCache
+    {
+    public:
+        SiteWatchCache() = default;
 
-        detail::Hereditary<bool> force_tuple_strategy_{true};
+        SiteWatchCache(SiteWatchCache const&) = delete;
 
-        detail::Hereditary<bool> force_variant_strategy_{true};
+        auto operator=(SiteWatchCache const&) -> SiteWatchCache& = delete;
 
-        detail::Hereditary<std::function<std::string(detail::WStringView)>> wide_string_transcoder_{
-            [](detail::WStringView str) -> std::string
+        // Returns the state of this call site, creating it if this is the first call. A
+        // call site watching ranges of different types, as one inside a function template
+        // instantiated with a same line in its body, restarts its state whenever the type
+        // changes. The `mutex` must be held while using it.
+        template <typename S>
+        auto get_state(bool& is_new) -> S&
+        {
+            is_new = this->state_type_ != SiteWatchCache::type_id<S>();
+            if (is_new)
             {
-                auto const c_locale = std::string{std::setlocale(LC_ALL, nullptr)};
-                if (c_locale != "C" && c_locale != "POSIX")
-                {
-                    #if defined(_MSC_VER)
-                        // Silence a warning due to a deprecated attribute in `std::wcrtomb`
-                        #pragma warning(suppress: 4996)
-                        return detail::xrtomb<wchar_t, std::wcrtomb>(str);
-                    #else
-                        return detail::xrtomb<wchar_t, std::wcrtomb>(str);
-                    #endif
-                }
-                else
-                {
-                    switch (sizeof(wchar_t))
-                    {
-                    case 2:
-                        {
-                            auto const utf32_str =
-                                detail::to_utf32_u32string(
-                                    detail::U16StringView(
-                                        reinterpret_cast<char16_t const*>(str.data()), str.size()
-                                    )
-                                );
-                            return detail::to_utf8_string(utf32_str);
-                        }
-                    case 4:
-                        return detail::to_utf8_string(
-                            detail::U32StringView(
-                                reinterpret_cast<char32_t const*>(str.data()), str.size()
-                            )
-                        );
-                    default:
-                        return "<?>";
-                    }
-                }
+                this->state_ = std::make_shared<S>();
+                this->state_type_ = SiteWatchCache::type_id<S>();
             }
-        };
+            return *static_cast<S*>(this->state_.get());
+        }
 
-        detail::Hereditary<std::function<std::string(detail::U32StringView str)>> unicode_transcoder_{
-            [](detail::U32StringView str) -> std::string
-            {
-              #ifdef ICECREAM_UCHAR_HEADER
-                auto const c_locale = std::string{std::setlocale(LC_ALL, nullptr)};
-                if (c_locale != "C" && c_locale != "POSIX")
-                {
-                    return detail::xrtomb<char32_t, c32rtomb>(str);
-                }
-                else
-              #endif
-                {
-                    return detail::to_utf8_string(str);
-                }
-            }
-        };
+        std::mutex mutex;
 
-        // Function to convert a string in "execution encoding" to "output encoding"
-        detail::Hereditary<std::function<std::string(detail::StringView)>> output_transcoder_{
-            [](detail::StringView str) -> std::string
-            {
-                return str.to_string();
-            }
-        };
+    private:
+        // An address unique to each type S.
+        template <typename S>
+        static auto type_id() -> void const*
+        {
+            static char const id = 0;
+            return &id;
+        }
 
-        detail::Hereditary<size_t> line_wrap_width_{70};
+        std::shared_ptr<void> state_;
+        void const* state_type_ = nullptr;
+    };
 
-        detail::Hereditary<bool> include_context_{false};
+    // Each source line has its own slots, shared by all the IC call sites written on it.
+    // These are inline functions, so the slots are the same in all translation units.
+    template <int Line>
+    auto site_filter_slot() -> SiteSlot<SiteFilterCache>&
+    {
+        static SiteSlot<SiteFilterCache> slot;
+        return slot;
+    }
 
-        detail::Hereditary<std::string> context_delimiter_{"- "};
+    template <int Line>
+    auto site_change_slot() -> SiteSlot<SiteChangeCache>&
+    {
+        static SiteSlot<SiteChangeCache> slot;
+        return slot;
+    }
+
+    template <int Line>
+    auto site_watch_slot() -> SiteSlot<SiteWatchCache>&
+    {
+        static SiteSlot<SiteWatchCache> slot;
+        return slot;
+    }
+
+    // The tag of a call site. Only a string literal tag is known to be the same at every
+    // call, and so only then the filter decision can be cached.
+    struct SiteTag
+    {
+        StringView text;
+        bool is_constant;
     };
 
+    template <size_t N>
+    auto make_site_tag(char const (&tag)[N]) -> SiteTag
+    {
+        return SiteTag{StringView(tag), true};
+    }
 
-namespace detail {
+    template <size_t N>
+    auto make_site_tag(char (&tag)[N]) -> SiteTag
+    {
+        return SiteTag{StringView(tag), false};
+    }
 
-    // Inherits from icecream::Config, and implements access to attributes which shoud not
-    // be exposed to public.
-    class Config_
-        : public ::icecream::Config
+    template <typename T>
+    auto make_site_tag(T const& tag) -> SiteTag
     {
-    public:
+        return SiteTag{StringView(tag), false};
+    }
 
-        using Config::Config;
+} // namespace detail
 
-        Config_(Config_ const&) = delete;
 
-        Config_(Config_&&) = delete;
+    // -------------------------------------------------- Level
 
-        auto operator=(Config_ const&) -> Config_& = delete;
+    // The severity levels of the leveled IC macros (IC_TRACE, IC_DEBUG, etc).
+    enum class Level
+    {
+        trace = ICECREAM_LEVEL_TRACE,
+        debug = ICECREAM_LEVEL_DEBUG,
+        info = ICECREAM_LEVEL_INFO,
+        warn = ICECREAM_LEVEL_WARN,
+        error = ICECREAM_LEVEL_ERROR
+    };
 
-        auto operator=(Config_&&) -> Config_& = delete;
 
-        constexpr static size_t INDENT_BASE = 4;
+    // -------------------------------------------------- Renderer
 
-        static auto global() -> Config_&
+    // The layouts in which the IC calls can be written to an output.
+    enum class Renderer
+    {
+        // All the arguments in a single line, or one argument per line if they don't fit
+        // in the `line_wrap_width`.
+        text,
+
+        // All the arguments always in a single line.
+        single_line,
+
+        // A JSON object in a single line, with the call site and arguments of the call.
+        ndjson
+    };
+
+
+namespace detail {
+
+    // -------------------------------------------------- Sink
+
+    // An output of the IC calls. It only accepts the leveled calls with a level equal to
+    // or higher than its own, and writes them with its own renderer.
+    class Sink
+    {
+    public:
+        Sink(std::function<void(std::string const&)> output, Level level, Renderer renderer)
+            : output_(std::move(output))
+            , level_(level)
+            , renderer_(renderer)
+        {}
+
+        Sink(Sink const&) = delete;
+
+        auto operator=(Sink const&) -> Sink& = delete;
+
+        // Whether a call with the severity `level`, or with none if not leveled, will be
+        // written to this sink.
+        auto accepts(Optional<Level> const& level) const -> bool
         {
-            static Config_ global_{};
-            return global_;
+            return !level || *level >= this->level_;
         }
 
-        auto write_to_output(std::string const& str) -> void
+        auto renderer() const -> Renderer
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            this->output_.value()(str);
+            return this->renderer_;
         }
 
-        auto gen_prefix() -> std::string
+        auto coalescer() -> RepeatCoalescer&
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->prefix_.value()();
+            return this->coalescer_;
         }
 
-        auto transcode_wide_string(WStringView str) const -> std::string
+        // Expects `str` in "output encoding".
+        auto write(std::string const& str) -> void
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->wide_string_transcoder_.value()(str);
+            std::lock_guard<std::mutex> guard(this->mutex_);
+            this->output_(str);
         }
 
-        auto transcode_unicode(U32StringView str) const -> std::string
+        // Writes the notice of the held repeats of the last line, if any. Must only be
+        // called while the output is known to be alive, so never from the destructor,
+        // since a sink can outlive the object it writes to.
+        auto flush_repeats() -> void
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->unicode_transcoder_.value()(str);
+            auto const notice = this->coalescer_.flush();
+            if (!notice.empty())
+            {
+                this->write(notice);
+            }
         }
 
-        auto transcode_output(StringView str) const -> std::string
+        // Writes the notice of the held repeats whose `flush_interval` has expired.
+        auto flush_expired_repeats(std::chrono::milliseconds flush_interval) -> void
         {
-            std::lock_guard<std::mutex> guard(this->attribute_mutex);
-            return this->output_transcoder_.value()(str);
+            auto const notice = this->coalescer_.flush_expired(flush_interval);
+            if (!notice.empty())
+            {
+                this->write(notice);
+            }
         }
 
     private:
-
-        Config_() = default;
+        std::function<void(std::string const&)> output_;
+        Level level_;
+        Renderer renderer_;
+        RepeatCoalescer coalescer_;
+        std::mutex mutex_;
     };
 
+    // The outputs of a Config. A list is never changed after being built, so it is shared
+    // by all the IC calls using it, without being copied.
+    using SinkList = std::vector<std::shared_ptr<Sink>>;
 
-    // -------------------------------------------------- Tree
-
-    enum class OstreamTypeMode : long
+    // Writes, when destroyed at the program exit, the held repeats of a sink whose output
+    // outlives it, like the std::cerr of the default sink.
+    class ExitRepeatsFlusher
     {
-        none,
-        debug,
-        binary,
-        BINARY,
-        character,
-        string,
-        non_binary_integer
+    public:
+        explicit ExitRepeatsFlusher(std::shared_ptr<Sink> sink)
+            : sink_(std::move(sink))
+        {}
+
+        ExitRepeatsFlusher(ExitRepeatsFlusher const&) = delete;
+
+        auto operator=(ExitRepeatsFlusher const&) -> ExitRepeatsFlusher& = delete;
+
+        ~ExitRepeatsFlusher()
+        {
+            try
+            {
+                this->sink_->flush_repeats();
+            }
+            catch (...)
+            {}
+        }
+
+    private:
+        std::shared_ptr<Sink> sink_;
     };
 
-    inline auto xidx_type_mode() -> int
-    {
-        static auto const xindex = std::ios_base::xalloc();
-        return xindex;
-    }
+} // namespace detail
 
-    inline auto getOstreamTypeMode(std::ostringstream& ostrm) -> OstreamTypeMode
-    {
-        return static_cast<OstreamTypeMode>(ostrm.iword(xidx_type_mode()));
-    }
 
-    inline auto setOstreamTypeMode(std::ostringstream& ostrm, OstreamTypeMode type) -> void
-    {
-        ostrm.iword(xidx_type_mode()) = static_cast<long>(type);
-    }
+    // -------------------------------------------------- Config
 
-    // Builds an ostringstream and sets its state accordingly to `fmt` string
-    inline auto build_ostream(StringView fmt) -> Optional<std::ostringstream>
+    class Config
     {
-        // format_spec ::=  [[fill]align][sign]["#"][width]["." precision][type]
-        // fill        ::=  <a character>
-        // align       ::=  "<" | ">" | "^"
-        // sign        ::=  "+" | "-"
-        // width       ::=  integer
-        // precision   ::=  integer
-        // type        ::=  "a" | "A" | "b" | "B" | "c" | "d" | "e" | "E" | "f" | "F" | "g" | "G" | "o" | "s" | "x" | "X" | "?"
-        // integer     ::=  digit+
-        // digit       ::=  "0"..."9"
+    public:
 
-        auto os = std::ostringstream{};
-        os << std::boolalpha;
-        setOstreamTypeMode(os, OstreamTypeMode::none);
+        explicit Config(Config* parent)
+            : enabled_(parent->enabled_)
+            , level_(parent->level_)
+            , sinks_(parent->sinks_)
+            , prefix_(parent->prefix_)
+            , decay_char_array_(parent->decay_char_array_)
+            , show_c_string_(parent->show_c_string_)
+            , force_range_strategy_(parent->force_range_strategy_)
+            , force_tuple_strategy_(parent->force_tuple_strategy_)
+            , force_variant_strategy_(parent->force_variant_strategy_)
+            , wide_string_transcoder_(parent->wide_string_transcoder_)
+            , unicode_transcoder_(parent->unicode_transcoder_)
+            , output_transcoder_(parent->output_transcoder_)
+            , line_wrap_width_(parent->line_wrap_width_)
+            , include_context_(parent->include_context_)
+            , context_delimiter_(parent->context_delimiter_)
+            , max_range_elements_(parent->max_range_elements_)
+            , max_nesting_depth_(parent->max_nesting_depth_)
+            , max_string_length_(parent->max_string_length_)
+            , max_output_bytes_(parent->max_output_bytes_)
+            , range_edge_items_(parent->range_edge_items_)
+            , range_streaming_threshold_(parent->range_streaming_threshold_)
+            , parallel_range_threshold_(parent->parallel_range_threshold_)
+            , coalesce_repeats_(parent->coalesce_repeats_)
+            , coalesce_flush_interval_(parent->coalesce_flush_interval_)
+        {}
 
-        auto it = std::begin(fmt);
-        auto end_it = std::end(fmt);
+        Config(Config const&) = delete;
 
-        if (it == end_it) return os;
+        Config(Config&&) = delete;
 
-        // [[fill]align]
+        auto operator=(Config const&) -> Config& = delete;
+
+        auto operator=(Config&&) -> Config& = delete;
+
+        // The `enabled` attribute is checked on every IC call, so it is atomic and don't
+        // need the attribute mutex.
+        auto is_enabled() const -> bool
         {
-            auto fill_char = os.fill();
-            if (*it != '<' && *it != '>' && *it != '^')
-            {
-                auto la_it = it+1;
-                if (la_it != end_it && (*la_it == '<' || *la_it == '>' || *la_it == '^'))
-                {
-                    fill_char = *it;
-                    ++it;
-                }
-            }
-            if (it != end_it && *it == '<')
-            {
-                os << std::left << std::setfill(fill_char);
-                ++it;
-            }
-            else if (it != end_it && *it == '>')
-            {
-                os << std::right << std::setfill(fill_char);
-                ++it;
-            }
-            else if (it != end_it && *it == '^')
-            {
-                os << std::internal << std::setfill(fill_char);
-                ++it;
-            }
+            return this->enabled_.value();
         }
 
-        // [sign]
-        if (it != end_it && *it == '+')
+        auto enable() -> Config&
         {
-            os << std::showpos;
-            ++it;
+            this->enabled_ = true;
+            return *this;
         }
-        else if (it != end_it && *it == '-')
+
+        auto disable() -> Config&
         {
-            os << std::noshowpos;
-            ++it;
+            this->enabled_ = false;
+            return *this;
         }
 
-        // ["#"]
-        if (it != end_it && *it == '#')
+        // Like the `enabled` attribute, `level` is checked on every leveled IC call.
+        auto level() const -> Level
         {
-            os << std::showbase << std::showpoint;
-            ++it;
+            return this->level_.value();
         }
 
-        // [width]
+        auto level(Level value) -> Config&
         {
-            auto b_it = it;
-            while (it != end_it && *it >= '0' && *it <= '9') ++it;
-            if (it != b_it)
-            {
-                os << std::setw(std::stoi(std::string(b_it, it)));
+            this->level_ = value;
+            return *this;
+        }
+
+        // The call site filter is global to the whole program. Setting it through any
+        // `IC_CONFIG` instance has the same effect.
+        auto filter() const -> std::string
+        {
+            return detail::SiteFilter::global().spec();
+        }
+
+        auto filter(std::string const& value) -> Config&
+        {
+            detail::SiteFilter::global().spec(value);
+            return *this;
+        }
+
+        // Gatekeeper function to emmit better error messages in invalid input. Replaces all
+        // the outputs by `t`.
+        template <typename T>
+        auto output(T&& t, Level level = Level::trace, Renderer renderer = Renderer::text) ->
+            typename std::enable_if<
+                detail::disjunction<
+                    std::is_base_of<std::ostream, typename std::decay<T>::type>,
+                    detail::has_push_back_T<T, char>,
+                    detail::is_T_output_iterator<T, char>
+                >::value,
+                Config&
+            >::type
+        {
+            auto sink = std::make_shared<detail::Sink>(
+                Config::make_output(std::forward<T>(t)), level, renderer
+            );
+
+            auto old_sinks = std::shared_ptr<detail::SinkList const>{};
+            {
+                std::lock_guard<std::mutex> guard(this->attribute_mutex);
+                old_sinks = this->sinks_.value();
+                this->sinks_ =
+                    std::make_shared<detail::SinkList>(detail::SinkList{std::move(sink)});
             }
+            Config::flush_repeats(*old_sinks);
+            return *this;
         }
 
-        // ["." precision]
-        if (it != end_it && *it == '.')
+        // Adds `t` to the current outputs.
+        template <typename T>
+        auto add_output(T&& t, Level level = Level::trace, Renderer renderer = Renderer::text) ->
+            typename std::enable_if<
+                detail::disjunction<
+                    std::is_base_of<std::ostream, typename std::decay<T>::type>,
+                    detail::has_push_back_T<T, char>,
+                    detail::is_T_output_iterator<T, char>
+                >::value,
+                Config&
+            >::type
         {
-            auto b_it = it+1;
-            auto p_it = b_it;
-            while (p_it != end_it && *p_it >= '0' && *p_it <= '9') ++p_it;
-            if (p_it != b_it)
+            auto sink = std::make_shared<detail::Sink>(
+                Config::make_output(std::forward<T>(t)), level, renderer
+            );
+
+            auto old_sinks = std::shared_ptr<detail::SinkList const>{};
             {
-                os << std::setprecision(std::stoi(std::string(b_it, p_it)));
-                it = p_it;
+                std::lock_guard<std::mutex> guard(this->attribute_mutex);
+                old_sinks = this->sinks_.value();
+                auto sinks = std::make_shared<detail::SinkList>(*old_sinks);
+                sinks->push_back(std::move(sink));
+                this->sinks_ = std::move(sinks);
             }
+            Config::flush_repeats(*old_sinks);
+            return *this;
         }
 
-        // [type]
-        if (it != end_it && *it == 'a')
+        template <typename... Ts>
+        auto prefix(Ts&&... value) ->
+            typename std::enable_if<
+                sizeof...(Ts) >= 1
+                && detail::conjunction<
+                    detail::is_valid_prefix<detail::remove_ref_t<Ts>>...
+                >::value
+                , Config&
+            >::type
         {
-            os << std::hexfloat << std::nouppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->prefix_ = detail::Prefix(detail::to_invocable(std::forward<Ts>(value))...);
+            return *this;
         }
-        else if (it != end_it && *it == 'A')
+
+        auto decay_char_array() const -> bool
         {
-            os << std::hexfloat << std::uppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->decay_char_array_.value();
         }
-        else if (it != end_it && *it == 'b')
+
+        auto decay_char_array(bool value) -> Config&
         {
-            setOstreamTypeMode(os, OstreamTypeMode::binary);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->decay_char_array_ = value;
+            return *this;
         }
-        else if (it != end_it && *it == 'B')
+
+        auto show_c_string() const -> bool
         {
-            setOstreamTypeMode(os, OstreamTypeMode::BINARY);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->show_c_string_.value();
         }
-        else if (it != end_it && *it == 'c')
+
+        auto show_c_string(bool value) -> Config&
         {
-            setOstreamTypeMode(os, OstreamTypeMode::character);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->show_c_string_ = value;
+            return *this;
         }
-        else if (it != end_it && *it == 'd')
+
+        auto force_range_strategy() const -> bool
         {
-            os << std::dec << std::noboolalpha;
-            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->force_range_strategy_.value();
         }
-        else if (it != end_it && *it == 'e')
+
+        auto force_range_strategy(bool value) -> Config&
         {
-            os << std::scientific << std::nouppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->force_range_strategy_ = value;
+            return *this;
         }
-        else if (it != end_it && *it == 'E')
+
+        auto force_tuple_strategy() const -> bool
         {
-            os << std::scientific << std::uppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->force_tuple_strategy_.value();
         }
-        else if (it != end_it && *it == 'f')
+
+        auto force_tuple_strategy(bool value) -> Config&
         {
-            os << std::fixed << std::nouppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->force_tuple_strategy_ = value;
+            return *this;
         }
-        else if (it != end_it && *it == 'F')
+
+        auto force_variant_strategy() const -> bool
         {
-            os << std::fixed << std::uppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->force_variant_strategy_.value();
         }
-        else if (it != end_it && *it == 'g')
+
+        auto force_variant_strategy(bool value) -> Config&
         {
-            os << std::defaultfloat << std::nouppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->force_variant_strategy_ = value;
+            return *this;
         }
-        else if (it != end_it && *it == 'G')
+        auto wide_string_transcoder(
+            std::function<std::string(wchar_t const*, size_t)>&& transcoder
+        ) -> Config&
         {
-            os << std::defaultfloat << std::uppercase;
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->wide_string_transcoder_ =
+                [transcoder](detail::WStringView str) -> std::string
+                {
+                    return transcoder(str.data(), str.size());
+                };
+            return *this;
         }
-        else if (it != end_it && *it == 'o')
+
+      #if defined(ICECREAM_STRING_VIEW_HEADER)
+        auto wide_string_transcoder(
+            std::function<std::string(std::wstring_view)>&& transcoder
+        ) -> Config&
         {
-            os << std::oct << std::noboolalpha;
-            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->wide_string_transcoder_ =
+                [transcoder](detail::WStringView str) -> std::string
+                {
+                    return transcoder({str.data(), str.size()});
+                };
+            return *this;
         }
-        else if (it != end_it && *it == 's')
+      #endif
+
+        auto unicode_transcoder(
+            std::function<std::string(char32_t const*, size_t)>&& transcoder
+        ) -> Config&
         {
-            setOstreamTypeMode(os, OstreamTypeMode::string);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->unicode_transcoder_ =
+                [transcoder](detail::U32StringView str) -> std::string
+                {
+                    return transcoder(str.data(), str.size());
+                };
+            return *this;
         }
-        else if (it != end_it && *it == 'x')
+
+      #if defined(ICECREAM_STRING_VIEW_HEADER)
+        auto unicode_transcoder(
+            std::function<std::string(std::u32string_view)>&& transcoder
+        ) -> Config&
         {
-            os << std::hex << std::nouppercase << std::noboolalpha;
-            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->unicode_transcoder_ =
+                [transcoder](detail::U32StringView str) -> std::string
+                {
+                    return transcoder({str.data(), str.size()});
+                };
+            return *this;
         }
-        else if (it != end_it && *it == 'X')
+      #endif
+
+        auto output_transcoder(
+            std::function<std::string(char const*, size_t)>&& transcoder
+        ) -> Config&
         {
-            os << std::hex << std::uppercase << std::noboolalpha;
-            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->output_transcoder_ =
+                [transcoder](detail::StringView str) -> std::string
+                {
+                    return transcoder(str.data(), str.size());
+                };
+            return *this;
         }
-        else if (it != end_it && *it == '?')
+
+    #if defined(ICECREAM_STRING_VIEW_HEADER)
+        auto output_transcoder(std::function<std::string(std::string_view)>&& transcoder) -> Config&
         {
-            setOstreamTypeMode(os, OstreamTypeMode::debug);
-            ++it;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->output_transcoder_ =
+                [transcoder](detail::StringView str) -> std::string
+                {
+                    return transcoder({str.data(), str.size()});
+                };
+            return *this;
         }
+    #endif
 
-        if (it == end_it)
+        auto line_wrap_width() const -> size_t
         {
-            return os;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->line_wrap_width_.value();
         }
-        else
+
+        auto line_wrap_width(size_t value) -> Config&
         {
-            return {};
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->line_wrap_width_ = value;
+            return *this;
         }
-    }
 
-    class PrintingNode
-    {
-    private:
-        struct Stem
+        auto include_context() const -> bool
         {
-            std::string open;
-            std::string separator;
-            std::string close;
-            std::vector<PrintingNode> children;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->include_context_.value();
+        }
 
-            Stem(
-                StringView open_,
-                StringView separator_,
-                StringView close_,
-                std::vector<PrintingNode>&& children_
-            )
-                : open(open_.to_string())
-                , separator(separator_.to_string())
-                , close(close_.to_string())
-                , children(std::move(children_))
-            {}
-
-        };
-
-        Variant<std::string, Stem> content;
-
-        size_t n_code_unit;
-        size_t n_code_point;
-
-        auto is_leaf() const -> bool
+        auto include_context(bool value) -> Config&
         {
-            return this->content.index() == 0;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->include_context_ = value;
+            return *this;
         }
 
-        auto get_leaf() const -> StringView
+        auto context_delimiter() const -> std::string
         {
-            return get<std::string>(this->content);
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->context_delimiter_.value();
         }
 
-        auto get_stem() -> Stem&
+        auto context_delimiter(std::string value) -> Config&
         {
-            return get<Stem>(this->content);
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->context_delimiter_ = value;
+            return *this;
         }
 
-        auto get_stem() const -> Stem const&
+        auto max_range_elements() const -> size_t
         {
-            return get<Stem>(this->content);
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->max_range_elements_.value();
         }
 
-    public:
-        PrintingNode() = delete;
-        PrintingNode(PrintingNode const&) = delete;
-        PrintingNode& operator=(PrintingNode const&) = delete;
-
-        PrintingNode(PrintingNode&& other)
-            : content(std::move(other.content))
-            , n_code_unit(other.n_code_unit)
-            , n_code_point(other.n_code_point)
-        {}
+        auto max_range_elements(size_t value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->max_range_elements_ = value;
+            return *this;
+        }
 
-        PrintingNode& operator=(PrintingNode&& other)
+        auto max_nesting_depth() const -> size_t
         {
-            if (this != &other)
-            {
-                this->~PrintingNode();
-                new (this) PrintingNode(std::move(other));
-            }
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->max_nesting_depth_.value();
+        }
 
+        auto max_nesting_depth(size_t value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->max_nesting_depth_ = value;
             return *this;
         }
 
-        explicit PrintingNode(StringView leaf)
-            : content(leaf.to_string())
-            , n_code_unit(leaf.size())
-            , n_code_point(count_utf8_code_point(leaf))
-        {}
+        auto max_string_length() const -> size_t
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->max_string_length_.value();
+        }
 
-        PrintingNode(
-            StringView open,
-            StringView separator,
-            StringView close,
-            std::vector<PrintingNode> children
-        )
-            : content(
-                Stem(open, separator, close, std::move(children))
-            )
-            , n_code_unit{
-                [this]()
-                {
-                    // The enclosing chars.
-                    auto result = this->get_stem().open.size() + this->get_stem().close.size();
+        auto max_string_length(size_t value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->max_string_length_ = value;
+            return *this;
+        }
 
-                    // count the size of each child
-                    for (auto const& child : this->get_stem().children)
-                    {
-                        result += child.n_code_unit;
-                    }
+        auto max_output_bytes() const -> size_t
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->max_output_bytes_.value();
+        }
 
-                    // The separators.
-                    if (this->get_stem().children.size() > 1)
-                    {
-                        result +=
-                            (this->get_stem().children.size() - 1)
-                            * this->get_stem().separator.size();
-                    }
+        auto max_output_bytes(size_t value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->max_output_bytes_ = value;
+            return *this;
+        }
 
-                    return result;
-                }()
-            }
-            , n_code_point{
-                [this]()
-                {
-                    // The enclosing chars.
-                    auto result =
-                        count_utf8_code_point(this->get_stem().open)
-                        + count_utf8_code_point(this->get_stem().close);
+        auto range_edge_items() const -> size_t
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->range_edge_items_.value();
+        }
 
-                    // count the size of each child
-                    for (auto const& child : this->get_stem().children)
-                    {
-                        result += child.n_code_point;
-                    }
+        auto range_edge_items(size_t value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->range_edge_items_ = value;
+            return *this;
+        }
 
-                    // The separators.
-                    if (this->get_stem().children.size() > 1)
-                    {
-                        result +=
-                            (this->get_stem().children.size() - 1)
-                            * count_utf8_code_point(this->get_stem().separator);
-                    }
+        auto range_streaming_threshold() const -> size_t
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->range_streaming_threshold_.value();
+        }
 
-                    return result;
-                }()
-            }
-        {}
+        auto range_streaming_threshold(size_t value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->range_streaming_threshold_ = value;
+            return *this;
+        }
 
-        auto code_point_length() const -> size_t
+        auto parallel_range_threshold() const -> size_t
         {
-            return this->n_code_point;
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->parallel_range_threshold_.value();
         }
 
-        // Search among the children of `this` Tree, by a Tree having `key` as its
-        // content. Returns `nullptr` if no child has been found.
-        auto find_leaf(StringView key) -> PrintingNode*
+        auto parallel_range_threshold(size_t value) -> Config&
         {
-            auto to_visit = std::vector<PrintingNode*>{this};
-            while (!to_visit.empty())
-            {
-                auto current = to_visit.back();
-                to_visit.pop_back();
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->parallel_range_threshold_ = value;
+            return *this;
+        }
 
-                if (!current->is_leaf())
-                {
-                    for (auto& child : current->get_stem().children)
-                    {
-                        to_visit.push_back(&child);
-                    }
-                }
-                else if (current->get_leaf() == key)
-                {
-                    return current;
-                }
-            }
+        auto coalesce_repeats() const -> bool
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->coalesce_repeats_.value();
+        }
 
-            return nullptr;
+        auto coalesce_repeats(bool value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->coalesce_repeats_ = value;
+            return *this;
         }
 
-        // Print the branch content, in a unique line
-        auto print() const -> std::string
+        auto coalesce_flush_interval() const -> std::chrono::milliseconds
         {
-            auto result = std::string{};
-            result.reserve(this->n_code_unit);
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->coalesce_flush_interval_.value();
+        }
 
-            if (this->is_leaf())
-            {
-                result = this->get_leaf().to_string();
-            }
-            else
-            {
-                result = this->get_stem().open;
+        auto coalesce_flush_interval(std::chrono::milliseconds value) -> Config&
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            this->coalesce_flush_interval_ = value;
+            return *this;
+        }
 
-                for (
-                    auto it = this->get_stem().children.cbegin();
-                    it != this->get_stem().children.cend();
-                ){
-                    result += it->print();
+    protected:
 
-                    ++it;
+        Config() = default;
 
-                    if (it != this->get_stem().children.cend())
-                    {
-                        result += this->get_stem().separator;
-                    }
-                }
+        static auto make_output(std::ostream& stream) -> std::function<void(std::string const&)>
+        {
+            return detail::Output<std::ostream>{stream};
+        }
 
-                result += this->get_stem().close;
-            }
+        template <typename T>
+        static auto make_output(T& container) ->
+            typename std::enable_if<
+                detail::has_push_back_T<T, char>::value,
+                std::function<void(std::string const&)>
+            >::type
+        {
+            using OSIt = std::back_insert_iterator<T>;
+            return detail::Output<OSIt>{OSIt{container}};
+        }
 
-            return result;
+        template <typename T>
+        static auto make_output(T iterator) ->
+            typename std::enable_if<
+                detail::is_T_output_iterator<T, char>::value,
+                std::function<void(std::string const&)>
+            >::type
+        {
+            return detail::Output<T>{iterator};
         }
 
-        auto print(size_t const indent_level, size_t const line_wrap_width) const -> std::string
+        // The sink writing to std::cerr, the initial output of the global Config. Since
+        // std::cerr outlives any static object, its held repeats are noticed at the
+        // program exit.
+        static auto default_sink() -> std::shared_ptr<detail::Sink>
         {
-            auto result = std::string{};
-            result.reserve(this->n_code_unit);
+            static auto const sink = std::make_shared<detail::Sink>(
+                detail::Output<std::ostream>{std::cerr}, Level::trace, Renderer::text
+            );
+            static detail::ExitRepeatsFlusher const flusher{sink};
+            (void) flusher;
+            return sink;
+        }
 
-            // Leaf nodes will print its content regardless of being longer than the maximum line
-            // length, since there is no children to be split.
-            if (this->is_leaf())
+        // Notices the held repeats of the `sinks` being replaced, while their outputs are
+        // still alive. The repeats held when a Config scope ends are dropped, since its
+        // outputs may already have been destroyed.
+        static auto flush_repeats(detail::SinkList const& sinks) -> void
+        {
+            for (auto const& sink : sinks)
             {
-                result = this->get_leaf().to_string();
+                sink->flush_repeats();
             }
-            else
-            {
-                result = this->get_stem().open;
-                result += "\n";
+        }
 
-                auto const indent_lenght = indent_level * Config_::INDENT_BASE ;
-                for (
-                    auto it = this->get_stem().children.cbegin();
-                    it != this->get_stem().children.cend();
-                ){
-                    result += std::string(indent_level * Config_::INDENT_BASE, ' ');
+        mutable std::mutex attribute_mutex;
 
-                    if (indent_lenght + it->n_code_point <= line_wrap_width)
-                    {
-                        result += it->print();
-                    }
-                    else
-                    {
-                        result += it->print(indent_level+1, line_wrap_width);
-                    }
+        detail::AtomicHereditary<bool> enabled_{true};
 
-                    ++it;
+        detail::AtomicHereditary<Level> level_{Level::trace};
 
-                    if (it != this->get_stem().children.cend())
-                    {
-                        result += this->get_stem().separator;
-                        result += "\n";
-                    }
-                    else
-                    {
-                        result += "\n";
-                    }
+        detail::Hereditary<std::shared_ptr<detail::SinkList const>> sinks_{
+            std::make_shared<detail::SinkList>(detail::SinkList{Config::default_sink()})
+        };
+
+        detail::Hereditary<detail::Prefix> prefix_{
+            detail::Prefix(
+                []() -> std::string
+                {
+                    return "ic| ";
                 }
+            )
+        };
 
-                result +=
-                    std::string((indent_level-1) * Config_::INDENT_BASE, ' ')
-                    + this->get_stem().close;
-            }
+        detail::Hereditary<bool> decay_char_array_{false};
 
-            return result;
-        }
-    };
+        detail::Hereditary<bool> show_c_string_{true};
 
+        detail::Hereditary<bool> force_range_strategy_{true};
 
-    // -------------------------------------------------- make_printing_branch functions
+        detail::Hereditary<bool> force_tuple_strategy_{true};
 
-    template <typename T>
-    auto do_print_integral(
-        T const&, Config_ const&, std::ostringstream&
-    ) -> typename std::enable_if<!std::is_integral<remove_cvref_t<T>>::value, PrintingNode>::type
-    {
-        ICECREAM_UNREACHABLE;
-        return PrintingNode("");
-    }
+        detail::Hereditary<bool> force_variant_strategy_{true};
 
-    template <typename T>
-    auto do_print_integral(
-        T const& value, Config_ const& config, std::ostringstream& ostrm
-    ) -> typename std::enable_if<std::is_integral<remove_cvref_t<T>>::value, PrintingNode>::type
-    {
-        auto print_binary =
-            [&](bool uppercase_base)
+        detail::Hereditary<std::function<std::string(detail::WStringView)>> wide_string_transcoder_{
+            [](detail::WStringView str) -> std::string
             {
-                if (ostrm.flags() & std::ios_base::showbase)
+                auto const c_locale = std::string{std::setlocale(LC_ALL, nullptr)};
+                if (c_locale != "C" && c_locale != "POSIX")
                 {
-                    ostrm << (uppercase_base ? "0B" : "0b");
+                    #if defined(_MSC_VER)
+                        // Silence a warning due to a deprecated attribute in `std::wcrtomb`
+                        #pragma warning(suppress: 4996)
+                        return detail::xrtomb<wchar_t, std::wcrtomb>(str);
+                    #else
+                        return detail::xrtomb<wchar_t, std::wcrtomb>(str);
+                    #endif
                 }
-
-                auto const n_bits = sizeof(value) * CHAR_BIT;
-
-                // Flag to skip leading zeros
-                auto found_one = false;
-
-                // Loop through each bit from the most significant to the least significant
-                for (auto i = n_bits; (i--) > 0;)
+                else
                 {
-                    auto const bit = (value >> i) & 1;
-
-                    if (bit == 1) found_one = true;
-
-                    if (found_one || i == 0) // Always print at least the last bit
+                    switch (sizeof(wchar_t))
                     {
-                        ostrm << bit;
+                    case 2:
+                        {
+                            auto const utf32_str =
+                                detail::to_utf32_u32string(
+                                    detail::U16StringView(
+                                        reinterpret_cast<char16_t const*>(str.data()), str.size()
+                                    )
+                                );
+                            return detail::to_utf8_string(utf32_str);
+                        }
+                    case 4:
+                        return detail::to_utf8_string(
+                            detail::U32StringView(
+                                reinterpret_cast<char32_t const*>(str.data()), str.size()
+                            )
+                        );
+                    default:
+                        return "<?>";
                     }
                 }
-            };
-
-        switch (getOstreamTypeMode(ostrm))
-        {
-        case OstreamTypeMode::character:
-            if (std::is_same<remove_cvref_t<T>, bool>::value)
-            {
-                return PrintingNode("*Error* in formatting string");
             }
-            else if (value > static_cast<T>(127))
+        };
+
+        detail::Hereditary<std::function<std::string(detail::U32StringView str)>> unicode_transcoder_{
+            [](detail::U32StringView str) -> std::string
             {
-                return PrintingNode("*Error* Integral value outside the range of the char type");
+              #ifdef ICECREAM_UCHAR_HEADER
+                auto const c_locale = std::string{std::setlocale(LC_ALL, nullptr)};
+                if (c_locale != "C" && c_locale != "POSIX")
+                {
+                    return detail::xrtomb<char32_t, c32rtomb>(str);
+                }
+                else
+              #endif
+                {
+                    return detail::to_utf8_string(str);
+                }
             }
-            else
+        };
+
+        // Function to convert a string in "execution encoding" to "output encoding"
+        detail::Hereditary<std::function<std::string(detail::StringView)>> output_transcoder_{
+            [](detail::StringView str) -> std::string
             {
-                return do_print_char(static_cast<char>(value), config, ostrm);
+                return str.to_string();
             }
+        };
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::non_binary_integer:
-            ostrm << value;
-            return PrintingNode(ostrm.str());
+        detail::Hereditary<size_t> line_wrap_width_{70};
 
-        case OstreamTypeMode::binary:
-            print_binary(false);
-            return PrintingNode(ostrm.str());
+        detail::Hereditary<bool> include_context_{false};
 
-        case OstreamTypeMode::BINARY:
-            print_binary(true);
-            return PrintingNode(ostrm.str());
+        detail::Hereditary<std::string> context_delimiter_{"- "};
 
-        case OstreamTypeMode::debug:
-        case OstreamTypeMode::string:
-        default:
-            return PrintingNode("*Error* in formatting string");
-        }
-    }
+        detail::Hereditary<size_t> max_range_elements_{std::numeric_limits<size_t>::max()};
 
-    // Print any class that overloads operator<<(std::ostream&, T)
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) ->
-        typename std::enable_if<
-            is_streamable<T>::value
-            && !is_stl_formattable<T>::value
-            && !is_fmt_formattable<T>::value
-            && !bypass_baseline_printing<T>::value
-            , PrintingNode
-        >::type
+        detail::Hereditary<size_t> max_nesting_depth_{std::numeric_limits<size_t>::max()};
+
+        detail::Hereditary<size_t> max_string_length_{std::numeric_limits<size_t>::max()};
+
+        detail::Hereditary<size_t> max_output_bytes_{std::numeric_limits<size_t>::max()};
+
+        detail::Hereditary<size_t> range_edge_items_{0};
+
+        detail::Hereditary<size_t> range_streaming_threshold_{std::numeric_limits<size_t>::max()};
+
+        detail::Hereditary<size_t> parallel_range_threshold_{std::numeric_limits<size_t>::max()};
+
+        detail::Hereditary<bool> coalesce_repeats_{false};
+
+        detail::Hereditary<std::chrono::milliseconds> coalesce_flush_interval_{
+            std::chrono::milliseconds{1000}
+        };
+    };
+
+
+namespace detail {
+
+    // Inherits from icecream::Config, and implements access to attributes which shoud not
+    // be exposed to public.
+    class Config_
+        : public ::icecream::Config
     {
-        if (config.force_variant_strategy() && is_variant<remove_ref_t< T>>::value)
+    public:
+
+        using Config::Config;
+
+        Config_(Config_ const&) = delete;
+
+        Config_(Config_&&) = delete;
+
+        auto operator=(Config_ const&) -> Config_& = delete;
+
+        auto operator=(Config_&&) -> Config_& = delete;
+
+        constexpr static size_t INDENT_BASE = 4;
+
+        static auto global() -> Config_&
         {
-            return do_print_variant(std::forward<T>(value), fmt, config);
+            static Config_ global_{};
+            return global_;
         }
 
-        auto mb_ostrm = build_ostream(fmt);
-        if (!mb_ostrm)
+        auto get_sinks() const -> std::shared_ptr<SinkList const>
         {
-            return PrintingNode("*Error* in formatting string");
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->sinks_.value();
         }
 
-        if (std::is_integral<remove_cvref_t<T>>::value)
+        // Writes to the `sink` the `text` of a line printed by the call site at `file` and
+        // `line`, whose `prefix` is the beginning of `text`. When coalescing the repeats, a
+        // text equal to the last one written to that sink, apart from its prefix, will
+        // only be counted. The comparison is done before the transcoding.
+        auto write_line(
+            Sink& sink, StringView prefix, StringView file, int line, std::string const& text
+        ) -> void
         {
-            return do_print_integral(value, config, *mb_ostrm);
+            if (!this->coalesce_repeats())
+            {
+                sink.write(this->transcode_output(text));
+                return;
+            }
+
+            auto hasher = Xxh64{};
+            hasher.update(text.data() + prefix.size(), text.size() - prefix.size());
+
+            auto n_repeats = size_t{0};
+            auto const is_new = sink.coalescer().submit(
+                file,
+                line,
+                hasher.digest(),
+                prefix,
+                this->coalesce_flush_interval(),
+                [this]() -> std::function<std::string(StringView)>
+                {
+                    std::lock_guard<std::mutex> guard(this->attribute_mutex);
+                    return this->output_transcoder_.value();
+                },
+                n_repeats
+            );
+
+            this->write_repeats_notice(sink, prefix, n_repeats);
+            if (is_new)
+            {
+                sink.write(this->transcode_output(text));
+            }
         }
-        else
+
+        // Notices the held repeats, in all the sinks, whose flush interval has expired. It
+        // is called at every printing IC call, including the ones that won't write to those
+        // sinks, so that the repeats of a line no longer printed aren't held indefinitely.
+        auto flush_expired_repeats() -> void
         {
-            *mb_ostrm << value;
-            return PrintingNode(mb_ostrm->str());
+            if (!this->coalesce_repeats())
+            {
+                return;
+            }
+
+            auto const flush_interval = this->coalesce_flush_interval();
+            for (auto const& sink : *this->get_sinks())
+            {
+                sink->flush_expired_repeats(flush_interval);
+            }
         }
-    }
 
-  #if defined(ICECREAM_STL_FORMAT_RANGES)
+        // Must be called before writing to the `sink` anything not submitted to its repeat
+        // coalescer, so that the held repeats are noticed first.
+        auto end_repeats(Sink& sink, StringView prefix) -> void
+        {
+            if (this->coalesce_repeats())
+            {
+                this->write_repeats_notice(sink, prefix, sink.coalescer().reset());
+            }
+        }
 
-    // This class will wrap a range T, signaling it as "hijacked" to avoid a circular
-    // inheritance in the `std::formatter` specialization below.
-    template <std::ranges::forward_range T>
-    struct HijackTag
-    {
-        T const& value;
+        auto gen_prefix() -> std::string
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->prefix_.value()();
+        }
 
-        HijackTag(T const& t)
-            : value(t)
-        {}
+        auto transcode_wide_string(WStringView str) const -> std::string
+        {
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->wide_string_transcoder_.value()(str);
+        }
 
-        auto begin() const
+        auto transcode_unicode(U32StringView str) const -> std::string
         {
-            return std::begin(value);
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->unicode_transcoder_.value()(str);
         }
 
-        auto end() const
+        auto transcode_output(StringView str) const -> std::string
         {
-            return std::end(value);
+            std::lock_guard<std::mutex> guard(this->attribute_mutex);
+            return this->output_transcoder_.value()(str);
+        }
+
+    private:
+
+        Config_() = default;
+
+        auto write_repeats_notice(Sink& sink, StringView prefix, size_t n_repeats) -> void
+        {
+            if (n_repeats > 0)
+            {
+                sink.write(this->transcode_output(make_repeats_notice(prefix, n_repeats)));
+            }
         }
     };
 
-}} namespace std {
 
-    // Starting from C++23 the formatting library has a concept specialization to print
-    // any *range*. Because of this any *range* that Icecream-cpp could try to print would
-    // be handled by the STL's Formatting function overload of the *baseline printable*
-    // strategy.
-    //
+    // -------------------------------------------------- Tree
+
+    enum class OstreamTypeMode : long
+    {
+        none,
+        debug,
+        binary,
+        BINARY,
+        character,
+        string,
+        non_binary_integer
+    };
+
+    inline auto xidx_type_mode() -> int
+    {
+        static auto const xindex = std::ios_base::xalloc();
+        return xindex;
+    }
+
+    inline auto getOstreamTypeMode(std::ostringstream& ostrm) -> OstreamTypeMode
+    {
+        return static_cast<OstreamTypeMode>(ostrm.iword(xidx_type_mode()));
+    }
+
+    inline auto setOstreamTypeMode(std::ostringstream& ostrm, OstreamTypeMode type) -> void
+    {
+        ostrm.iword(xidx_type_mode()) = static_cast<long>(type);
+    }
+
+    // Builds an ostringstream and sets its state accordingly to `fmt` string
+    inline auto build_ostream(StringView fmt) -> Optional<std::ostringstream>
+    {
+        // format_spec ::=  [[fill]align][sign]["#"][width]["." precision][type]
+        // fill        ::=  <a character>
+        // align       ::=  "<" | ">" | "^"
+        // sign        ::=  "+" | "-"
+        // width       ::=  integer
+        // precision   ::=  integer
+        // type        ::=  "a" | "A" | "b" | "B" | "c" | "d" | "e" | "E" | "f" | "F" | "g" | "G" | "o" | "s" | "x" | "X" | "?"
+        // integer     ::=  digit+
+        // digit       ::=  "0"..."9"
+
+        auto os = std::ostringstream{};
+        os << std::boolalpha;
+        setOstreamTypeMode(os, OstreamTypeMode::none);
+
+        auto it = std::begin(fmt);
+        auto end_it = std::end(fmt);
+
+        if (it == end_it) return os;
+
+        // [[fill]align]
+        {
+            auto fill_char = os.fill();
+            if (*it != '<' && *it != '>' && *it != '^')
+            {
+                auto la_it = it+1;
+                if (la_it != end_it && (*la_it == '<' || *la_it == '>' || *la_it == '^'))
+                {
+                    fill_char = *it;
+                    ++it;
+                }
+            }
+            if (it != end_it && *it == '<')
+            {
+                os << std::left << std::setfill(fill_char);
+                ++it;
+            }
+            else if (it != end_it && *it == '>')
+            {
+                os << std::right << std::setfill(fill_char);
+                ++it;
+            }
+            else if (it != end_it && *it == '^')
+            {
+                os << std::internal << std::setfill(fill_char);
+                ++it;
+            }
+        }
+
+        // [sign]
+        if (it != end_it && *it == '+')
+        {
+            os << std::showpos;
+            ++it;
+        }
+        else if (it != end_it && *it == '-')
+        {
+            os << std::noshowpos;
+            ++it;
+        }
+
+        // ["#"]
+        if (it != end_it && *it == '#')
+        {
+            os << std::showbase << std::showpoint;
+            ++it;
+        }
+
+        // [width]
+        {
+            auto b_it = it;
+            while (it != end_it && *it >= '0' && *it <= '9') ++it;
+            if (it != b_it)
+            {
+                os << std::setw(std::stoi(std::string(b_it, it)));
+            }
+        }
+
+        // ["." precision]
+        if (it != end_it && *it == '.')
+        {
+            auto b_it = it+1;
+            auto p_it = b_it;
+            while (p_it != end_it && *p_it >= '0' && *p_it <= '9') ++p_it;
+            if (p_it != b_it)
+            {
+                os << std::setprecision(std::stoi(std::string(b_it, p_it)));
+                it = p_it;
+            }
+        }
+
+        // [type]
+        if (it != end_it && *it == 'a')
+        {
+            os << std::hexfloat << std::nouppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'A')
+        {
+            os << std::hexfloat << std::uppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'b')
+        {
+            setOstreamTypeMode(os, OstreamTypeMode::binary);
+            ++it;
+        }
+        else if (it != end_it && *it == 'B')
+        {
+            setOstreamTypeMode(os, OstreamTypeMode::BINARY);
+            ++it;
+        }
+        else if (it != end_it && *it == 'c')
+        {
+            setOstreamTypeMode(os, OstreamTypeMode::character);
+            ++it;
+        }
+        else if (it != end_it && *it == 'd')
+        {
+            os << std::dec << std::noboolalpha;
+            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
+            ++it;
+        }
+        else if (it != end_it && *it == 'e')
+        {
+            os << std::scientific << std::nouppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'E')
+        {
+            os << std::scientific << std::uppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'f')
+        {
+            os << std::fixed << std::nouppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'F')
+        {
+            os << std::fixed << std::uppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'g')
+        {
+            os << std::defaultfloat << std::nouppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'G')
+        {
+            os << std::defaultfloat << std::uppercase;
+            ++it;
+        }
+        else if (it != end_it && *it == 'o')
+        {
+            os << std::oct << std::noboolalpha;
+            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
+            ++it;
+        }
+        else if (it != end_it && *it == 's')
+        {
+            setOstreamTypeMode(os, OstreamTypeMode::string);
+            ++it;
+        }
+        else if (it != end_it && *it == 'x')
+        {
+            os << std::hex << std::nouppercase << std::noboolalpha;
+            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
+            ++it;
+        }
+        else if (it != end_it && *it == 'X')
+        {
+            os << std::hex << std::uppercase << std::noboolalpha;
+            setOstreamTypeMode(os, OstreamTypeMode::non_binary_integer);
+            ++it;
+        }
+        else if (it != end_it && *it == '?')
+        {
+            setOstreamTypeMode(os, OstreamTypeMode::debug);
+            ++it;
+        }
+
+        if (it == end_it)
+        {
+            return os;
+        }
+        else
+        {
+            return {};
+        }
+    }
+
+    // RAII holder of the byte budget of a single IC call. While an instance is alive, the
+    // size of every built leaf node is accounted to it, so that the tree building can be
+    // cut short after the budget has been exceeded.
+    class OutputBudget
+    {
+    public:
+        explicit OutputBudget(size_t max_bytes)
+            : max_bytes_(max_bytes)
+            , used_bytes_(0)
+            , previous_(OutputBudget::current())
+        {
+            OutputBudget::current() = this;
+        }
+
+        ~OutputBudget()
+        {
+            OutputBudget::current() = this->previous_;
+        }
+
+        OutputBudget(OutputBudget const&) = delete;
+
+        auto operator=(OutputBudget const&) -> OutputBudget& = delete;
+
+        static auto consume(size_t n_bytes) -> void
+        {
+            if (auto const budget = OutputBudget::current())
+            {
+                budget->used_bytes_ += n_bytes;
+            }
+        }
+
+        static auto is_exhausted() -> bool
+        {
+            auto const budget = OutputBudget::current();
+            return budget && budget->used_bytes_ > budget->max_bytes_;
+        }
+
+        // Whether there is a budget in place, limiting the printed bytes.
+        static auto is_limited() -> bool
+        {
+            auto const budget = OutputBudget::current();
+            return budget && budget->max_bytes_ != std::numeric_limits<size_t>::max();
+        }
+
+        // The number of bytes still available, or the maximum size_t value if there is no
+        // budget in place.
+        static auto remaining() -> size_t
+        {
+            auto const budget = OutputBudget::current();
+            if (!budget)
+            {
+                return std::numeric_limits<size_t>::max();
+            }
+
+            return budget->used_bytes_ < budget->max_bytes_ ?
+                budget->max_bytes_ - budget->used_bytes_ : 0;
+        }
+
+    private:
+        size_t max_bytes_;
+        size_t used_bytes_;
+        OutputBudget* previous_;
+
+        static auto current() -> OutputBudget*&
+        {
+            static thread_local auto budget = static_cast<OutputBudget*>(nullptr);
+            return budget;
+        }
+    };
+
+
+    // -------------------------------------------------- JSON
+
+    // RAII flag telling that the nodes being built in the current thread will be written
+    // as JSON, so that the string and character leaves must also keep their raw contents.
+    class JsonPrinting
+    {
+    public:
+        explicit JsonPrinting(bool is_active)
+            : previous_(JsonPrinting::current())
+        {
+            JsonPrinting::current() = is_active;
+        }
+
+        ~JsonPrinting()
+        {
+            JsonPrinting::current() = this->previous_;
+        }
+
+        JsonPrinting(JsonPrinting const&) = delete;
+
+        auto operator=(JsonPrinting const&) -> JsonPrinting& = delete;
+
+        static auto is_active() -> bool
+        {
+            return JsonPrinting::current();
+        }
+
+    private:
+        bool previous_;
+
+        static auto current() -> bool&
+        {
+            static thread_local auto is_active = false;
+            return is_active;
+        }
+    };
+
+    // The length of the well-formed UTF-8 sequence at the beginning of the `size` bytes
+    // at `data`, or zero if it is ill-formed. Overlong encodings, surrogates, and code
+    // points above U+10FFFF are ill-formed.
+    inline auto get_utf8_sequence_length(unsigned char const* data, size_t size) -> size_t
+    {
+        auto const c = data[0];
+        auto const length =
+            c < 0x80 ? size_t{1}
+            : c < 0xC2 ? size_t{0}
+            : c < 0xE0 ? size_t{2}
+            : c < 0xF0 ? size_t{3}
+            : c < 0xF5 ? size_t{4}
+            : size_t{0};
+        if (length == 0 || length > size)
+        {
+            return 0;
+        }
+
+        // The allowed range of the second byte
+        auto const low =
+            c == 0xE0 ? 0xA0
+            : c == 0xF0 ? 0x90
+            : 0x80;
+        auto const high =
+            c == 0xED ? 0x9F
+            : c == 0xF4 ? 0x8F
+            : 0xBF;
+        if (length > 1 && (data[1] < low || data[1] > high))
+        {
+            return 0;
+        }
+
+        for (auto i = size_t{2}; i < length; ++i)
+        {
+            if ((data[i] & 0xC0) != 0x80)
+            {
+                return 0;
+            }
+        }
+
+        return length;
+    }
+
+    // Appends `str` to `out` as a JSON string, quoted and escaped. Any ill-formed UTF-8
+    // sequence is replaced by a U+FFFD replacement character. The characters are checked
+    // eight at a time, packed in a 64 bits word, and copied in whole runs up to the next
+    // one needing to be escaped or validated.
+    inline auto append_json_string(std::string& out, StringView str) -> void
+    {
+        static char const digits[] = "0123456789abcdef";
+        constexpr auto ones = uint64_t{0x0101010101010101};
+        constexpr auto highs = uint64_t{0x8080808080808080};
+
+        // If any byte of `word` is lesser than `n`, for a `n` up to 128.
+        auto const has_less =
+            [](uint64_t word, uint64_t n) -> bool
+            {
+                return ((word - ones * n) & ~word & highs) != 0;
+            };
+
+        out += '"';
+
+        auto const data = str.data();
+        auto const size = str.size();
+        auto run_begin = size_t{0};
+        auto i = size_t{0};
+        while (i < size)
+        {
+            if (size - i >= 8)
+            {
+                auto word = uint64_t{0};
+                std::memcpy(&word, data + i, 8);
+                auto const needs_escape =
+                    (word & highs) != 0
+                    || has_less(word, 0x20)
+                    || has_less(word ^ (ones * uint64_t{'"'}), 1)
+                    || has_less(word ^ (ones * uint64_t{'\\'}), 1);
+                if (!needs_escape)
+                {
+                    i += 8;
+                    continue;
+                }
+            }
+
+            auto const c = static_cast<unsigned char>(data[i]);
+            if (c >= 0x80)
+            {
+                auto const length = get_utf8_sequence_length(
+                    reinterpret_cast<unsigned char const*>(data + i), size - i
+                );
+                if (length > 0)
+                {
+                    i += length;
+                    continue;
+                }
+
+                out.append(data + run_begin, i - run_begin);
+                out += "\\ufffd";
+                ++i;
+                run_begin = i;
+                continue;
+            }
+
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                ++i;
+                continue;
+            }
+
+            out.append(data + run_begin, i - run_begin);
+            switch (c)
+            {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += digits[c >> 4];
+                out += digits[c & 0x0F];
+            }
+            ++i;
+            run_begin = i;
+        }
+        out.append(data + run_begin, size - run_begin);
+
+        out += '"';
+    }
+
+    // Checks if `str` is a number accordingly to the JSON grammar.
+    inline auto is_json_number(StringView str) -> bool
+    {
+        auto const is_digit = [](char c) -> bool {return c >= '0' && c <= '9';};
+
+        auto i = size_t{0};
+        auto const n = str.size();
+
+        if (i < n && str[i] == '-') ++i;
+        if (i == n) return false;
+
+        if (str[i] == '0')
+        {
+            ++i;
+        }
+        else if (is_digit(str[i]))
+        {
+            while (i < n && is_digit(str[i])) ++i;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (i < n && str[i] == '.')
+        {
+            ++i;
+            if (i == n || !is_digit(str[i])) return false;
+            while (i < n && is_digit(str[i])) ++i;
+        }
+
+        if (i < n && (str[i] == 'e' || str[i] == 'E'))
+        {
+            ++i;
+            if (i < n && (str[i] == '+' || str[i] == '-')) ++i;
+            if (i == n || !is_digit(str[i])) return false;
+            while (i < n && is_digit(str[i])) ++i;
+        }
+
+        return i == n;
+    }
+
+    // Appends the JSON value of the text of a leaf node. Numbers and booleans are written
+    // as they are, and any other text as a string.
+    inline auto append_json_scalar(std::string& out, StringView text) -> void
+    {
+        if (is_json_number(text) || text == "true" || text == "false")
+        {
+            out.append(text.data(), text.size());
+        }
+        else
+        {
+            append_json_string(out, text);
+        }
+    }
+
+    // The label of a leaf text like "count: 2", i.e. a word before a ": " separator, or an
+    // empty string if there is none.
+    inline auto get_leaf_json_label(StringView text) -> StringView
+    {
+        auto const is_word_char =
+            [](char c) -> bool
+            {
+                return
+                    (c >= 'a' && c <= 'z')
+                    || (c >= 'A' && c <= 'Z')
+                    || (c >= '0' && c <= '9')
+                    || c == '_';
+            };
+
+        auto i = size_t{0};
+        while (i < text.size() && is_word_char(text[i]))
+        {
+            ++i;
+        }
+
+        if (i == 0 || i + 2 >= text.size() || text[i] != ':' || text[i+1] != ' ')
+        {
+            return StringView{};
+        }
+        return text.substr(0, i);
+    }
+
+    class PrintingNode
+    {
+    private:
+        struct Stem
+        {
+            std::string open;
+            std::string separator;
+            std::string close;
+            std::vector<PrintingNode> children;
+
+            Stem(
+                StringView open_,
+                StringView separator_,
+                StringView close_,
+                std::vector<PrintingNode>&& children_
+            )
+                : open(open_.to_string())
+                , separator(separator_.to_string())
+                , close(close_.to_string())
+                , children(std::move(children_))
+            {}
+
+        };
+
+        Variant<std::string, Stem> content;
+
+        size_t n_code_unit;
+        size_t n_code_point;
+
+        // The raw contents of a string or character leaf, written instead of its text when
+        // printing JSON. Only set while a JsonPrinting is active.
+        std::unique_ptr<std::string> raw_text;
+
+        auto is_leaf() const -> bool
+        {
+            return this->content.index() == 0;
+        }
+
+        auto get_leaf() const -> StringView
+        {
+            return get<std::string>(this->content);
+        }
+
+        auto get_stem() -> Stem&
+        {
+            return get<Stem>(this->content);
+        }
+
+        auto get_stem() const -> Stem const&
+        {
+            return get<Stem>(this->content);
+        }
+
+    public:
+        PrintingNode() = delete;
+        PrintingNode(PrintingNode const&) = delete;
+        PrintingNode& operator=(PrintingNode const&) = delete;
+
+        PrintingNode(PrintingNode&& other)
+            : content(std::move(other.content))
+            , n_code_unit(other.n_code_unit)
+            , n_code_point(other.n_code_point)
+            , raw_text(std::move(other.raw_text))
+        {}
+
+        PrintingNode& operator=(PrintingNode&& other)
+        {
+            if (this != &other)
+            {
+                this->~PrintingNode();
+                new (this) PrintingNode(std::move(other));
+            }
+
+            return *this;
+        }
+
+        explicit PrintingNode(StringView leaf)
+            : content(leaf.to_string())
+            , n_code_unit(leaf.size())
+            , n_code_point(count_utf8_code_point(leaf))
+        {
+            OutputBudget::consume(this->n_code_unit);
+        }
+
+        PrintingNode(
+            StringView open,
+            StringView separator,
+            StringView close,
+            std::vector<PrintingNode> children
+        )
+            : content(
+                Stem(open, separator, close, std::move(children))
+            )
+            , n_code_unit{
+                [this]()
+                {
+                    // The enclosing chars.
+                    auto result = this->get_stem().open.size() + this->get_stem().close.size();
+
+                    // count the size of each child
+                    for (auto const& child : this->get_stem().children)
+                    {
+                        result += child.n_code_unit;
+                    }
+
+                    // The separators.
+                    if (this->get_stem().children.size() > 1)
+                    {
+                        result +=
+                            (this->get_stem().children.size() - 1)
+                            * this->get_stem().separator.size();
+                    }
+
+                    return result;
+                }()
+            }
+            , n_code_point{
+                [this]()
+                {
+                    // The enclosing chars.
+                    auto result =
+                        count_utf8_code_point(this->get_stem().open)
+                        + count_utf8_code_point(this->get_stem().close);
+
+                    // count the size of each child
+                    for (auto const& child : this->get_stem().children)
+                    {
+                        result += child.n_code_point;
+                    }
+
+                    // The separators.
+                    if (this->get_stem().children.size() > 1)
+                    {
+                        result +=
+                            (this->get_stem().children.size() - 1)
+                            * count_utf8_code_point(this->get_stem().separator);
+                    }
+
+                    return result;
+                }()
+            }
+        {}
+
+        auto code_point_length() const -> size_t
+        {
+            return this->n_code_point;
+        }
+
+        // Sets the raw contents of a string or character leaf, to be written as a JSON
+        // string.
+        auto set_raw_text(std::string text) -> void
+        {
+            this->raw_text.reset(new std::string(std::move(text)));
+        }
+
+        // Search among the children of `this` Tree, by a Tree having `key` as its
+        // content. Returns `nullptr` if no child has been found.
+        auto find_leaf(StringView key) -> PrintingNode*
+        {
+            auto to_visit = std::vector<PrintingNode*>{this};
+            while (!to_visit.empty())
+            {
+                auto current = to_visit.back();
+                to_visit.pop_back();
+
+                if (!current->is_leaf())
+                {
+                    for (auto& child : current->get_stem().children)
+                    {
+                        to_visit.push_back(&child);
+                    }
+                }
+                else if (current->get_leaf() == key)
+                {
+                    return current;
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Print the branch content, in a unique line
+        auto print() const -> std::string
+        {
+            auto result = std::string{};
+            result.reserve(this->n_code_unit);
+
+            if (this->is_leaf())
+            {
+                result = this->get_leaf().to_string();
+            }
+            else
+            {
+                result = this->get_stem().open;
+
+                for (
+                    auto it = this->get_stem().children.cbegin();
+                    it != this->get_stem().children.cend();
+                ){
+                    result += it->print();
+
+                    ++it;
+
+                    if (it != this->get_stem().children.cend())
+                    {
+                        result += this->get_stem().separator;
+                    }
+                }
+
+                result += this->get_stem().close;
+            }
+
+            return result;
+        }
+
+        auto print(size_t const indent_level, size_t const line_wrap_width) const -> std::string
+        {
+            auto result = std::string{};
+            result.reserve(this->n_code_unit);
+
+            // Leaf nodes will print its content regardless of being longer than the maximum line
+            // length, since there is no children to be split.
+            if (this->is_leaf())
+            {
+                result = this->get_leaf().to_string();
+            }
+            else
+            {
+                result = this->get_stem().open;
+                result += "\n";
+
+                auto const indent_lenght = indent_level * Config_::INDENT_BASE ;
+                for (
+                    auto it = this->get_stem().children.cbegin();
+                    it != this->get_stem().children.cend();
+                ){
+                    result += std::string(indent_level * Config_::INDENT_BASE, ' ');
+
+                    if (indent_lenght + it->n_code_point <= line_wrap_width)
+                    {
+                        result += it->print();
+                    }
+                    else
+                    {
+                        result += it->print(indent_level+1, line_wrap_width);
+                    }
+
+                    ++it;
+
+                    if (it != this->get_stem().children.cend())
+                    {
+                        result += this->get_stem().separator;
+                        result += "\n";
+                    }
+                    else
+                    {
+                        result += "\n";
+                    }
+                }
+
+                result +=
+                    std::string((indent_level-1) * Config_::INDENT_BASE, ' ')
+                    + this->get_stem().close;
+            }
+
+            return result;
+        }
+
+        // Appends the JSON value of this node to `out`. Ranges and tuples are written as
+        // arrays, and nodes whose children are all labeled, like "{count: 2, min: 1}", as
+        // objects. A node of any other shape is written as the string of its text.
+        auto print_json(std::string& out) const -> void
+        {
+            if (this->raw_text)
+            {
+                append_json_string(out, *this->raw_text);
+                return;
+            }
+
+            if (this->is_leaf())
+            {
+                append_json_scalar(out, this->get_leaf());
+                return;
+            }
+
+            auto const& stem = this->get_stem();
+            if (!this->get_json_label().empty())
+            {
+                out += '{';
+                this->print_json_member(out);
+                out += '}';
+                return;
+            }
+
+            auto const is_object =
+                stem.close == "}"
+                && !stem.children.empty()
+                && std::all_of(
+                    stem.children.begin(),
+                    stem.children.end(),
+                    [](PrintingNode const& child) {return !child.get_json_label().empty();}
+                );
+            auto const is_array = stem.close == "]" || stem.close == ")" || stem.close == "}";
+
+            if (!is_object && !is_array)
+            {
+                append_json_string(out, this->print());
+                return;
+            }
+
+            out += is_object ? '{' : '[';
+            for (auto it = stem.children.begin(); it != stem.children.end(); ++it)
+            {
+                if (it != stem.children.begin())
+                {
+                    out += ',';
+                }
+
+                if (is_object)
+                {
+                    it->print_json_member(out);
+                }
+                else
+                {
+                    it->print_json(out);
+                }
+            }
+            out += is_object ? '}' : ']';
+        }
+
+    private:
+        // The label of a node printed as "label: value", either a leaf or a labeled node,
+        // or an empty string if it isn't one.
+        auto get_json_label() const -> StringView
+        {
+            if (this->raw_text)
+            {
+                return StringView{};
+            }
+
+            if (this->is_leaf())
+            {
+                return get_leaf_json_label(this->get_leaf());
+            }
+
+            auto const& stem = this->get_stem();
+            auto const& open = stem.open;
+            if (
+                stem.children.size() == 1
+                && stem.separator.empty()
+                && stem.close.empty()
+                && open.size() > 2
+                && open.compare(open.size() - 2, 2, ": ") == 0
+            ) {
+                return StringView(open.data(), open.size() - 2);
+            }
+
+            return StringView{};
+        }
+
+        // Appends the `"label":value` JSON member of a labeled node.
+        auto print_json_member(std::string& out) const -> void
+        {
+            auto const label = this->get_json_label();
+            append_json_string(out, label);
+            out += ':';
+
+            if (this->is_leaf())
+            {
+                append_json_scalar(out, this->get_leaf().substr(label.size() + 2));
+            }
+            else
+            {
+                this->get_stem().children.front().print_json(out);
+            }
+        }
+    };
+
+    // Builds the node printing `node` after a `label`, as in "label: node".
+    inline auto make_labeled_node(StringView label, PrintingNode&& node) -> PrintingNode
+    {
+        auto children = std::vector<PrintingNode>{};
+        children.push_back(std::move(node));
+        return PrintingNode(label, "", "", std::move(children));
+    }
+
+    // Builds the node of the "hash" formatting, with the `size` of the hashed value and the
+    // hexadecimal digits of its `hash`.
+    inline auto make_hash_node(size_t size, uint64_t hash) -> PrintingNode
+    {
+        static char const digits[] = "0123456789abcdef";
+
+        auto hash_digits = std::string(16, '0');
+        for (auto i = size_t{0}; i < hash_digits.size(); ++i)
+        {
+            hash_digits[hash_digits.size() - 1 - i] = digits[(hash >> (4 * i)) & 0x0F];
+        }
+
+        auto children = std::vector<PrintingNode>{};
+        children.push_back(PrintingNode("size: " + std::to_string(size)));
+        children.push_back(PrintingNode("hash: " + hash_digits));
+        return PrintingNode("{", ", ", "}", std::move(children));
+    }
+
+    // Builds the "hash" formatting node of the `size` code units of a string.
+    template <typename CharT>
+    auto make_string_hash_node(CharT const* data, size_t size) -> PrintingNode
+    {
+        auto hasher = Xxh64{};
+        hasher.update(data, size * sizeof(CharT));
+        return make_hash_node(size, hasher.digest());
+    }
+
+    // RAII counter of how many ranges and tuples are enclosing the node being currently
+    // built. Used to bound the printing depth of deeply nested, or recursive, structures.
+    class NestingLevel
+    {
+    public:
+        NestingLevel()
+            : n_levels_(1)
+        {
+            ++NestingLevel::depth();
+        }
+
+        // Enters `n_levels` levels at once. Used when a thread continues the printing of
+        // other thread, which was at that nesting level.
+        explicit NestingLevel(size_t n_levels)
+            : n_levels_(n_levels)
+        {
+            NestingLevel::depth() += n_levels;
+        }
+
+        ~NestingLevel()
+        {
+            NestingLevel::depth() -= this->n_levels_;
+        }
+
+        NestingLevel(NestingLevel const&) = delete;
+
+        auto operator=(NestingLevel const&) -> NestingLevel& = delete;
+
+        // The number of enclosing levels, this one included.
+        static auto current() -> size_t
+        {
+            return NestingLevel::depth();
+        }
+
+    private:
+        size_t n_levels_;
+
+        static auto depth() -> size_t&
+        {
+            static thread_local auto value = size_t{0};
+            return value;
+        }
+    };
+
+    // Writes the output of an IC call progressively, when it has a huge range argument.
+    // Instead of building the printing nodes of all the range elements before writing any
+    // output, they are written in chunks as soon as it is known that the range will be
+    // printed in multiple lines. The written output is the same as when printing a forest
+    // in multiple lines.
+    class RangeStreamer
+    {
+    public:
+        using Forest = std::vector<std::tuple<StringView, PrintingNode>>;
+
+        // The approximate number of bytes of range elements written at once.
+        constexpr static size_t CHUNK_SIZE = 1 << 16;
+
+        // `header` is the `prefix` and the context of the IC call. No range will be
+        // streamed if `sink` is a null pointer.
+        RangeStreamer(
+            Config_& config, Sink* sink, std::string prefix, std::string header
+        )
+            : config_(config)
+            , sink_(sink)
+            , prefix_(std::move(prefix))
+            , header_(std::move(header))
+            , threshold_(
+                sink != nullptr
+                    ? config.range_streaming_threshold()
+                    : std::numeric_limits<size_t>::max()
+            )
+            , line_wrap_width_(config.line_wrap_width())
+            , forest_(nullptr)
+            , n_written_(0)
+            , n_code_points_(0)
+            , is_started_(false)
+            , previous_(RangeStreamer::current())
+        {
+            RangeStreamer::current() = this;
+        }
+
+        ~RangeStreamer()
+        {
+            RangeStreamer::current() = this->previous_;
+        }
+
+        RangeStreamer(RangeStreamer const&) = delete;
+
+        auto operator=(RangeStreamer const&) -> RangeStreamer& = delete;
+
+        // Must be called before building the printing node of each IC argument.
+        static auto enter_argument(Forest const& forest, StringView arg_name) -> void
+        {
+            if (auto const streamer = RangeStreamer::current())
+            {
+                streamer->forest_ = &forest;
+                streamer->arg_name_ = arg_name;
+            }
+        }
+
+        // Returns the streamer to an IC argument range having `size` elements, or a null
+        // pointer if it shouldn't be streamed.
+        static auto find(size_t size) -> RangeStreamer*
+        {
+            auto const streamer = RangeStreamer::current();
+            return
+                (streamer && streamer->forest_ && size >= streamer->threshold_) ?
+                    streamer : nullptr;
+        }
+
+        auto is_started() const -> bool
+        {
+            return this->is_started_;
+        }
+
+        auto line_wrap_width() const -> size_t
+        {
+            return this->line_wrap_width_;
+        }
+
+        // Starts streaming the current argument, writing all the output preceding it.
+        auto begin_range(StringView opening) -> void
+        {
+            if (!this->is_started_)
+            {
+                this->config_.end_repeats(*this->sink_, this->prefix_);
+                this->write(this->header_ + "\n");
+                this->is_started_ = true;
+            }
+
+            this->write_entries(*this->forest_);
+            this->write(
+                std::string(this->n_written_ > 0 ? ",\n" : "")
+                + std::string(Config_::INDENT_BASE, ' ')
+                + this->arg_name_.to_string()
+                + ": "
+                + opening.to_string()
+                + "\n"
+            );
+
+            // The streamed argument itself
+            ++this->n_written_;
+        }
+
+        // Writes the first `n_nodes` elements in `nodes`. If `is_range_end` is true, the
+        // last of them is the last range element too.
+        auto write_elements(
+            std::vector<PrintingNode> const& nodes, size_t n_nodes, bool is_range_end
+        ) -> void
+        {
+            auto const indent = std::string(2 * Config_::INDENT_BASE, ' ');
+
+            auto chunk = std::string{};
+            for (auto i = size_t{0}; i < n_nodes; ++i)
+            {
+                chunk += indent;
+                if (indent.size() + nodes[i].code_point_length() <= this->line_wrap_width_)
+                {
+                    chunk += nodes[i].print();
+                }
+                else
+                {
+                    chunk += nodes[i].print(3, this->line_wrap_width_);
+                }
+                chunk += (is_range_end && i + 1 == n_nodes) ? "\n" : ", \n";
+            }
+
+            this->write(chunk);
+        }
+
+        auto end_range(StringView closing) -> void
+        {
+            this->write(std::string(Config_::INDENT_BASE, ' ') + closing.to_string());
+        }
+
+        // Writes all the arguments after the last streamed one.
+        auto finish(Forest const& forest) -> void
+        {
+            this->write_entries(forest);
+            this->write("\n");
+        }
+
+    private:
+        Config_& config_;
+        Sink* sink_;
+        std::string prefix_;
+        std::string header_;
+        size_t threshold_;
+        size_t line_wrap_width_;
+
+        // The printing nodes of the arguments already built, and the name of the one
+        // being built.
+        Forest const* forest_;
+        StringView arg_name_;
+
+        // The number of arguments already written.
+        size_t n_written_;
+
+        size_t n_code_points_;
+        bool is_started_;
+        RangeStreamer* previous_;
+
+        static auto current() -> RangeStreamer*&
+        {
+            static thread_local auto streamer = static_cast<RangeStreamer*>(nullptr);
+            return streamer;
+        }
+
+        auto write(std::string const& text) -> void
+        {
+            this->n_code_points_ += count_utf8_code_point(text);
+            this->sink_->write(this->config_.transcode_output(text));
+        }
+
+        auto write_entries(Forest const& forest) -> void
+        {
+            for (; this->n_written_ < forest.size(); ++this->n_written_)
+            {
+                auto const& arg_name = std::get<0>(forest[this->n_written_]);
+                auto const& tree = std::get<1>(forest[this->n_written_]);
+
+                auto text =
+                    std::string(this->n_written_ > 0 ? ",\n" : "")
+                    + std::string(Config_::INDENT_BASE, ' ')
+                    + arg_name.to_string()
+                    + ": ";
+
+                auto const n_code_points = this->n_code_points_ + count_utf8_code_point(text);
+                if (n_code_points + tree.code_point_length() < this->line_wrap_width_)
+                {
+                    text += tree.print();
+                }
+                else
+                {
+                    text += tree.print(2, this->line_wrap_width_);
+                }
+
+                this->write(text);
+            }
+        }
+    };
+
+
+    // -------------------------------------------------- range format keywords
+
+    // If the range format string ends with `keyword`, returns the slicing preceding it.
+    inline auto split_range_fmt_keyword(
+        StringView range_fmt, StringView keyword
+    ) -> Optional<StringView>
+    {
+        if (
+            range_fmt.size() >= keyword.size()
+            && range_fmt.substr(range_fmt.size() - keyword.size()) == keyword
+        ) {
+            return range_fmt.substr(0, range_fmt.size() - keyword.size());
+        }
+
+        return {};
+    }
+
+
+    // -------------------------------------------------- bits formatting
+
+    // A range format string selecting one of the compact forms to print a sequence of
+    // bits, optionally preceded by a slicing, e.g.: "[10:20]rle".
+    struct BitsFormat
+    {
+        enum class Mode
+        {
+            bits,  // The bits digits, sixty four per row.
+            rle,   // The runs of equal bits, as "<bit>x<length>".
+            ones,  // The positions of the set bits.
+        };
+
+        Mode mode;
+        StringView slicing;
+
+        static auto build(StringView range_fmt) -> Optional<BitsFormat>
+        {
+            struct Suffix
+            {
+                char const* name;
+                Mode mode;
+            };
+
+            static Suffix const suffixes[] = {
+                {"bits", Mode::bits}, {"rle", Mode::rle}, {"ones", Mode::ones}
+            };
+
+            for (auto const& suffix : suffixes)
+            {
+                auto const mb_slicing = split_range_fmt_keyword(range_fmt, suffix.name);
+                if (mb_slicing)
+                {
+                    return BitsFormat{suffix.mode, *mb_slicing};
+                }
+            }
+
+            return {};
+        }
+    };
+
+    // Builds the printing node of a sequence of bits, pushed one at a time, in one of the
+    // BitsFormat forms. The number of digits, runs, or positions is bounded by the
+    // `max_range_elements` limit, and all of them by the `max_output_bytes` limit.
+    //
+    // If `is_msb_first`, the digits of the `bits` form are printed as a binary number: the
+    // last pushed bit first, preceded by "0b", and with the "..." of the bits left out,
+    // when truncated, right after the "0b".
+    class BitsRenderer
+    {
+    public:
+        BitsRenderer(BitsFormat::Mode mode, size_t max_elements, bool is_msb_first)
+            : mode_(mode)
+            , max_elements_(max_elements)
+            , is_msb_first_(is_msb_first)
+            , n_bits_(0)
+            , n_elements_(0)
+            , run_bit_(false)
+            , run_length_(0)
+        {}
+
+        // If no more bits should be pushed.
+        auto is_full() const -> bool
+        {
+            return this->n_elements_ == this->max_elements_ || OutputBudget::is_exhausted();
+        }
+
+        auto push(bool bit) -> void
+        {
+            switch (this->mode_)
+            {
+            case BitsFormat::Mode::bits:
+                this->row_ += bit ? '1' : '0';
+                ++this->n_elements_;
+                if (this->row_.size() == ROW_SIZE && !this->is_msb_first_)
+                {
+                    this->nodes_.push_back(PrintingNode(this->row_));
+                    this->row_.clear();
+                }
+                break;
+
+            case BitsFormat::Mode::rle:
+                if (this->run_length_ > 0 && bit != this->run_bit_)
+                {
+                    this->push_run();
+                }
+                this->run_bit_ = bit;
+                ++this->run_length_;
+                break;
+
+            case BitsFormat::Mode::ones:
+                if (bit)
+                {
+                    this->nodes_.push_back(PrintingNode(std::to_string(this->n_bits_)));
+                    ++this->n_elements_;
+                }
+                break;
+            }
+
+            ++this->n_bits_;
+        }
+
+        // Builds the node with all the pushed bits. If `is_truncated`, there were more bits
+        // that weren't pushed, and the current run, if any, is incomplete.
+        auto build(std::string const& opening, bool is_truncated) -> PrintingNode
+        {
+            if (this->mode_ == BitsFormat::Mode::bits && this->is_msb_first_)
+            {
+                this->push_msb_first_rows(is_truncated);
+                is_truncated = false;
+            }
+            else if (!this->row_.empty())
+            {
+                this->nodes_.push_back(PrintingNode(this->row_));
+            }
+
+            if (this->run_length_ > 0 && !is_truncated)
+            {
+                if (this->n_elements_ == this->max_elements_)
+                {
+                    is_truncated = true;
+                }
+                else
+                {
+                    this->push_run();
+                }
+            }
+
+            if (is_truncated)
+            {
+                this->nodes_.push_back(PrintingNode("..."));
+            }
+
+            auto const separator = this->mode_ == BitsFormat::Mode::bits ? " " : ", ";
+            return PrintingNode(opening, separator, "]", std::move(this->nodes_));
+        }
+
+    private:
+        constexpr static size_t ROW_SIZE = 64;
+
+        BitsFormat::Mode mode_;
+        size_t max_elements_;
+        bool is_msb_first_;
+        size_t n_bits_;
+        size_t n_elements_;
+        std::vector<PrintingNode> nodes_;
+
+        // The digits not yet pushed to a row node. If `is_msb_first_`, all of them.
+        std::string row_;
+
+        // The run being currently counted.
+        bool run_bit_;
+        size_t run_length_;
+
+        auto push_run() -> void
+        {
+            this->nodes_.push_back(
+                PrintingNode((this->run_bit_ ? "1x" : "0x") + std::to_string(this->run_length_))
+            );
+            ++this->n_elements_;
+            this->run_length_ = 0;
+        }
+
+        // Pushes the digits reversed, split in rows from the most significant one.
+        auto push_msb_first_rows(bool is_truncated) -> void
+        {
+            if (this->row_.empty() && !is_truncated)
+            {
+                return;
+            }
+
+            auto const digits = std::string(this->row_.rbegin(), this->row_.rend());
+            auto first_row = std::string(is_truncated ? "0b..." : "0b");
+            first_row.append(digits, 0, ROW_SIZE);
+            this->nodes_.push_back(PrintingNode(std::move(first_row)));
+            for (auto idx = ROW_SIZE; idx < digits.size(); idx += ROW_SIZE)
+            {
+                this->nodes_.push_back(PrintingNode(digits.substr(idx, ROW_SIZE)));
+            }
+        }
+    };
+
+    // A random access range over the bits of a std::bitset, from the bit 0 up, so that a
+    // bitset can be sliced and printed as a range of bools.
+    template <size_t N>
+    class BitsetRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = bool;
+            using difference_type = ptrdiff_t;
+            using pointer = void;
+            using reference = bool;
+
+            iterator() = default;
+
+            iterator(std::bitset<N> const* bitset, ptrdiff_t idx)
+                : bitset_(bitset)
+                , idx_(idx)
+            {}
+
+            auto operator*() const -> bool
+            {
+                return this->bitset_->test(static_cast<size_t>(this->idx_));
+            }
+
+            auto operator[](ptrdiff_t n) const -> bool
+            {
+                return *(*this + n);
+            }
+
+            auto operator++() -> iterator& {++this->idx_; return *this;}
+            auto operator--() -> iterator& {--this->idx_; return *this;}
+            auto operator++(int) -> iterator {auto old = *this; ++this->idx_; return old;}
+            auto operator--(int) -> iterator {auto old = *this; --this->idx_; return old;}
+            auto operator+=(ptrdiff_t n) -> iterator& {this->idx_ += n; return *this;}
+            auto operator-=(ptrdiff_t n) -> iterator& {this->idx_ -= n; return *this;}
+
+            friend auto operator+(iterator it, ptrdiff_t n) -> iterator {return it += n;}
+            friend auto operator+(ptrdiff_t n, iterator it) -> iterator {return it += n;}
+            friend auto operator-(iterator it, ptrdiff_t n) -> iterator {return it -= n;}
+
+            friend auto operator-(iterator const& lho, iterator const& rho) -> ptrdiff_t
+            {
+                return lho.idx_ - rho.idx_;
+            }
+
+            friend auto operator==(iterator const& lho, iterator const& rho) -> bool
+            {
+                return lho.idx_ == rho.idx_;
+            }
+
+            friend auto operator!=(iterator const& lho, iterator const& rho) -> bool
+            {
+                return lho.idx_ != rho.idx_;
+            }
+
+            friend auto operator<(iterator const& lho, iterator const& rho) -> bool
+            {
+                return lho.idx_ < rho.idx_;
+            }
+
+            friend auto operator>(iterator const& lho, iterator const& rho) -> bool
+            {
+                return lho.idx_ > rho.idx_;
+            }
+
+            friend auto operator<=(iterator const& lho, iterator const& rho) -> bool
+            {
+                return lho.idx_ <= rho.idx_;
+            }
+
+            friend auto operator>=(iterator const& lho, iterator const& rho) -> bool
+            {
+                return lho.idx_ >= rho.idx_;
+            }
+
+        private:
+            std::bitset<N> const* bitset_ = nullptr;
+            ptrdiff_t idx_ = 0;
+        };
+
+        explicit BitsetRange(std::bitset<N> const& bitset)
+            : bitset_(&bitset)
+        {}
+
+        auto begin() const -> iterator
+        {
+            return iterator(this->bitset_, 0);
+        }
+
+        auto end() const -> iterator
+        {
+            return iterator(this->bitset_, static_cast<ptrdiff_t>(N));
+        }
+
+        auto size() const -> size_t
+        {
+            return N;
+        }
+
+    private:
+        std::bitset<N> const* bitset_;
+    };
+
+    template <size_t N>
+    auto make_bitset_range(std::bitset<N> const& bitset) -> BitsetRange<N>
+    {
+        return BitsetRange<N>(bitset);
+    }
+
+
+    // -------------------------------------------------- integer digits
+
+    // The functions below write the digits of unsigned integers of any size. An integer is
+    // given by its sequence of 32 bits words, from the least to the most significant one.
+
+    // Splits `value` in its 32 bits words, returning how many were written to `words`.
+    // There must be room to `(sizeof(U) + 3) / 4` words.
+    template <typename U>
+    auto to_words(U value, uint32_t* words) -> size_t
+    {
+        auto n_words = size_t{0};
+        do
+        {
+            words[n_words++] = static_cast<uint32_t>(value & 0xFFFFFFFFu);
+
+            // Two shifts, since shifting by the whole width of U is undefined.
+            value = static_cast<U>((value >> 16) >> 16);
+        } while (value != 0);
+
+        return n_words;
+    }
+
+    // The eight binary digits of each byte value.
+    inline auto binary_byte_digits(unsigned char byte) -> char const*
+    {
+        struct Table
+        {
+            char digits[256][8];
+
+            Table()
+            {
+                for (auto value = 0; value < 256; ++value)
+                {
+                    for (auto i = 0; i < 8; ++i)
+                    {
+                        this->digits[value][i] = ((value >> (7 - i)) & 1) ? '1' : '0';
+                    }
+                }
+            }
+        };
+
+        static Table const table;
+        return table.digits[byte];
+    }
+
+    // Appends the binary digits to `out`, without the leading zeros. The zero words and
+    // bytes at the top are skipped at once, and then eight digits are copied from a table
+    // to each remaining byte.
+    inline auto append_binary_digits(uint32_t const* words, size_t n_words, std::string& out) -> void
+    {
+        while (n_words > 1 && words[n_words - 1] == 0)
+        {
+            --n_words;
+        }
+
+        auto is_leading = true;
+        for (auto w = n_words; w-- > 0;)
+        {
+            for (auto b = 4; b-- > 0;)
+            {
+                auto const byte = static_cast<unsigned char>((words[w] >> (8 * b)) & 0xFF);
+                if (is_leading && byte == 0 && (w > 0 || b > 0))
+                {
+                    continue;
+                }
+
+                auto const digits = binary_byte_digits(byte);
+                auto first = size_t{0};
+                if (is_leading)
+                {
+                    // Skip the leading zeros of the most significant byte, keeping at
+                    // least one digit.
+                    while (first < 7 && digits[first] == '0')
+                    {
+                        ++first;
+                    }
+                    is_leading = false;
+                }
+                out.append(digits + first, 8 - first);
+            }
+        }
+    }
+
+    // Appends the octal (`bits_per_digit` equal to 3) or hexadecimal (`bits_per_digit`
+    // equal to 4) digits to `out`, without the leading zeros.
+    inline auto append_pow2_digits(
+        uint32_t const* words, size_t n_words, size_t bits_per_digit, bool uppercase, std::string& out
+    ) -> void
+    {
+        auto const digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+        auto const n_digits = (32 * n_words + bits_per_digit - 1) / bits_per_digit;
+
+        auto is_leading = true;
+        for (auto d = n_digits; d-- > 0;)
+        {
+            auto digit = size_t{0};
+            for (auto i = bits_per_digit; i-- > 0;)
+            {
+                auto const bit = d * bits_per_digit + i;
+                digit <<= 1;
+                if (bit < 32 * n_words)
+                {
+                    digit |= (words[bit / 32] >> (bit % 32)) & 1;
+                }
+            }
+
+            if (is_leading && digit == 0 && d > 0)
+            {
+                continue;
+            }
+            is_leading = false;
+            out += digits[digit];
+        }
+    }
+
+    // Appends the decimal digits to `out`, without the leading zeros. The `words` are
+    // overwritten.
+    inline auto append_decimal_digits(uint32_t* words, size_t n_words, std::string& out) -> void
+    {
+        // Divide repeatedly by 10^9, so that each remainder gives nine digits.
+        constexpr auto chunk_base = uint64_t{1000000000};
+        auto chunks = std::vector<uint32_t>{};
+        do
+        {
+            auto remainder = uint64_t{0};
+            for (auto i = n_words; i-- > 0;)
+            {
+                auto const current = (remainder << 32) | words[i];
+                words[i] = static_cast<uint32_t>(current / chunk_base);
+                remainder = current % chunk_base;
+            }
+            chunks.push_back(static_cast<uint32_t>(remainder));
+
+            while (n_words > 0 && words[n_words - 1] == 0)
+            {
+                --n_words;
+            }
+        } while (n_words > 0);
+
+        out += std::to_string(chunks.back());
+        for (auto i = chunks.size() - 1; i-- > 0;)
+        {
+            auto const chunk = std::to_string(chunks[i]);
+            out.append(9 - chunk.size(), '0');
+            out += chunk;
+        }
+    }
+
+    // Appends the digits of an unsigned integer in the base set at `ostrm`, with the base
+    // prefix if `std::showbase` is set. Returns false if `ostrm` is set to print a non
+    // integer type.
+    inline auto append_integer_digits(
+        uint32_t* words, size_t n_words, std::ostringstream& ostrm, std::string& out
+    ) -> bool
+    {
+        auto const is_showbase = (ostrm.flags() & std::ios_base::showbase) != 0;
+        auto const is_uppercase = (ostrm.flags() & std::ios_base::uppercase) != 0;
+
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+            if (is_showbase)
+            {
+                out += getOstreamTypeMode(ostrm) == OstreamTypeMode::BINARY ? "0B" : "0b";
+            }
+            append_binary_digits(words, n_words, out);
+            return true;
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::non_binary_integer:
+            if ((ostrm.flags() & std::ios_base::basefield) == std::ios_base::hex)
+            {
+                if (is_showbase)
+                {
+                    out += is_uppercase ? "0X" : "0x";
+                }
+                append_pow2_digits(words, n_words, 4, is_uppercase, out);
+            }
+            else if ((ostrm.flags() & std::ios_base::basefield) == std::ios_base::oct)
+            {
+                // As std::ostream does, the zero value has no octal prefix.
+                auto const is_zero = n_words == 1 && words[0] == 0;
+                if (is_showbase && !is_zero)
+                {
+                    out += "0";
+                }
+                append_pow2_digits(words, n_words, 3, false, out);
+            }
+            else
+            {
+                append_decimal_digits(words, n_words, out);
+            }
+            return true;
+
+        case OstreamTypeMode::character:
+        case OstreamTypeMode::debug:
+        case OstreamTypeMode::string:
+        default:
+            return false;
+        }
+    }
+
+
+    // -------------------------------------------------- make_printing_branch functions
+
+    template <typename T>
+    auto do_print_integral(
+        T const&, Config_ const&, std::ostringstream&
+    ) -> typename std::enable_if<!std::is_integral<remove_cvref_t<T>>::value, PrintingNode>::type
+    {
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
+    }
+
+    template <typename T>
+    auto do_print_integral(
+        T const& value, Config_ const& config, std::ostringstream& ostrm
+    ) -> typename std::enable_if<std::is_integral<remove_cvref_t<T>>::value, PrintingNode>::type
+    {
+        using U =
+            typename std::conditional<
+                std::is_same<remove_cvref_t<T>, bool>::value,
+                std::common_type<unsigned char>,
+                std::make_unsigned<remove_cvref_t<T>>
+            >::type::type;
+
+        // The whole number is inserted at once, so that the ostream width applies to all
+        // of it.
+        auto print_binary =
+            [&](bool uppercase_base)
+            {
+                auto result = std::string{};
+                if (ostrm.flags() & std::ios_base::showbase)
+                {
+                    result = uppercase_base ? "0B" : "0b";
+                }
+
+                uint32_t words[(sizeof(U) + 3) / 4];
+                auto const n_words = to_words(static_cast<U>(value), words);
+                append_binary_digits(words, n_words, result);
+
+                ostrm << result;
+            };
+
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::character:
+            if (std::is_same<remove_cvref_t<T>, bool>::value)
+            {
+                return PrintingNode("*Error* in formatting string");
+            }
+            else if (value > static_cast<T>(127))
+            {
+                return PrintingNode("*Error* Integral value outside the range of the char type");
+            }
+            else
+            {
+                return do_print_char(static_cast<char>(value), config, ostrm);
+            }
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::non_binary_integer:
+            ostrm << value;
+            return PrintingNode(ostrm.str());
+
+        case OstreamTypeMode::binary:
+            print_binary(false);
+            return PrintingNode(ostrm.str());
+
+        case OstreamTypeMode::BINARY:
+            print_binary(true);
+            return PrintingNode(ostrm.str());
+
+        case OstreamTypeMode::debug:
+        case OstreamTypeMode::string:
+        default:
+            return PrintingNode("*Error* in formatting string");
+        }
+    }
+
+    // Print any class that overloads operator<<(std::ostream&, T)
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) ->
+        typename std::enable_if<
+            is_streamable<T>::value
+            && !is_stl_formattable<T>::value
+            && !is_fmt_formattable<T>::value
+            && !bypass_baseline_printing<T>::value
+            , PrintingNode
+        >::type
+    {
+        if (config.force_variant_strategy() && is_variant<remove_ref_t< T>>::value)
+        {
+            return do_print_variant(std::forward<T>(value), fmt, config);
+        }
+
+        if (is_bitset<remove_cvref_t<T>>::value)
+        {
+            auto const mb_bits_format = BitsFormat::build(fmt);
+            if (mb_bits_format)
+            {
+                return do_print_bitset_bits(value, *mb_bits_format, config);
+            }
+        }
+
+        auto mb_ostrm = build_ostream(fmt);
+        if (!mb_ostrm)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        if (std::is_integral<remove_cvref_t<T>>::value)
+        {
+            return do_print_integral(value, config, *mb_ostrm);
+        }
+        else if (is_bitset<remove_cvref_t<T>>::value)
+        {
+            return do_print_bitset(value, *mb_ostrm);
+        }
+        else
+        {
+            *mb_ostrm << value;
+            return PrintingNode(mb_ostrm->str());
+        }
+    }
+
+    template <typename T>
+    auto do_print_bitset(
+        T const&, std::ostringstream&
+    ) -> typename std::enable_if<!is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type
+    {
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
+    }
+
+    template <typename T>
+    auto do_print_bitset_bits(
+        T const&, BitsFormat const&, Config_ const&
+    ) -> typename std::enable_if<!is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type
+    {
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
+    }
+
+    // The bits are visited from the bit 0 up, as done when indexing the bitset, and sliced
+    // the same as a range of bools. The `bits` form prints the visited bits reversed, as
+    // a binary number with the most significant bit first, like the bitset operator<<.
+    template <typename T>
+    auto do_print_bitset_bits(
+        T const& value, BitsFormat const& format, Config_ const& config
+    ) -> typename std::enable_if<is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type
+    {
+        return print_bits_range(make_bitset_range(value), format, true, config);
+    }
+
+    // Without a type specifier all the bits are printed, as done by the bitset operator<<,
+    // otherwise the bitset is printed as the unsigned integer having those bits.
+    template <typename T>
+    auto do_print_bitset(
+        T const& value, std::ostringstream& ostrm
+    ) -> typename std::enable_if<is_bitset<remove_cvref_t<T>>::value, PrintingNode>::type
+    {
+        if (getOstreamTypeMode(ostrm) == OstreamTypeMode::none)
+        {
+            ostrm << value;
+            return PrintingNode(ostrm.str());
+        }
+
+        auto words = std::vector<uint32_t>(value.size() / 32 + 1, 0);
+        for (auto i = size_t{0}; i < value.size(); ++i)
+        {
+            if (value.test(i))
+            {
+                words[i / 32] |= uint32_t{1} << (i % 32);
+            }
+        }
+
+        auto result = std::string{};
+        if (!append_integer_digits(words.data(), words.size(), ostrm, result))
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        ostrm << result;
+        return PrintingNode(ostrm.str());
+    }
+
+    // Print 128 bits integers
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const&
+    ) -> typename std::enable_if<
+        is_int128<remove_ref_t<T>>::value && !is_baseline_printable<T>::value, PrintingNode
+    >::type
+    {
+      #if defined(__SIZEOF_INT128__)
+        auto mb_ostrm = build_ostream(fmt);
+        if (!mb_ostrm)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        auto const is_signed = std::is_same<remove_cvref_t<T>, int128_t>::value;
+        auto const is_negative = is_signed && (static_cast<uint128_t>(value) >> 127) != 0;
+        auto const magnitude =
+            is_negative ? uint128_t{0} - static_cast<uint128_t>(value) : static_cast<uint128_t>(value);
+
+        // As std::ostream does, the sign is printed only to decimal numbers.
+        auto const is_decimal =
+            getOstreamTypeMode(*mb_ostrm) != OstreamTypeMode::binary
+            && getOstreamTypeMode(*mb_ostrm) != OstreamTypeMode::BINARY
+            && (mb_ostrm->flags() & std::ios_base::basefield) != std::ios_base::hex
+            && (mb_ostrm->flags() & std::ios_base::basefield) != std::ios_base::oct;
+
+        uint32_t words[4];
+        auto const n_words = to_words(is_decimal ? magnitude : static_cast<uint128_t>(value), words);
+
+        auto result = std::string{};
+        if (is_decimal && is_negative)
+        {
+            result += '-';
+        }
+        else if (is_decimal && is_signed && (mb_ostrm->flags() & std::ios_base::showpos))
+        {
+            result += '+';
+        }
+
+        if (!append_integer_digits(words, n_words, *mb_ostrm, result))
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        *mb_ostrm << result;
+        return PrintingNode(mb_ostrm->str());
+      #else
+        (void) value;
+        (void) fmt;
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
+      #endif
+    }
+
+  #if defined(ICECREAM_STL_FORMAT_RANGES)
+
+    // This class will wrap a range T, signaling it as "hijacked" to avoid a circular
+    // inheritance in the `std::formatter` specialization below.
+    template <std::ranges::forward_range T>
+    struct HijackTag
+    {
+        T const& value;
+
+        HijackTag(T const& t)
+            : value(t)
+        {}
+
+        auto begin() const
+        {
+            return std::begin(value);
+        }
+
+        auto end() const
+        {
+            return std::end(value);
+        }
+    };
+
+}} namespace std {
+
+    // Starting from C++23 the formatting library has a concept specialization to print
+    // any *range*. Because of this any *range* that Icecream-cpp could try to print would
+    // be handled by the STL's Formatting function overload of the *baseline printable*
+    // strategy.
+    //
     // We would like that the generic range case would continue being handled by the
     // *range types* strategy, but other than that, any `formatter` struct further
     // specializing a range should take precedence and the *baseline printable* strategy
@@ -3398,1974 +6624,5450 @@ namespace detail {
     // strategy should be used, but if there exist a `std::formatter<std::vector<T>>`
     // specialization, the *baseline printable* strategy should be used instead.
     //
-    // Here we will hijack any instantiation of the generic range specialization, inherit
-    // from the hijacked STL version so that we have the required methods implemented, and
-    // insert an `Hijacked` typedef to signalize that this specialization was used, so
-    // that Icecream-cpp knows that the type `T` is a range, and is free to delegate the
-    // printing of `T` to the ranges strategy.
-    template< ranges::forward_range T>
-    requires (format_kind<remove_cvref_t<T>> != range_format::disabled) &&
-        formattable<ranges::range_reference_t<T>, char>
-        && (!::icecream::detail::is_instantiation<::icecream::detail::HijackTag, remove_cvref_t<T>>::value)
-        && (!::icecream::detail::is_c_string<T>::value)
-        && (!::icecream::detail::is_std_string<remove_cvref_t<T>>::value)
-        && (!::icecream::detail::is_string_view<remove_cvref_t<T>>::value)
-        && (!std::is_array<remove_cvref_t<T>>::value)
-    struct formatter<T, char>
-        : public formatter<::icecream::detail::HijackTag<remove_cvref_t<T>>, char>
+    // Here we will hijack any instantiation of the generic range specialization, inherit
+    // from the hijacked STL version so that we have the required methods implemented, and
+    // insert an `Hijacked` typedef to signalize that this specialization was used, so
+    // that Icecream-cpp knows that the type `T` is a range, and is free to delegate the
+    // printing of `T` to the ranges strategy.
+    template< ranges::forward_range T>
+    requires (format_kind<remove_cvref_t<T>> != range_format::disabled) &&
+        formattable<ranges::range_reference_t<T>, char>
+        && (!::icecream::detail::is_instantiation<::icecream::detail::HijackTag, remove_cvref_t<T>>::value)
+        && (!::icecream::detail::is_c_string<T>::value)
+        && (!::icecream::detail::is_std_string<remove_cvref_t<T>>::value)
+        && (!::icecream::detail::is_string_view<remove_cvref_t<T>>::value)
+        && (!std::is_array<remove_cvref_t<T>>::value)
+    struct formatter<T, char>
+        : public formatter<::icecream::detail::HijackTag<remove_cvref_t<T>>, char>
+    {
+        using Hijacked = int;
+    };
+
+} namespace icecream { namespace detail {
+
+  #endif  // defined(ICECREAM_STL_FORMAT_RANGES)
+
+  #if defined(ICECREAM_STL_FORMAT)
+    template <typename T, typename = void>
+    struct has_hijacked_tag : std::false_type {};
+
+    template <typename T>
+    struct has_hijacked_tag<
+        T,
+        typename std::enable_if<
+            !std::is_void<typename std::formatter<remove_cvref_t<T>>::Hijacked>::value
+        >::type
+    > : std::true_type {};
+
+    // Print any class that specializes std::formatter<T, char>
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) ->
+        typename std::enable_if<
+            is_stl_formattable<T>::value
+            && !is_fmt_formattable<T>::value
+            && !bypass_baseline_printing<T>::value
+            , PrintingNode
+        >::type
+    {
+        if (config.force_range_strategy() && has_hijacked_tag<T>::value)
+        {
+            return do_print_range(std::forward<T>(value), fmt, config);
+        }
+        else if (config.force_tuple_strategy() && is_tuple<remove_cvref_t<T>>::value)
+        {
+            return do_print_tuple(std::forward<T>(value), fmt, config);
+        }
+        else if (config.force_variant_strategy() && is_variant<remove_ref_t< T>>::value)
+        {
+            return do_print_variant(std::forward<T>(value), fmt, config);
+        }
+
+        try
+        {
+            return PrintingNode(
+                std::vformat("{:" + fmt.to_string() + "}", std::make_format_args(value))
+            );
+        }
+        catch (std::format_error const&)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+    }
+  #endif // defined(ICECREAM_STL_FORMAT)
+
+  #if defined(ICECREAM_FMT_ENABLED)
+    // Print any class that specializes fmt::formatter<T, char>
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) ->
+        typename std::enable_if<
+            is_fmt_formattable<T>::value
+            && !bypass_baseline_printing<T>::value
+            , PrintingNode
+        >::type
+    {
+        if (config.force_range_strategy() && is_range<remove_cvref_t<T>>::value)
+        {
+            return do_print_range(std::forward<T>(value), fmt, config);
+        }
+        else if (config.force_tuple_strategy() && is_tuple<remove_cvref_t<T>>::value)
+        {
+            return do_print_tuple(std::forward<T>(value), fmt, config);
+        }
+        else if (config.force_variant_strategy() && is_variant<remove_cvref_t< T>>::value)
+        {
+            return do_print_variant(std::forward<T>(value), fmt, config);
+        }
+
+        return PrintingNode(
+            fmt::vformat("{:" + fmt.to_string() + "}", fmt::make_format_args(value))
+        );
+    }
+  #endif
+
+    // Prints all characters encoded in "execution encoding"
+    template <char Quote>
+    auto print_text(
+        StringView code_units, Config_ const&, std::ostringstream& ostrm
+    ) -> void
+    {
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::character:
+        case OstreamTypeMode::string:
+            ostrm << code_units.to_string();
+            break;
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::debug:
+            for (auto cu : code_units)
+            {
+                switch (cu)
+                {
+                case '\a':
+                    ostrm << "\\a";
+                    break;
+                case '\b':
+                    ostrm << "\\b";
+                    break;
+                case '\t':
+                    ostrm << "\\t";
+                    break;
+                case '\n':
+                    ostrm << "\\n";
+                    break;
+                case '\v':
+                    ostrm << "\\v";
+                    break;
+                case '\f':
+                    ostrm << "\\f";
+                    break;
+                case '\r':
+                    ostrm << "\\r";
+                    break;
+                case '\0':
+                    ostrm << "\\u{0}";
+                    break;
+                case Quote:
+                    ostrm << "\\" << Quote;
+                    break;
+                default:
+                    ostrm << cu;
+                }
+            }
+            break;
+
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+        case OstreamTypeMode::non_binary_integer:
+        default:
+            ICECREAM_UNREACHABLE;
+
+        }
+    }
+
+    // Prints char32_t characters
+    template <char quote>
+    auto print_text(
+        U32StringView code_units, Config_ const& config, std::ostringstream& ostrm
+    ) -> void
+    {
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::character:
+        case OstreamTypeMode::string:
+            ostrm << config.transcode_unicode(code_units);
+            break;
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::debug:
+            for (auto cu : code_units)
+            {
+                if (is_code_point_valid(cu))
+                {
+                    print_text<quote>(
+                        config.transcode_unicode(U32StringView(&cu, 1)), config, ostrm
+                    );
+                }
+                else
+                {
+                    ostrm << "\\x{"
+                          << std::hex
+                          << std::nouppercase
+                          << std::char_traits<char32_t>::to_int_type(cu)
+                          << "}";
+                }
+            }
+            break;
+
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+        case OstreamTypeMode::non_binary_integer:
+        default:
+            ICECREAM_UNREACHABLE;
+        }
+    }
+
+    // Prints char8_t and char16_t characters
+    template <char quote, typename CharT>
+    auto print_text(
+        BasicStringView<CharT> code_units, Config_ const& config, std::ostringstream& ostrm
+    ) -> void
+    {
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::character:
+        case OstreamTypeMode::string:
+            ostrm << config.transcode_unicode(to_utf32_u32string(code_units));
+            break;
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::debug:
+            while (!code_units.empty())
+            {
+                auto result = Variant<char32_t, CharT>{};
+                std::tie(code_units, result) = to_codepoint(code_units);
+
+                if (result.index() == 0)
+                {
+                    print_text<quote>(
+                        U32StringView(&get<char32_t>(result), 1), config, ostrm
+                    );
+                }
+                else
+                {
+                    ostrm << "\\x{"
+                          << std::hex
+                          << std::nouppercase
+                          << std::char_traits<CharT>::to_int_type(get<CharT>(result))
+                          << "}";
+                }
+            }
+            break;
+
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+        case OstreamTypeMode::non_binary_integer:
+        default:
+            ICECREAM_UNREACHABLE;
+        }
+    }
+
+    // Prints wchar_t characters
+    template <char quote>
+    auto print_text(
+        WStringView code_units, Config_ const& config, std::ostringstream& ostrm
+    ) -> void
+    {
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::character:
+        case OstreamTypeMode::string:
+            ostrm << config.transcode_wide_string(code_units);
+            break;
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::debug:
+            print_text<quote>(config.transcode_wide_string(code_units), config, ostrm);
+            break;
+
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+        case OstreamTypeMode::non_binary_integer:
+        default:
+            ICECREAM_UNREACHABLE;
+        }
+    }
+
+
+    // If `cu` is a UTF-8 continuation byte or a UTF-16 low surrogate, i.e., a code unit
+    // that can't be the first one of a character.
+    template <typename CharT>
+    auto is_trailing_code_unit(
+        CharT cu
+    ) -> typename std::enable_if<sizeof(CharT) == 1, bool>::type
+    {
+        return (static_cast<unsigned char>(cu) & 0xC0) == 0x80;
+    }
+
+    template <typename CharT>
+    auto is_trailing_code_unit(
+        CharT cu
+    ) -> typename std::enable_if<sizeof(CharT) == 2, bool>::type
+    {
+        auto const value = static_cast<uint_least16_t>(cu);
+        return value >= 0xDC00 && value <= 0xDFFF;
+    }
+
+    template <typename CharT>
+    auto is_trailing_code_unit(
+        CharT
+    ) -> typename std::enable_if<(sizeof(CharT) > 2), bool>::type
+    {
+        return false;
+    }
+
+    // Truncates `str` to at most `max_length` code units, without splitting a multi code
+    // unit character. Returns the number of removed code units.
+    template <typename CharT>
+    auto truncate_string(BasicStringView<CharT>& str, size_t max_length) -> size_t
+    {
+        if (str.size() <= max_length)
+        {
+            return 0;
+        }
+
+        auto length = max_length;
+        while (length > 0 && is_trailing_code_unit(str[length]))
+        {
+            --length;
+        }
+
+        auto const n_removed = str.size() - length;
+        str = str.substr(0, length);
+        return n_removed;
+    }
+
+    // Builds the leaf node of the `text` printing a string or character `value`, that is
+    // `suffix` appended. While a JsonPrinting is active, the raw `value` is also kept.
+    template <typename CharT>
+    auto make_text_node(
+        std::string const& text,
+        BasicStringView<CharT> value,
+        std::string const& suffix,
+        Config_ const& config
+    ) -> PrintingNode
+    {
+        auto node = PrintingNode(text);
+        if (JsonPrinting::is_active())
+        {
+            auto ostrm = std::ostringstream{};
+            setOstreamTypeMode(ostrm, OstreamTypeMode::string);
+            print_text<'"'>(value, config, ostrm);
+            node.set_raw_text(ostrm.str() + suffix);
+        }
+        return node;
+    }
+
+    template <typename CharT>
+    auto do_print_string(
+        BasicStringView<CharT> value, Config_ const& config, std::ostringstream& ostrm
+    ) -> PrintingNode
+    {
+        // Both limits are applied in code units of CharT, before transcoding. The output
+        // budget counts bytes, so a wide string may overrun it by its encoding growth.
+        auto const max_length = config.max_string_length();
+        auto const n_removed =
+            truncate_string(
+                value,
+                max_length < OutputBudget::remaining() ? max_length : OutputBudget::remaining()
+            );
+        auto const suffix =
+            n_removed > 0 ? "...<" + std::to_string(n_removed) + " more>" : std::string{};
+
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::string:
+            print_text<'"'>(value, config, ostrm);
+            ostrm << suffix;
+            return make_text_node(ostrm.str(), value, suffix, config);
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::debug:
+            ostrm << '"';
+            print_text<'"'>(value, config, ostrm);
+            ostrm << '"' << suffix;
+            return make_text_node(ostrm.str(), value, suffix, config);
+
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+        case OstreamTypeMode::character:
+        case OstreamTypeMode::non_binary_integer:
+        default:
+            return PrintingNode("*Error* in formatting string");
+        }
+    }
+
+    // Print C string
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<is_c_string<remove_ref_t<T>>::value, PrintingNode>::type
+    {
+        using CharT =
+            remove_cvref_t<
+                typename std::remove_pointer<
+                    typename std::decay<T>::type
+                >::type
+            >;
+
+        auto mb_ostrm = build_ostream(fmt);
+        if (!mb_ostrm)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        // If config.decay_char_array() is not true, any character array with a known size
+        // should be printed as a range
+        if (is_bounded_array<remove_ref_t<T>>::value && !config.decay_char_array())
+        {
+            return do_print_range(std::forward<T>(value), fmt, config);
+        }
+
+        if (config.show_c_string())
+        {
+            return do_print_string<CharT>(value, config, *mb_ostrm);
+        }
+
+        *mb_ostrm << reinterpret_cast<void const*>(value);
+        return PrintingNode(mb_ostrm->str());
+    }
+
+    // Print std::string and std::string_view
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) ->
+        typename std::enable_if<
+            is_std_string<remove_ref_t<T>>::value || is_string_view<remove_ref_t<T>>::value,
+            PrintingNode
+        >::type
+    {
+        using CharT = typename remove_ref_t<T>::value_type;
+
+        if (fmt == "hash")
+        {
+            return make_string_hash_node(value.data(), value.size());
+        }
+
+        auto mb_ostrm = build_ostream(fmt);
+        if (!mb_ostrm)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        return do_print_string<CharT>(value, config, *mb_ostrm);
+    }
+
+    template <typename T>
+    auto do_print_char(T value, Config_ const& config, std::ostringstream& ostrm) -> PrintingNode
+    {
+        using CharT = remove_cvref_t<T>;
+        auto const code_units = BasicStringView<CharT>(&value, 1);
+
+        switch (getOstreamTypeMode(ostrm))
+        {
+        case OstreamTypeMode::character:
+            print_text<'\''>(code_units, config, ostrm);
+            return make_text_node(ostrm.str(), code_units, "", config);
+
+        case OstreamTypeMode::none:
+        case OstreamTypeMode::debug:
+            ostrm << '\'';
+            print_text<'\''>(code_units, config, ostrm);
+            ostrm << '\'';
+            return make_text_node(ostrm.str(), code_units, "", config);
+
+        case OstreamTypeMode::non_binary_integer:
+        case OstreamTypeMode::binary:
+        case OstreamTypeMode::BINARY:
+            return do_print_integral(std::char_traits<CharT>::to_int_type(value), config, ostrm);
+
+        case OstreamTypeMode::string:
+        default:
+            return PrintingNode("*Error* in formatting string");
+        }
+    }
+
+    // Print character
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<
+            is_character<remove_ref_t<T>>::value, PrintingNode
+        >::type
+    {
+        auto mb_ostrm = build_ostream(fmt);
+        if (!mb_ostrm)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        return do_print_char(value, config, *mb_ostrm);
+    }
+
+    // Print signed and unsigned char
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const&
+    ) -> typename std::enable_if<is_xsig_char<remove_ref_t<T>>::value, PrintingNode>::type
+    {
+        using T0 =
+            typename std::conditional<
+                std::is_signed<remove_ref_t<T>>::value, int, unsigned int
+            >::type;
+
+        auto mb_ostrm = build_ostream(fmt);
+        if (!mb_ostrm)
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        *mb_ostrm << static_cast<T0>(value);
+        return PrintingNode(mb_ostrm->str());
+    }
+
+    // Print smart pointers without an operator<<(ostream&) overload.
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<
+        // On C++20 unique_ptr will have a << overload.
+        is_unstreamable_ptr<remove_ref_t<T>>::value && !is_baseline_printable<T>::value,
+        PrintingNode
+    >::type
+    {
+        return make_printing_branch(
+            reinterpret_cast<void const*>(value.get()), fmt, config
+        );
+    }
+
+    // Print weak pointer classes
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<is_weak_ptr<remove_ref_t<T>>::value, PrintingNode>::type
+    {
+        return value.expired() ?
+            PrintingNode("expired") : make_printing_branch(value.lock(), fmt, config);
+    }
+
+  #if defined(ICECREAM_OPTIONAL_HEADER)
+    // Print std::optional<> classes
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<
+        is_optional<remove_ref_t<T>>::value && !is_baseline_printable<T>::value,
+        PrintingNode
+    >::type
+    {
+        auto container_fmt = StringView{};
+        auto element_fmt = StringView{};
+
+        auto const cut_idx = fmt.find(":");
+        if (cut_idx != StringView::npos)
+        {
+            auto const fmt_parts = split(fmt, std::vector<size_t>{cut_idx});
+            container_fmt = fmt_parts[0];
+            element_fmt = fmt_parts[1];
+        }
+        else
+        {
+            container_fmt = fmt;
+        }
+
+        // std::optional hasn't any container formatting string
+        if (!container_fmt.empty())
+        {
+            return PrintingNode("*Error* in formatting string");
+        }
+
+        return value.has_value() ?
+            make_printing_branch(*value, element_fmt, config) : PrintingNode("nullopt");
+    }
+  #endif
+
+    template <typename Variant>
+    struct Visitor
+    {
+        Visitor(Variant const& variant, StringView fmt, Config_ const& config)
+            : variant_(variant)
+            , elements_fmt(
+                [&]() -> std::vector<StringView>
+                {
+                    if (fmt.empty())
+                    {
+                        // No element specifications is equivalent to all them having an empty string
+                        return std::vector<StringView>(variant_size<Variant>::value, StringView{});
+                    }
+
+                    auto const sep = fmt[0];
+                    fmt.remove_prefix(1);
+                    return split(fmt, sep);
+                }()
+            )
+            , config_(config)
+        {}
+
+        template <typename T>
+        auto operator()(T const& arg) -> PrintingNode
+        {
+            if (this->elements_fmt.size() != variant_size<Variant>::value)
+            {
+                return PrintingNode("*Error* in formatting string");
+            }
+
+            auto const fmt = this->elements_fmt.at(this->variant_.index());
+            return make_printing_branch(arg, fmt, this->config_);
+        }
+
+        Variant const& variant_;
+        std::vector<StringView> elements_fmt;
+        Config_ const& config_;
+    };
+
+    template <typename T>
+    auto do_print_variant(
+        T&&, StringView, Config_ const&
+    ) -> typename std::enable_if<!is_variant<remove_ref_t<T>>::value, PrintingNode>::type
+    {
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
+    }
+
+    template <typename T>
+    auto do_print_variant(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<is_variant<remove_ref_t<T>>::value, PrintingNode>::type
+    {
+        return visit(Visitor<remove_cvref_t<T>>(value, fmt, config), value);
+    }
+
+    // Print *::variant<Ts...> classes
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<
+        is_variant<remove_ref_t<T>>::value && !is_baseline_printable<T>::value,
+        PrintingNode
+    >::type
+    {
+        return do_print_variant(std::forward<T>(value), fmt, config);
+    }
+
+    template <size_t... N, typename T>
+    inline auto tuple_traverser(
+        int_sequence<N...>,
+        T const& t,
+        std::vector<StringView> const& fmt,
+        Config_ const& config
+    ) -> std::vector<PrintingNode>
+    {
+        auto result = std::vector<PrintingNode>{};
+        auto is_truncated = false;
+
+        // After the output budget is exhausted, the remaining elements are elided.
+        (void) std::initializer_list<int>{
+            (
+                (is_truncated = is_truncated || OutputBudget::is_exhausted())
+                    ? (void) 0
+                    : result.push_back(
+                        make_printing_branch(std::get<N>(t), fmt[N], config)
+                    ),
+                0
+            )...
+        };
+
+        if (is_truncated)
+        {
+            result.push_back(PrintingNode("..."));
+        }
+
+        return result;
+    }
+
+    template <typename T>
+    auto do_print_tuple(
+        T&&, StringView, Config_ const&
+    ) ->
+        typename std::enable_if<
+            !is_tuple<remove_cvref_t<T>>::value
+            , PrintingNode
+        >::type
+    {
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
+    }
+
+    template <typename T>
+    auto do_print_tuple(
+        T&& value, StringView fmt, Config_ const& config
+    ) ->
+        typename std::enable_if<
+            is_tuple<remove_cvref_t<T>>::value
+            , PrintingNode
+        >::type
+    {
+        auto const tuple_size = std::tuple_size<remove_cvref_t<T>>::value;
+
+        auto opening = std::string{"("};
+        auto separator = std::string{", "};
+        auto closing = std::string{")"};
+
+        if (!fmt.empty() && fmt[0] == 'n')
+        {
+            opening = "";
+            separator = ", ";
+            closing = "";
+            fmt.remove_prefix(1);
+        }
+        else if (!fmt.empty() && fmt[0] == 'm')
+        {
+            if (tuple_size != 2)
+            {
+                return PrintingNode(
+                    "<*Error*: the `m` specifier is only valid for pairs or 2-tuples>"
+                );
+            }
+            opening = "";
+            separator = ": ";
+            closing = "";
+            fmt.remove_prefix(1);
+        }
+
+        auto const elements_fmt =
+            [&]() -> std::vector<StringView>
+            {
+                if (fmt.empty())
+                {
+                    // No element specifications is equivalent to all them having an empty string
+                    return std::vector<StringView>(tuple_size, StringView{});
+                }
+
+                auto const sep = fmt[0];
+                fmt.remove_prefix(1);
+                return split(fmt, sep);
+            }();
+
+        if (elements_fmt.size() != tuple_size)
+        {
+            return PrintingNode(
+                "<*Error*: expected "
+                + std::to_string(tuple_size)
+                + " element formatting specifiers>"
+            );
+        }
+
+        NestingLevel const nesting_level;
+        if (NestingLevel::current() > config.max_nesting_depth())
+        {
+            return PrintingNode(opening + "..." + closing);
+        }
+
+        return PrintingNode(
+            opening,
+            separator,
+            closing,
+            tuple_traverser(
+                make_int_sequence<tuple_size>(),
+                value,
+                elements_fmt,
+                config
+            )
+        );
+    }
+
+    // Print tuple like classes
+    template <typename T>
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<
+        is_tuple<remove_cvref_t<T>>::value && !is_baseline_printable<T>::value,
+        PrintingNode
+    >::type
+    {
+        return do_print_tuple(std::forward<T>(value), fmt, config);
+    }
+
+
+    // -------------------------------------------------- Range classes
+
+    // Direct representation of a slicing string.
+    struct Slice
+    {
+        Optional<ptrdiff_t> start;
+        Optional<ptrdiff_t> stop;
+        Optional<ptrdiff_t> step;
+
+        // Receives a slicing string, like "[:-2:2]" and returns an instance of `Slice`
+        // class that represents it. If the string is an invalid slicing, returns nothing.
+        static auto build(StringView fmt) -> Optional<Slice>
+        {
+            if (fmt.empty())
+            {
+                return Slice{{}, {}, {}};
+            }
+
+            // All iterable slicings must start with '[' and finish with ']'
+            if (fmt.front() != '[' || fmt.back() != ']')
+            {
+                return {};
+            }
+
+            // Remove the opening '[' and the closing ']'
+            fmt.remove_prefix(1);
+            fmt.remove_suffix(1);
+
+            // An empty '[]' slicing is invalid
+            if (fmt.empty())
+            {
+                return {};
+            }
+
+            auto indexes = std::vector<Optional<ptrdiff_t>>{};
+            for (auto idx_string : split(fmt, ':'))
+            {
+                idx_string.trim();
+
+                if (idx_string.empty())
+                {
+                    indexes.push_back({});
+                    continue;
+                }
+
+                auto end = static_cast<char*>(nullptr);
+                auto const null_terminated = idx_string.to_string();
+                auto const lnum = strtol(null_terminated.data(), &end, 10);
+                if (
+                    // if idx_string in its whole isn't a number
+                    end != (null_terminated.data() + null_terminated.size())
+
+                    // or if there is an overflow on long int
+                    || (
+                        (
+                         lnum == std::numeric_limits<long>::max()
+                         || lnum == std::numeric_limits<long>::lowest()
+                        )
+                        && errno == ERANGE
+                    )
+
+                    // or if there is an overflow to convert from long to ptrdiff
+                    || (
+                        lnum > std::numeric_limits<ptrdiff_t>::max()
+                        || lnum < std::numeric_limits<ptrdiff_t>::lowest()
+                    )
+                ) {
+                    return {};
+                }
+
+                indexes.push_back(lnum);
+            }
+
+            // If indexing an element ("[3]") instead of a proper slicing.
+            if (indexes.size() == 1 && indexes[0])
+            {
+                // The last element, "[-1]", must be sliced up to the range end
+                auto const idx = *indexes[0];
+                return Slice{idx, idx == -1 ? Optional<ptrdiff_t>{} : Optional<ptrdiff_t>{idx+1}, {}};
+            }
+
+            while (indexes.size() < 3)
+            {
+                indexes.push_back({});
+            }
+
+            if (indexes.size() != 3) return {};
+
+            return Slice{indexes[0], indexes[1], indexes[2]};
+        }
+    };
+
+    // Direct representation of a key slicing string, like "{100..200}".
+    struct KeySlice
+    {
+        // The textual representation of the lower and upper keys. An empty string means
+        // an open ended slicing.
+        StringView lower;
+        StringView upper;
+
+        // Receives a key slicing string, like "{100..200}" or "{..200}", and returns an
+        // instance of `KeySlice` class that represents it. If the string is an invalid
+        // key slicing, returns nothing.
+        static auto build(StringView fmt) -> Optional<KeySlice>
+        {
+            if (fmt.size() < 2 || fmt.front() != '{' || fmt.back() != '}')
+            {
+                return {};
+            }
+
+            // Remove the opening '{' and the closing '}'
+            fmt.remove_prefix(1);
+            fmt.remove_suffix(1);
+
+            auto const cut_idx = fmt.find("..");
+            if (cut_idx == StringView::npos)
+            {
+                return {};
+            }
+
+            auto lower = fmt.substr(0, cut_idx);
+            auto upper = fmt.substr(cut_idx + 2);
+            lower.trim();
+            upper.trim();
+
+            return KeySlice{lower, upper};
+        }
+    };
+
+    // Advances `it` for `n` steps. Will stop before advancing `n` steps if `sentinel` is
+    // reached. Returns the actual displacement.
+    template <typename I, typename S>
+    auto advance_it(
+        I it, S const& sentinel, size_t n
+    ) -> typename std::enable_if<!is_sized_sentinel_for<S, I>::value, I>::type
+    {
+        auto offset = size_t{0};
+        while (it != sentinel && offset != n)
+        {
+            std::advance(it, 1);
+            offset += 1;
+        }
+
+        return it;
+    }
+
+    // When the distance to `sentinel` is computable in constant time, jumps directly to
+    // the target position.
+    template <typename I, typename S>
+    auto advance_it(
+        I it, S const& sentinel, size_t n
+    ) -> typename std::enable_if<is_sized_sentinel_for<S, I>::value, I>::type
+    {
+        auto const distance = sentinel - it;
+        if (distance <= 0)
+        {
+            return it;
+        }
+
+        auto const offset = static_cast<size_t>(distance) < n ? static_cast<size_t>(distance) : n;
+        std::advance(it, static_cast<ptrdiff_t>(offset));
+        return it;
+    }
+
+    // A functor whose nullary function call operator will return an Optional element in
+    // the range [it, sentinel) spaced by `step`. After exhausting the range, any call
+    // will return an empty Optional.
+    //
+    // The element pointed by `it` is at the position `first_idx` of the source range, and
+    // the following ones are at decreasing positions if `is_reverse` is true.
+    template <typename I, typename S>
+    class SliceFunctor
+    {
+    private:
+        I it_;
+        S sentinel_;
+        size_t step_;
+        size_t next_idx_;
+        size_t last_idx_;
+        bool is_reverse_;
+
+        auto advance_idx(size_t n) -> void
+        {
+            if (this->is_reverse_)
+            {
+                this->next_idx_ -= n;
+            }
+            else
+            {
+                this->next_idx_ += n;
+            }
+        }
+
+    public:
+        SliceFunctor(I it, S sentinel, size_t step, size_t first_idx, bool is_reverse)
+            : it_(it)
+            , sentinel_(sentinel)
+            , step_(step)
+            , next_idx_(first_idx)
+            , last_idx_(first_idx)
+            , is_reverse_(is_reverse)
+        {}
+
+        auto operator()() -> Optional<get_reference_t<I>>
+        {
+            if (this->it_ == this->sentinel_) return {};
+
+            auto old_it = this->it_;
+            this->it_ = advance_it(this->it_, this->sentinel_, this->step_);
+            this->last_idx_ = this->next_idx_;
+            this->advance_idx(this->step_);
+
+            return {*old_it};
+        }
+
+        // Skips the next `n` elements. It costs a constant time when the distance to the
+        // sentinel is computable in constant time.
+        auto skip(size_t n) -> void
+        {
+            this->it_ = advance_it(this->it_, this->sentinel_, n * this->step_);
+            this->advance_idx(n * this->step_);
+        }
+
+        // The position in the source range of the last yielded element.
+        auto index() const -> size_t
+        {
+            return this->last_idx_;
+        }
+
+        // The number of elements yet to be yielded, if computable in constant time.
+        template <typename I_ = I>
+        auto size() const -> typename std::enable_if<
+            is_sized_sentinel_for<S, I_>::value,
+            Optional<size_t>
+        >::type
+        {
+            auto const distance = this->sentinel_ - this->it_;
+            if (distance <= 0)
+            {
+                return size_t{0};
+            }
+            return (static_cast<size_t>(distance) + this->step_ - 1) / this->step_;
+        }
+
+        template <typename I_ = I>
+        auto size() const -> typename std::enable_if<
+            !is_sized_sentinel_for<S, I_>::value,
+            Optional<size_t>
+        >::type
+        {
+            return {};
+        }
+    };
+
+    template <typename I, typename S>
+    auto make_slice_functor(
+        I iterator, S sentinel, size_t step, size_t first_idx = 0, bool is_reverse = false
+    ) -> SliceFunctor<I, S>
+    {
+        return SliceFunctor<I, S>{iterator, sentinel, step, first_idx, is_reverse};
+    }
+
+    // A SliceFunctor to ranges of unknown size sliced with negative start or stop indexes,
+    // which can't be normalized beforehand. The range is traversed in a single pass keeping
+    // a ring buffer with the last `capacity` elements, where `capacity` is the largest
+    // absolute value among the negative indexes. That is enough to yield all the tail
+    // elements after reaching the range end, and to yield the other ones as soon as they
+    // are known to be before the stop index.
+    //
+    // The ring buffer keeps iterators to the elements of forward ranges. The elements of a
+    // single pass range could be invalidated when advancing its iterator, so copies of
+    // them are kept instead, and yielded by value.
+    template <typename I, typename S>
+    class RingSliceFunctor
+    {
+    private:
+        using Element = typename std::conditional<
+            is_multipass_iterator<I>::value,
+            get_reference_t<I>,
+            remove_cvref_t<get_reference_t<I>>
+        >::type;
+
+        using Stored = typename std::conditional<
+            is_multipass_iterator<I>::value, I, remove_cvref_t<get_reference_t<I>>
+        >::type;
+
+        template <typename I_ = I>
+        static auto store(I_ const& it) -> typename std::enable_if<
+            is_multipass_iterator<I_>::value, Stored
+        >::type
+        {
+            return it;
+        }
+
+        template <typename I_ = I>
+        static auto store(I_ const& it) -> typename std::enable_if<
+            !is_multipass_iterator<I_>::value, Stored
+        >::type
+        {
+            return *it;
+        }
+
+        template <typename I_ = I>
+        static auto load(Stored& stored) -> typename std::enable_if<
+            is_multipass_iterator<I_>::value, Element
+        >::type
+        {
+            return *stored;
+        }
+
+        template <typename I_ = I>
+        static auto load(Stored& stored) -> typename std::enable_if<
+            !is_multipass_iterator<I_>::value, Element
+        >::type
+        {
+            return stored;
+        }
+
+        I it_;
+        S sentinel_;
+        Optional<ptrdiff_t> start_;
+        Optional<ptrdiff_t> stop_;
+        size_t step_;
+
+        std::vector<Stored> ring_;
+        size_t capacity_;
+
+        // The position of the oldest iterator within `ring_`.
+        size_t head_;
+
+        // The number of traversed elements. After the traversal is complete, it is the
+        // range size.
+        size_t n_traversed_;
+
+        bool is_traversed_;
+
+        // The normalized stop index, and the index of the next element to be yielded.
+        // Both are known only after the traversal is complete.
+        size_t stop_idx_;
+        size_t next_idx_;
+
+        // The index of the last yielded element.
+        size_t last_idx_;
+
+        auto has_negative_start() const -> bool
+        {
+            return this->start_ && *this->start_ < 0;
+        }
+
+        auto normalize(ptrdiff_t idx) const -> size_t
+        {
+            auto const n = static_cast<ptrdiff_t>(this->n_traversed_);
+            auto const normalized = idx >= 0 ? idx : idx + n;
+            return
+                normalized < 0 ? 0
+                : normalized > n ? this->n_traversed_
+                : static_cast<size_t>(normalized);
+        }
+
+        // Called after reaching the range end, when the range size is finally known.
+        auto finish_traversal() -> void
+        {
+            this->is_traversed_ = true;
+
+            auto const start_idx = this->start_ ? this->normalize(*this->start_) : size_t{0};
+            this->stop_idx_ = this->stop_ ? this->normalize(*this->stop_) : this->n_traversed_;
+
+            // The index of the oldest element in the ring buffer
+            auto const first_idx = this->n_traversed_ - this->ring_.size();
+
+            if (start_idx >= first_idx)
+            {
+                this->next_idx_ = start_idx;
+            }
+            else
+            {
+                // The elements before `first_idx` were already yielded while traversing
+                auto const n_steps = (first_idx - start_idx + this->step_ - 1) / this->step_;
+                this->next_idx_ = start_idx + n_steps * this->step_;
+            }
+        }
+
+    public:
+        RingSliceFunctor(
+            I it,
+            S sentinel,
+            Optional<ptrdiff_t> start,
+            Optional<ptrdiff_t> stop,
+            size_t step
+        )
+            : it_(it)
+            , sentinel_(sentinel)
+            , start_(start)
+            , stop_(stop)
+            , step_(step)
+            , capacity_(0)
+            , head_(0)
+            , n_traversed_(0)
+            , is_traversed_(false)
+            , stop_idx_(0)
+            , next_idx_(0)
+            , last_idx_(0)
+        {
+            if (start && *start < 0)
+            {
+                this->capacity_ = static_cast<size_t>(-*start);
+            }
+            if (stop && *stop < 0 && static_cast<size_t>(-*stop) > this->capacity_)
+            {
+                this->capacity_ = static_cast<size_t>(-*stop);
+            }
+        }
+
+        auto operator()() -> Optional<Element>
+        {
+            while (!this->is_traversed_)
+            {
+                if (this->it_ == this->sentinel_)
+                {
+                    this->finish_traversal();
+                    break;
+                }
+
+                if (this->ring_.size() < this->capacity_)
+                {
+                    this->ring_.push_back(store(this->it_));
+                    ++this->it_;
+                    ++this->n_traversed_;
+                    continue;
+                }
+
+                // The evicted element is followed by at least `capacity_` elements, so it
+                // is before any negative stop index. Unless the start index is negative,
+                // when all the selected elements will be at the ring buffer.
+                auto evicted = std::move(this->ring_[this->head_]);
+                auto const evicted_idx = this->n_traversed_ - this->capacity_;
+
+                this->ring_[this->head_] = store(this->it_);
+                this->head_ = (this->head_ + 1) % this->capacity_;
+                ++this->it_;
+                ++this->n_traversed_;
+
+                auto const start_idx = this->start_ ? static_cast<size_t>(*this->start_) : size_t{0};
+                if (
+                    !this->has_negative_start()
+                    && evicted_idx >= start_idx
+                    && (evicted_idx - start_idx) % this->step_ == 0
+                ) {
+                    this->last_idx_ = evicted_idx;
+                    return {load(evicted)};
+                }
+            }
+
+            if (this->next_idx_ >= this->stop_idx_)
+            {
+                return {};
+            }
+
+            auto const first_idx = this->n_traversed_ - this->ring_.size();
+            auto const pos = (this->head_ + this->next_idx_ - first_idx) % this->ring_.size();
+            this->last_idx_ = this->next_idx_;
+            this->next_idx_ += this->step_;
+
+            return {load(this->ring_[pos])};
+        }
+
+        // Skips the next `n` elements.
+        auto skip(size_t n) -> void
+        {
+            for (auto i = size_t{0}; i < n && (*this)(); ++i)
+            {}
+        }
+
+        // The size is known only after the traversal.
+        auto size() const -> Optional<size_t>
+        {
+            return {};
+        }
+
+        // The position in the source range of the last yielded element.
+        auto index() const -> size_t
+        {
+            return this->last_idx_;
+        }
+    };
+
+    template <typename R>
+    auto maybe_get_size(
+        R&& range
+    ) -> typename std::enable_if<
+        has_size_function_overload<R>::value,
+        Optional<size_t>
+    >::type
+    {
+        return size(range);
+    }
+
+    template <typename R>
+    auto maybe_get_size(
+        R&& range
+    ) -> typename std::enable_if<
+        has_size_method<R>::value && !has_size_function_overload<R>::value,
+        Optional<size_t>
+    >::type
+    {
+        return range.size();
+    }
+
+    template <typename R>
+    auto maybe_get_size(
+        R&&
+    ) -> typename std::enable_if<
+        !is_sized<R>::value,
+        Optional<size_t>
+    >::type
+    {
+        return {};
+    }
+
+    // The `build_slice_functor_*` functions below build a SliceFunctor and call `visitor`
+    // with it. Since the SliceFunctor type depends on the slicing direction and on
+    // having a stop point, a visitor avoids the cost of a type erased functor.
+
+    template <typename R, typename V>
+    auto build_slice_functor_p(
+        R&& range,
+        Optional<size_t> mb_start,
+        Optional<size_t> mb_stop,
+        size_t step,
+        V&& visitor
+    ) -> void
+    {
+        auto const start_it = mb_start ? advance_it(begin(range), end(range), *mb_start) : begin(range);
+
+        auto const first_idx = mb_start ? *mb_start : 0;
+
+        if (!mb_stop)
+        {
+            visitor(make_slice_functor(start_it, end(range), step, first_idx));
+        }
+        else if (is_sized<R>::value)  // So it has a value and it is normalized
+        {
+            auto stop_it = begin(range);
+            std::advance(stop_it, static_cast<ptrdiff_t>(*mb_stop));
+            visitor(make_slice_functor(start_it, stop_it, step, first_idx));
+        }
+        else
+        {
+            visitor(
+                make_slice_functor(
+                    start_it,
+                    advance_it(begin(range), end(range), *mb_stop),
+                    step,
+                    first_idx
+                )
+            );
+        }
+    }
+
+    template <typename R, typename V>
+    auto build_slice_functor_n(
+        R&& range,
+        Optional<size_t> mb_start,
+        Optional<size_t> mb_stop,
+        size_t step,
+        V&& visitor
+    ) ->
+        typename std::enable_if<
+            is_bidirectional_range<R>::value
+        >::type
+    {
+        auto make_reverse_iterator = [](get_iterator_t<R> it)
+        {
+            return std::reverse_iterator<get_iterator_t<R>>(it);
+        };
+
+        auto start_it = mb_start ?
+            advance_it(begin(range), end(range), *mb_start) :
+
+            // An Iterator instance evaluating equal to the range Sentinel. Since we will
+            // backwardly iterate over the range, that is the default starting point.
+            advance_it(begin(range), end(range), std::numeric_limits<size_t>::max());
+
+        // When derreferencing a `reverse_iterator<IT>`, the retrieved element will be one
+        // before the element pointed by IT. So here we fix that offset.
+        if (start_it != end(range)) ++start_it;
+
+        // The position of the first yielded element, the one before `start_it`.
+        auto const mb_size = maybe_get_size(range);
+        auto const first_idx = mb_size ?
+            (mb_start && *mb_start < *mb_size ? *mb_start : *mb_size - 1)
+            : static_cast<size_t>(std::distance(begin(range), start_it)) - 1;
+
+        // If we don't have a stop value, set it to the beginning of the range
+        if (!mb_stop)
+        {
+            auto stop_it = begin(range);
+            visitor(
+                make_slice_functor(
+                    make_reverse_iterator(start_it),
+                    make_reverse_iterator(stop_it),
+                    step,
+                    first_idx,
+                    true
+                )
+            );
+        }
+
+        // If we do have a stop value, and its value is normalized within [0, range_size]
+        else if (is_sized<R>::value)
+        {
+            auto stop_it = begin(range);
+            std::advance(stop_it, static_cast<ptrdiff_t>(*mb_stop));
+            if (stop_it != end(range)) ++stop_it;
+
+            visitor(
+                make_slice_functor(
+                    make_reverse_iterator(start_it),
+                    make_reverse_iterator(stop_it),
+                    step,
+                    first_idx,
+                    true
+                )
+            );
+        }
+
+        // If we do have a stop value, and its value is not normalized
+        else
+        {
+            auto stop_it = advance_it(begin(range), end(range), *mb_stop);
+            visitor(
+                make_slice_functor(
+                    make_reverse_iterator(start_it),
+                    make_reverse_iterator(stop_it),
+                    step,
+                    first_idx,
+                    true
+                )
+            );
+        }
+    }
+
+    template <typename R, typename V>
+    auto build_slice_functor_n(R&&, Optional<size_t>, Optional<size_t>, size_t, V&&) ->
+        typename std::enable_if<
+            !is_bidirectional_range<R>::value
+        >::type
+    {
+        ICECREAM_UNREACHABLE;
+    }
+
+    // Builds the SliceFunctor of `range` accordingly to `slice`, and calls `visitor` with
+    // it. Returns an error message if the slicing can't be applied to the range.
+    template <typename R, typename V>
+    auto visit_slice_functor(
+        R&& range, Slice const& slice, V&& visitor
+    ) -> Optional<std::string>
+    {
+        auto const mb_range_size = maybe_get_size(range);
+
+        if (
+            mb_range_size
+            && *mb_range_size > static_cast<size_t>(std::numeric_limits<ptrdiff_t>::max())
+        ) {
+            return std::string("<this range size greater than the maximum supported>");
+        }
+
+        auto const step = slice.step ? *slice.step : 1;
+        if (step == 0)
+        {
+            return std::string{"<slice step cannot be zero>"};
+        }
+        if (!is_bidirectional_range<R>::value && step < 0)
+        {
+            return std::string{"<this range supports only strictly positive slice steps>"};
+        }
+
+        // If the range size is unknown it is not possible to normalize a negative index
+        // beforehand. With a positive step, the slicing can still be done while
+        // traversing the range.
+        if (
+            !mb_range_size
+            && ((slice.start && *slice.start < 0) || (slice.stop && *slice.stop < 0))
+        ) {
+            if (step < 0)
+            {
+                return std::string{
+                    "<this range supports negative slice indexes only with positive steps>"
+                };
+            }
+
+            visitor(
+                RingSliceFunctor<get_iterator_t<R>, decltype(end(range))>(
+                    begin(range), end(range), slice.start, slice.stop, static_cast<size_t>(step)
+                )
+            );
+            return {};
+        }
+
+        auto const mb_start =
+            [&]() -> Optional<size_t> {
+                if (!slice.start)
+                {
+                    return {};
+                }
+                else if (mb_range_size)
+                {
+                    auto const range_size = static_cast<ptrdiff_t>(*mb_range_size);
+                    auto const idx = (*slice.start >= 0) ? *slice.start : *slice.start + range_size;
+                    return (idx < 0) ?
+                        0
+                        : (idx > range_size) ? static_cast<size_t>(range_size) : static_cast<size_t>(idx);
+                }
+                else
+                {
+                    // If range is unsized, start was ensured as non-negative above
+                    return static_cast<size_t>(*slice.start);
+                }
+            }();
+
+        auto const mb_stop =
+            [&]() -> Optional<size_t> {
+                if (!slice.stop)
+                {
+                    return {};
+                }
+                else if (mb_range_size)
+                {
+                    auto const range_size = static_cast<ptrdiff_t>(*mb_range_size);
+                    auto const idx = (*slice.stop >= 0) ? *slice.stop : *slice.stop + range_size;
+
+                    if (step < 0 && idx < 0)
+                    {
+                        return {};
+                    }
+                    else
+                    {
+                        return (idx < 0) ?
+                            0
+                            : (idx > range_size) ? static_cast<size_t>(range_size) : static_cast<size_t>(idx);
+                    }
+                }
+                else
+                {
+                    // If range is unsized, stop was ensured as non-negative above
+                    return static_cast<size_t>(*slice.stop);
+                }
+            }();
+
+        // If the stop point would be placed before the start point. Return an empty slicing.
+        if (
+            mb_start && mb_stop &&
+            (
+                (step > 0 && *mb_stop <= *mb_start) ||
+                (step < 0 && *mb_stop >= *mb_start)
+            )
+        ) {
+            build_slice_functor_p(range, 0, 0, 1, visitor);
+            return {};
+        }
+
+        // At here, we know for sure that for all start, stop, and step; if they have a
+        // value, that value is non-negative and step non zero too. In addition to that,
+        // stop for sure is placed at the same location as start or in a place after
+        // start.
+
+        if (step > 0)
+        {
+            build_slice_functor_p(range, mb_start, mb_stop, static_cast<size_t>(step), visitor);
+        }
+        else  // step < 0
+        {
+            build_slice_functor_n(range, mb_start, mb_stop, static_cast<size_t>(-step), visitor);
+        }
+
+        return {};
+    }
+
+
+    // Parses a key from its textual representation, using its `operator>>` overload.
+    template <typename K>
+    auto parse_key(StringView text) -> Optional<K>
+    {
+        std::istringstream istrm(text.to_string());
+        auto key = K{};
+
+        istrm >> key;
+        if (istrm.fail())
+        {
+            return {};
+        }
+
+        // All the text must be consumed
+        istrm >> std::ws;
+        if (!istrm.eof())
+        {
+            return {};
+        }
+
+        return key;
+    }
+
+    template <typename R, typename V>
+    auto visit_key_slice_functor(
+        R&&, KeySlice const&, V&&
+    ) -> typename std::enable_if<!is_key_sliceable<R>::value, Optional<std::string>>::type
+    {
+        return std::string{"<this range doesn't support key slicing>"};
+    }
+
+    // Builds the SliceFunctor of an ordered associative container accordingly to a key
+    // slicing, and calls `visitor` with it. The slicing bounds are found in logarithmic
+    // time by the container `lower_bound` and `upper_bound` methods, both being inclusive.
+    // Returns an error message if any key can't be parsed.
+    template <typename R, typename V>
+    auto visit_key_slice_functor(
+        R&& range, KeySlice const& key_slice, V&& visitor
+    ) -> typename std::enable_if<is_key_sliceable<R>::value, Optional<std::string>>::type
+    {
+        using Key = typename remove_cvref_t<R>::key_type;
+
+        auto const& crange = range;
+        auto first = begin(crange);
+        auto last = end(crange);
+
+        auto const mb_lower =
+            key_slice.lower.empty() ? Optional<Key>{} : parse_key<Key>(key_slice.lower);
+        auto const mb_upper =
+            key_slice.upper.empty() ? Optional<Key>{} : parse_key<Key>(key_slice.upper);
+
+        if ((!key_slice.lower.empty() && !mb_lower) || (!key_slice.upper.empty() && !mb_upper))
+        {
+            return std::string{"<invalid slicing key>"};
+        }
+
+        if (mb_lower)
+        {
+            first = crange.lower_bound(*mb_lower);
+        }
+
+        if (mb_upper)
+        {
+            last = crange.upper_bound(*mb_upper);
+        }
+
+        // If the upper key is before the lower key, return an empty slicing.
+        if (mb_lower && mb_upper && crange.key_comp()(*mb_upper, *mb_lower))
+        {
+            last = first;
+        }
+
+        visitor(make_slice_functor(first, last, 1));
+        return {};
+    }
+
+    // Receives a range formatting string, "[:3]:#x" for instance, and splits it in a
+    // pair: the range formatting itself ("[:3]") and the elements formatting ("#x"). The
+    // cut point is the leftmost colon that is outside of a square bracket or a curly
+    // bracket pair.
+    inline auto split_range_fmt_string(StringView fmt) -> std::tuple<StringView, StringView>
+    {
+        auto is_inside_brackets = false;
+        for (auto i = size_t{0}; i < fmt.size(); ++i)
+        {
+            if (fmt[i] == '[' || fmt[i] == '{')
+            {
+                is_inside_brackets = true;
+            }
+            else if (fmt[i] == ']' || fmt[i] == '}')
+            {
+                is_inside_brackets = false;
+            }
+            else if (!is_inside_brackets && fmt[i] == ':')
+            {
+                auto const iterable_fmt = fmt.substr(0, i);
+                auto const element_fmt = fmt.substr(i + 1, StringView::npos);
+                return std::make_tuple(iterable_fmt, element_fmt);
+            }
+        }
+
+        // If there isn't a colon cut point, all the input `fmt` string is the iterable
+        // formatting
+        return std::make_tuple(fmt, "");
+    }
+
+    // Checks if T is an arithmetic type that is printed as a number, and so can be handled
+    // by the ArithmeticFormatter class.
+    template <typename T>
+    using is_formattable_number =
+        conjunction<
+            std::is_arithmetic<remove_cvref_t<T>>,
+            negation<std::is_same<remove_cvref_t<T>, bool>>,
+            negation<is_character<remove_cvref_t<T>>>,
+            negation<is_xsig_char<remove_cvref_t<T>>>,
+            negation<is_int128<remove_cvref_t<T>>>
+        >;
+
+    // Checks if T is a number that can be summarized by the "stats" formatting. Besides
+    // the formattable numbers, the signed and unsigned chars are accepted, being the usual
+    // elements of raw sample buffers.
+    template <typename T>
+    using is_stats_number =
+        disjunction<
+            is_formattable_number<T>,
+            is_xsig_char<remove_cvref_t<T>>
+        >;
+
+    // Formats the numeric elements of a range. The result is the same as calling
+    // `make_printing_branch` on each element, but the formatting state built from the
+    // elements format string is reused across all of them. When that string is empty, the
+    // numbers are written with `std::to_chars` whenever its output is known to be the same.
+    class ArithmeticFormatter
+    {
+    public:
+        ArithmeticFormatter()
+            : is_ostream_built_(false)
+            , ostream_width_(0)
+            , is_locale_checked_(false)
+            , is_classic_locale_(false)
+        {}
+
+        template <typename T>
+        auto format(T value, StringView fmt, Config_ const& config) -> PrintingNode
+        {
+          #if defined(ICECREAM_TO_CHARS)
+            if (fmt.empty())
+            {
+                char buffer[64];
+                auto const mb_size = this->to_chars(buffer, buffer + sizeof(buffer), value);
+                if (mb_size)
+                {
+                    return PrintingNode(StringView(buffer, *mb_size));
+                }
+            }
+          #endif
+
+            return this->do_format(value, fmt, config);
+        }
+
+    private:
+        Optional<std::ostringstream> mb_ostream_;
+        bool is_ostream_built_;
+        std::streamsize ostream_width_;
+
+        bool is_locale_checked_;
+        bool is_classic_locale_;
+
+        // The numbers printed by an ostream depend on its locale.
+        auto is_classic_locale() -> bool
+        {
+            if (!this->is_locale_checked_)
+            {
+                this->is_classic_locale_ = std::locale() == std::locale::classic();
+                this->is_locale_checked_ = true;
+            }
+
+            return this->is_classic_locale_;
+        }
+
+      #if defined(ICECREAM_TO_CHARS)
+        // Writes `value` as the `make_printing_branch` function would do with an empty
+        // format string. Returns the written size, or an empty Optional if that can't be
+        // done using `std::to_chars`.
+        template <typename T>
+        auto to_chars(char* first, char* last, T value) ->
+            typename std::enable_if<
+                is_streamable<T>::value
+                && !is_stl_formattable<T>::value
+                && !is_fmt_formattable<T>::value
+                , Optional<size_t>
+            >::type
+        {
+            if (!this->is_classic_locale())
+            {
+                return {};
+            }
+
+            return to_chars_size(first, ostream_to_chars(first, last, value));
+        }
+
+        template <typename T>
+        static auto ostream_to_chars(char* first, char* last, T value) ->
+            typename std::enable_if<std::is_integral<T>::value, std::to_chars_result>::type
+        {
+            return std::to_chars(first, last, value);
+        }
+
+        // An ostream with default flags prints floating point numbers as the "%g" printf
+        // specifier does, which is what this `std::to_chars` overload does too.
+        template <typename T>
+        static auto ostream_to_chars(char* first, char* last, T value) ->
+            typename std::enable_if<std::is_floating_point<T>::value, std::to_chars_result>::type
+        {
+            return std::to_chars(first, last, value, std::chars_format::general, 6);
+        }
+
+      #if defined(ICECREAM_STL_FORMAT)
+        template <typename T>
+        auto to_chars(char* first, char* last, T value) ->
+            typename std::enable_if<
+                is_stl_formattable<T>::value && !is_fmt_formattable<T>::value,
+                Optional<size_t>
+            >::type
+        {
+            // The "{}" format string is defined in terms of `std::to_chars`.
+            return to_chars_size(first, std::to_chars(first, last, value));
+        }
+      #endif
+
+      #if defined(ICECREAM_FMT_ENABLED)
+        template <typename T>
+        auto to_chars(char* first, char* last, T value) ->
+            typename std::enable_if<is_fmt_formattable<T>::value, Optional<size_t>>::type
+        {
+            // The {fmt} library shortest floating point representation is not guaranteed
+            // to be the same as the `std::to_chars` one.
+            if (std::is_floating_point<T>::value)
+            {
+                return {};
+            }
+
+            return to_chars_size(first, std::to_chars(first, last, value));
+        }
+      #endif
+
+        static auto to_chars_size(char* first, std::to_chars_result result) -> Optional<size_t>
+        {
+            if (result.ec != std::errc{})
+            {
+                return {};
+            }
+
+            return static_cast<size_t>(result.ptr - first);
+        }
+      #endif  // defined(ICECREAM_TO_CHARS)
+
+        template <typename T>
+        auto do_format(T value, StringView fmt, Config_ const& config) ->
+            typename std::enable_if<
+                is_streamable<T>::value
+                && !is_stl_formattable<T>::value
+                && !is_fmt_formattable<T>::value
+                , PrintingNode
+            >::type
+        {
+            if (!this->is_ostream_built_)
+            {
+                this->mb_ostream_ = build_ostream(fmt);
+                if (this->mb_ostream_)
+                {
+                    this->ostream_width_ = this->mb_ostream_->width();
+                }
+                this->is_ostream_built_ = true;
+            }
+
+            if (!this->mb_ostream_)
+            {
+                return PrintingNode("*Error* in formatting string");
+            }
+
+            // All the ostream state set by `build_ostream` is kept between the elements,
+            // except by the width, which is reset after each output.
+            auto& ostrm = *this->mb_ostream_;
+            ostrm.str("");
+            ostrm.clear();
+            ostrm.width(this->ostream_width_);
+
+            if (std::is_integral<T>::value)
+            {
+                return do_print_integral(value, config, ostrm);
+            }
+            else
+            {
+                ostrm << value;
+                return PrintingNode(ostrm.str());
+            }
+        }
+
+        template <typename T>
+        auto do_format(T value, StringView fmt, Config_ const& config) ->
+            typename std::enable_if<
+                is_stl_formattable<T>::value || is_fmt_formattable<T>::value,
+                PrintingNode
+            >::type
+        {
+            return make_printing_branch(value, fmt, config);
+        }
+    };
+
+    // The printing nodes of the elements of a range, bounded by the `max_range_elements`
+    // and `max_output_bytes` limits.
+    class RangeChildren
+    {
+    public:
+        explicit RangeChildren(size_t max_elements)
+            : max_elements_(max_elements)
+            , n_elements_(0)
+            , streamer_(nullptr)
+            , is_streaming_(false)
+            , n_code_points_(0)
+        {}
+
+        // Makes the pushed nodes be written by `streamer` as soon as it is known that the
+        // range won't fit in a single line, instead of holding all of them.
+        auto stream_to(RangeStreamer* streamer, StringView opening) -> void
+        {
+            this->streamer_ = streamer;
+            this->opening_ = opening.to_string();
+        }
+
+        // If the range nodes were written by a RangeStreamer.
+        auto is_streamed() const -> bool
+        {
+            return this->is_streaming_;
+        }
+
+        // If any printing limit was reached, so that no more elements should be pushed.
+        auto is_full() const -> bool
+        {
+            return this->n_elements_ == this->max_elements_ || OutputBudget::is_exhausted();
+        }
+
+        auto max_elements() const -> size_t
+        {
+            return this->max_elements_;
+        }
+
+        auto n_elements() const -> size_t
+        {
+            return this->n_elements_;
+        }
+
+        // Preallocates the nodes to a range having `size` elements. A range that can be
+        // streamed isn't preallocated, since only a chunk of its nodes is held at a time.
+        auto reserve(size_t size) -> void
+        {
+            if (this->streamer_ == nullptr)
+            {
+                // An additional node to the elision marker.
+                this->nodes_.reserve((size < this->max_elements_ ? size : this->max_elements_) + 1);
+            }
+        }
+
+        template <typename E>
+        auto push(E&& element, StringView fmt, Config_ const& config) -> void
+        {
+            this->push_node(this->make_node(std::forward<E>(element), fmt, config));
+        }
+
+        // Pushes an element printed after a `label`, as in "label: element".
+        template <typename E>
+        auto push_labeled(
+            StringView label, E&& element, StringView fmt, Config_ const& config
+        ) -> void
+        {
+            this->push_node(
+                make_labeled_node(label, this->make_node(std::forward<E>(element), fmt, config))
+            );
+        }
+
+        // Pushes the already built node of an element.
+        auto push_node(PrintingNode&& node) -> void
+        {
+            this->nodes_.push_back(std::move(node));
+            ++this->n_elements_;
+            this->stream();
+        }
+
+        auto push_marker(StringView marker) -> void
+        {
+            this->nodes_.push_back(PrintingNode(marker));
+            this->stream();
+        }
+
+        // Returns the nodes to be the range children. If the range was streamed, all the
+        // remaining nodes are written instead, and an empty vector is returned.
+        auto release() -> std::vector<PrintingNode>
+        {
+            if (this->is_streaming_)
+            {
+                this->streamer_->write_elements(this->nodes_, this->nodes_.size(), true);
+                this->streamer_->end_range("]");
+                this->nodes_.clear();
+            }
+
+            return std::move(this->nodes_);
+        }
+
+    private:
+        size_t max_elements_;
+        size_t n_elements_;
+        std::vector<PrintingNode> nodes_;
+        ArithmeticFormatter arithmetic_formatter_;
+
+        RangeStreamer* streamer_;
+        std::string opening_;
+        bool is_streaming_;
+
+        // The code points count of the not yet written nodes and their separators.
+        size_t n_code_points_;
+
+        template <typename E>
+        auto make_node(E&& element, StringView fmt, Config_ const& config) ->
+            typename std::enable_if<!is_formattable_number<E>::value, PrintingNode>::type
+        {
+            return make_printing_branch(std::forward<E>(element), fmt, config);
+        }
+
+        template <typename E>
+        auto make_node(E&& element, StringView fmt, Config_ const& config) ->
+            typename std::enable_if<is_formattable_number<E>::value, PrintingNode>::type
+        {
+            return this->arithmetic_formatter_.format<remove_cvref_t<E>>(element, fmt, config);
+        }
+
+        auto stream() -> void
+        {
+            if (this->streamer_ == nullptr)
+            {
+                return;
+            }
+
+            this->n_code_points_ += this->nodes_.back().code_point_length() + 2;
+
+            if (!this->is_streaming_)
+            {
+                if (this->opening_.size() + this->n_code_points_ <= this->streamer_->line_wrap_width())
+                {
+                    return;
+                }
+
+                this->streamer_->begin_range(this->opening_);
+                this->is_streaming_ = true;
+            }
+
+            // The last node is kept, since it is unknown yet if it will need a separator.
+            if (this->n_code_points_ > RangeStreamer::CHUNK_SIZE)
+            {
+                this->streamer_->write_elements(this->nodes_, this->nodes_.size() - 1, false);
+                this->nodes_.erase(this->nodes_.begin(), this->nodes_.end() - 1);
+                this->n_code_points_ = this->nodes_.back().code_point_length() + 2;
+            }
+        }
+    };
+
+    // The marker of `n_elided` elements not printed.
+    inline auto make_elision_marker(size_t n_elided) -> std::string
     {
-        using Hijacked = int;
+        return "..., <" + std::to_string(n_elided) + " more>";
+    }
+
+    // The number of first and last elements printed when eliding the middle of a range,
+    // with at most `edge_items` at each edge, and `max_elements` in total. When not all
+    // can be printed, the first elements get the larger half.
+    inline auto get_edge_counts(size_t edge_items, size_t max_elements) -> std::pair<size_t, size_t>
+    {
+        auto const n_head = std::min(edge_items, max_elements - max_elements / 2);
+        auto const n_tail = std::min(edge_items, max_elements - n_head);
+        return std::make_pair(n_head, n_tail);
+    }
+
+    // Prints the first `edge_counts.first` and the last `edge_counts.second` elements
+    // yielded by `slice_functor`, which will yield `size` elements, eliding all the ones in
+    // between. They will be not visited at all if the range is random access, otherwise
+    // they will be only stepped over.
+    template <typename F>
+    auto print_range_edges(
+        F& slice_functor,
+        size_t size,
+        std::pair<size_t, size_t> edge_counts,
+        StringView elements_fmt,
+        Config_ const& config,
+        RangeChildren& children
+    ) -> void
+    {
+        for (auto i = size_t{0}; i < edge_counts.first; ++i)
+        {
+            if (children.is_full())
+            {
+                children.push_marker("...");
+                return;
+            }
+            children.push(*slice_functor(), elements_fmt, config);
+        }
+
+        auto const n_elided = size - edge_counts.first - edge_counts.second;
+        children.push_marker(make_elision_marker(n_elided));
+        if (edge_counts.second == 0)
+        {
+            return;
+        }
+        slice_functor.skip(n_elided);
+
+        for (auto i = size_t{0}; i < edge_counts.second; ++i)
+        {
+            if (children.is_full())
+            {
+                children.push_marker("...");
+                return;
+            }
+            children.push(*slice_functor(), elements_fmt, config);
+        }
+    }
+
+    // Prints the first and the last `edge_items` elements yielded by `next_element`,
+    // eliding all the ones in between, and with at most `max_range_elements` in total.
+    // Since the number of elements is unknown, this will traverse them in a single pass,
+    // keeping the last ones in a ring buffer. The traversal stops after visiting
+    // `max_range_elements` elements.
+    template <typename F>
+    auto print_range_edges_single_pass(
+        F& next_element,
+        size_t edge_items,
+        StringView elements_fmt,
+        Config_ const& config,
+        RangeChildren& children
+    ) -> void
+    {
+        auto const edge_counts =
+            get_edge_counts(edge_items, children.max_elements() - children.n_elements());
+
+        auto mb_element = next_element();
+        for (auto i = size_t{0}; mb_element && i < edge_counts.first; ++i)
+        {
+            if (children.is_full())
+            {
+                children.push_marker("...");
+                return;
+            }
+            children.push(*mb_element, elements_fmt, config);
+            mb_element = next_element();
+        }
+
+        auto ring = std::vector<decltype(next_element())>{};
+        ring.reserve(edge_counts.second);
+
+        auto n_tail = size_t{0};
+        for (; mb_element; mb_element = next_element(), ++n_tail)
+        {
+            if (n_tail == children.max_elements() - children.n_elements())
+            {
+                children.push_marker("...");
+                return;
+            }
+
+            if (ring.size() < edge_counts.second)
+            {
+                ring.push_back(std::move(mb_element));
+            }
+            else
+            {
+                ring[n_tail % edge_counts.second] = std::move(mb_element);
+            }
+        }
+
+        if (n_tail > ring.size())
+        {
+            children.push_marker(make_elision_marker(n_tail - ring.size()));
+        }
+
+        // The oldest element in the ring buffer
+        auto const first = ring.empty() ? 0 : n_tail % ring.size();
+        for (auto i = size_t{0}; i < ring.size(); ++i)
+        {
+            if (children.is_full())
+            {
+                children.push_marker("...");
+                return;
+            }
+            children.push(*ring[(first + i) % ring.size()], elements_fmt, config);
+        }
+    }
+
+    // Checks if a range R can have its elements formatted by multiple threads.
+  #if defined(ICECREAM_PARALLEL)
+    template <typename R>
+    using is_parallel_printable = is_random_access_iterator<get_iterator_t<R>>;
+  #else
+    template <typename R>
+    using is_parallel_printable = std::false_type;
+  #endif
+
+    template <typename R>
+    auto print_range_parallel(
+        R&, size_t, StringView, Config_ const&, RangeChildren&
+    ) -> typename std::enable_if<!is_parallel_printable<R>::value, bool>::type
+    {
+        return false;
+    }
+
+  #if defined(ICECREAM_PARALLEL)
+    // Marks the threads formatting the elements of a range in parallel, while doing it. A
+    // range nested within those elements will be formatted by a single thread.
+    class ParallelPrinting
+    {
+    public:
+        ParallelPrinting()
+            : previous_(ParallelPrinting::current())
+        {
+            ParallelPrinting::current() = true;
+        }
+
+        ~ParallelPrinting()
+        {
+            ParallelPrinting::current() = this->previous_;
+        }
+
+        ParallelPrinting(ParallelPrinting const&) = delete;
+
+        auto operator=(ParallelPrinting const&) -> ParallelPrinting& = delete;
+
+        static auto is_active() -> bool
+        {
+            return ParallelPrinting::current();
+        }
+
+    private:
+        bool previous_;
+
+        static auto current() -> bool&
+        {
+            static thread_local auto is_active = false;
+            return is_active;
+        }
+    };
+
+    // The worker threads running the tasks of all the ranges formatted in parallel. They
+    // are created at the first use, one to each hardware thread, and live until the program
+    // exit, so that formatting a range doesn't pay for creating and joining threads.
+    class WorkerPool
+    {
+    public:
+        static auto global() -> WorkerPool&
+        {
+            static WorkerPool pool;
+            return pool;
+        }
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> guard(this->mutex_);
+                this->is_stopped_ = true;
+            }
+            this->condition_.notify_all();
+
+            for (auto& thread : this->threads_)
+            {
+                thread.join();
+            }
+        }
+
+        WorkerPool(WorkerPool const&) = delete;
+
+        auto operator=(WorkerPool const&) -> WorkerPool& = delete;
+
+        // The number of worker threads. Zero if none could be created.
+        auto size() const -> size_t
+        {
+            return this->threads_.size();
+        }
+
+        // Queues the `task` to be run by the first idle worker thread. The `task` must not
+        // throw.
+        auto submit(std::function<void()> task) -> void
+        {
+            {
+                std::lock_guard<std::mutex> guard(this->mutex_);
+                this->tasks_.push_back(std::move(task));
+            }
+            this->condition_.notify_one();
+        }
+
+    private:
+        WorkerPool()
+        {
+            auto const n_threads = std::thread::hardware_concurrency() > 1 ?
+                size_t{std::thread::hardware_concurrency()} : size_t{1};
+            for (auto i = size_t{0}; i < n_threads; ++i)
+            {
+                try
+                {
+                    this->threads_.emplace_back([this]() {this->work();});
+                }
+                catch (std::system_error const&)
+                {
+                    break;
+                }
+            }
+        }
+
+        auto work() -> void
+        {
+            for (;;)
+            {
+                std::unique_lock<std::mutex> lock(this->mutex_);
+                this->condition_.wait(
+                    lock, [this]() {return this->is_stopped_ || !this->tasks_.empty();}
+                );
+                if (this->tasks_.empty())
+                {
+                    return;
+                }
+
+                auto task = std::move(this->tasks_.front());
+                this->tasks_.pop_front();
+                lock.unlock();
+
+                task();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::deque<std::function<void()>> tasks_;
+        bool is_stopped_ = false;
+
+        std::vector<std::thread> threads_;
+    };
+
+    // A set of workers, run by the WorkerPool threads, formatting the chunks of a range.
+    // Each worker takes the next chunk not yet taken, and the formatted chunks are handed
+    // back in order. At most `window` chunks are held formatted and not yet taken, so that
+    // only a bounded number of nodes exists at a time when the range is being streamed.
+    class ChunkWorkers
+    {
+    public:
+        ChunkWorkers(
+            size_t n_chunks,
+            size_t window,
+            std::function<std::vector<PrintingNode>(size_t)> format_chunk
+        )
+            : n_chunks_(n_chunks)
+            , window_(window)
+            , format_chunk_(std::move(format_chunk))
+            , slots_(window)
+            , is_ready_(window, false)
+        {}
+
+        // Waits for all the workers, including the ones still queued in the pool, which
+        // will return right away.
+        ~ChunkWorkers()
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->is_stopped_ = true;
+            this->condition_.notify_all();
+            this->condition_.wait(lock, [this]() {return this->n_workers_ == 0;});
+        }
+
+        ChunkWorkers(ChunkWorkers const&) = delete;
+
+        auto operator=(ChunkWorkers const&) -> ChunkWorkers& = delete;
+
+        // Submits a worker to each thread of the `pool`.
+        auto launch(WorkerPool& pool, size_t nesting_depth) -> void
+        {
+            auto const is_json = JsonPrinting::is_active();
+            for (auto i = size_t{0}; i < pool.size(); ++i)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(this->mutex_);
+                    ++this->n_workers_;
+                }
+
+                try
+                {
+                    pool.submit(
+                        [this, nesting_depth, is_json]()
+                        {
+                            {
+                                NestingLevel const nesting_level(nesting_depth);
+                                ParallelPrinting const parallel_printing;
+                                JsonPrinting const json_printing(is_json);
+                                this->work();
+                            }
+
+                            // Notified while holding the lock, since this object may be
+                            // destroyed as soon as it is released.
+                            std::lock_guard<std::mutex> guard(this->mutex_);
+                            --this->n_workers_;
+                            this->condition_.notify_all();
+                        }
+                    );
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> guard(this->mutex_);
+                    --this->n_workers_;
+                    throw;
+                }
+            }
+        }
+
+        // Waits and returns the nodes of the chunk `chunk_idx`. The chunks must be taken
+        // in order. Rethrows any exception thrown while formatting the chunks.
+        auto take(size_t chunk_idx) -> std::vector<PrintingNode>
+        {
+            auto const slot_idx = chunk_idx % this->window_;
+
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->condition_.wait(
+                lock, [&]() {return this->is_ready_[slot_idx] || this->error_;}
+            );
+
+            if (this->error_)
+            {
+                std::rethrow_exception(this->error_);
+            }
+
+            auto nodes = std::move(this->slots_[slot_idx]);
+            this->is_ready_[slot_idx] = false;
+            this->n_taken_ = chunk_idx + 1;
+            lock.unlock();
+            this->condition_.notify_all();
+
+            return nodes;
+        }
+
+    private:
+        auto work() -> void
+        {
+            for (;;)
+            {
+                std::unique_lock<std::mutex> lock(this->mutex_);
+                this->condition_.wait(
+                    lock,
+                    [this]()
+                    {
+                        return
+                            this->is_stopped_
+                            || this->error_
+                            || this->next_chunk_ >= this->n_chunks_
+                            || this->next_chunk_ < this->n_taken_ + this->window_;
+                    }
+                );
+                if (this->is_stopped_ || this->error_ || this->next_chunk_ >= this->n_chunks_)
+                {
+                    return;
+                }
+
+                auto const chunk_idx = this->next_chunk_++;
+                lock.unlock();
+
+                auto nodes = std::vector<PrintingNode>{};
+                auto error = std::exception_ptr{};
+                try
+                {
+                    nodes = this->format_chunk_(chunk_idx);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                lock.lock();
+                if (error)
+                {
+                    this->error_ = error;
+                }
+                else
+                {
+                    this->slots_[chunk_idx % this->window_] = std::move(nodes);
+                    this->is_ready_[chunk_idx % this->window_] = true;
+                }
+                lock.unlock();
+                this->condition_.notify_all();
+            }
+        }
+
+        size_t n_chunks_;
+        size_t window_;
+        std::function<std::vector<PrintingNode>(size_t)> format_chunk_;
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::vector<std::vector<PrintingNode>> slots_;
+        std::vector<bool> is_ready_;
+        size_t next_chunk_ = 0;
+        size_t n_taken_ = 0;
+        std::exception_ptr error_;
+        bool is_stopped_ = false;
+
+        // The submitted workers not yet finished.
+        size_t n_workers_ = 0;
     };
 
-} namespace icecream { namespace detail {
+    // Prints the elements of a random access range having `size` elements, splitting them
+    // in chunks formatted by the WorkerPool threads, while this thread joins them in order.
+    // Returns false if the range can't be printed this way.
+    template <typename R>
+    auto print_range_parallel(
+        R& range,
+        size_t size,
+        StringView elements_fmt,
+        Config_ const& config,
+        RangeChildren& children
+    ) -> typename std::enable_if<is_parallel_printable<R>::value, bool>::type
+    {
+        // The output budget is shared by all the printed nodes, in the order they are
+        // printed, which can't be kept when formatting them concurrently. A nested range
+        // within a range already being formatted in parallel won't launch more threads.
+        if (OutputBudget::is_limited() || ParallelPrinting::is_active())
+        {
+            return false;
+        }
+
+        using Difference = typename std::iterator_traits<get_iterator_t<R>>::difference_type;
+        constexpr auto chunk_size = size_t{1} << 14;
+
+        auto& pool = WorkerPool::global();
+        if (pool.size() == 0)
+        {
+            return false;
+        }
+
+        auto const n_elements = size < children.max_elements() ? size : children.max_elements();
+        auto const n_chunks = (n_elements + chunk_size - 1) / chunk_size;
+        auto const first = begin(range);
 
-  #endif  // defined(ICECREAM_STL_FORMAT_RANGES)
+        ChunkWorkers workers(
+            n_chunks,
+            2 * pool.size(),
+            [&](size_t chunk_idx) -> std::vector<PrintingNode>
+            {
+                auto const chunk_begin = chunk_idx * chunk_size;
+                auto const chunk_end =
+                    n_elements - chunk_begin > chunk_size ? chunk_begin + chunk_size : n_elements;
 
-  #if defined(ICECREAM_STL_FORMAT)
-    template <typename T, typename = void>
-    struct has_hijacked_tag : std::false_type {};
+                auto chunk_children = RangeChildren(std::numeric_limits<size_t>::max());
+                auto it = first + static_cast<Difference>(chunk_begin);
+                for (auto i = chunk_begin; i < chunk_end; ++i, ++it)
+                {
+                    chunk_children.push(*it, elements_fmt, config);
+                }
+                return chunk_children.release();
+            }
+        );
 
-    template <typename T>
-    struct has_hijacked_tag<
-        T,
-        typename std::enable_if<
-            !std::is_void<typename std::formatter<remove_cvref_t<T>>::Hijacked>::value
-        >::type
-    > : std::true_type {};
+        workers.launch(pool, NestingLevel::current());
 
-    // Print any class that specializes std::formatter<T, char>
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) ->
-        typename std::enable_if<
-            is_stl_formattable<T>::value
-            && !is_fmt_formattable<T>::value
-            && !bypass_baseline_printing<T>::value
-            , PrintingNode
-        >::type
-    {
-        if (config.force_range_strategy() && has_hijacked_tag<T>::value)
-        {
-            return do_print_range(std::forward<T>(value), fmt, config);
-        }
-        else if (config.force_tuple_strategy() && is_tuple<remove_cvref_t<T>>::value)
+        for (auto chunk_idx = size_t{0}; chunk_idx < n_chunks; ++chunk_idx)
         {
-            return do_print_tuple(std::forward<T>(value), fmt, config);
+            for (auto& node : workers.take(chunk_idx))
+            {
+                children.push_node(std::move(node));
+            }
         }
-        else if (config.force_variant_strategy() && is_variant<remove_ref_t< T>>::value)
+
+        if (n_elements < size)
         {
-            return do_print_variant(std::forward<T>(value), fmt, config);
+            children.push_marker("..., <" + std::to_string(size - n_elements) + " more>");
         }
 
-        try
+        return true;
+    }
+  #endif  // defined(ICECREAM_PARALLEL)
+
+    // Writes the two lowercase hexadecimal digits of `byte` at `out`.
+    inline auto write_hex_byte(unsigned char byte, char* out) -> void
+    {
+        static char const digits[] = "0123456789abcdef";
+        out[0] = digits[byte >> 4];
+        out[1] = digits[byte & 0x0F];
+    }
+
+    // Builds a row of a hex formatted range, with the `n_bytes` bytes at `bytes`. A dump row
+    // has also the `offset` of its first byte and the printable ASCII characters, laid out
+    // as the `hexdump -C` command does.
+    inline auto build_hex_row(
+        unsigned char const* bytes, size_t n_bytes, size_t offset, bool is_dump
+    ) -> PrintingNode
+    {
+        constexpr auto row_size = size_t{16};
+
+        if (!is_dump)
         {
-            return PrintingNode(
-                std::vformat("{:" + fmt.to_string() + "}", std::make_format_args(value))
-            );
+            char row[row_size * 3];
+            for (auto i = size_t{0}; i < n_bytes; ++i)
+            {
+                write_hex_byte(bytes[i], row + 3 * i);
+                row[3 * i + 2] = ' ';
+            }
+            return PrintingNode(StringView(row, 3 * n_bytes - 1));
         }
-        catch (std::format_error const&)
+
+        // At least 8 digits to the offset, but as many as needed by its value.
+        auto n_offset_digits = size_t{8};
+        while (n_offset_digits < 2 * sizeof(size_t) && (offset >> (4 * n_offset_digits)) != 0)
         {
-            return PrintingNode("*Error* in formatting string");
+            n_offset_digits += 2;
         }
-    }
-  #endif // defined(ICECREAM_STL_FORMAT)
 
-  #if defined(ICECREAM_FMT_ENABLED)
-    // Print any class that specializes fmt::formatter<T, char>
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) ->
-        typename std::enable_if<
-            is_fmt_formattable<T>::value
-            && !bypass_baseline_printing<T>::value
-            , PrintingNode
-        >::type
-    {
-        if (config.force_range_strategy() && is_range<remove_cvref_t<T>>::value)
+        char row[2 * sizeof(size_t) + 2 + row_size * 3 + 1 + 2 + row_size + 1];
+        auto out = row;
+        for (auto i = n_offset_digits; i > 0; i -= 2, out += 2)
         {
-            return do_print_range(std::forward<T>(value), fmt, config);
+            write_hex_byte(static_cast<unsigned char>(offset >> (4 * (i - 2))), out);
         }
-        else if (config.force_tuple_strategy() && is_tuple<remove_cvref_t<T>>::value)
+        *out++ = ' ';
+
+        for (auto i = size_t{0}; i < row_size; ++i, out += 3)
         {
-            return do_print_tuple(std::forward<T>(value), fmt, config);
+            if (i == row_size / 2)
+            {
+                *out++ = ' ';
+            }
+
+            if (i < n_bytes)
+            {
+                write_hex_byte(bytes[i], out + 1);
+            }
+            else
+            {
+                out[1] = ' ';
+                out[2] = ' ';
+            }
+            out[0] = ' ';
         }
-        else if (config.force_variant_strategy() && is_variant<remove_cvref_t< T>>::value)
+
+        *out++ = ' ';
+        *out++ = ' ';
+        *out++ = '|';
+        for (auto i = size_t{0}; i < n_bytes; ++i)
         {
-            return do_print_variant(std::forward<T>(value), fmt, config);
+            *out++ = bytes[i] >= 0x20 && bytes[i] < 0x7F ? static_cast<char>(bytes[i]) : '.';
         }
+        *out++ = '|';
 
-        return PrintingNode(
-            fmt::vformat("{:" + fmt.to_string() + "}", fmt::make_format_args(value))
-        );
+        return PrintingNode(StringView(row, static_cast<size_t>(out - row)));
     }
-  #endif
 
-    // Prints all characters encoded in "execution encoding"
-    template <char Quote>
-    auto print_text(
-        StringView code_units, Config_ const&, std::ostringstream& ostrm
-    ) -> void
+    // Prints the bytes of a range in hexadecimal, sixteen per row. They are bounded by the
+    // `max_range_elements` and `max_output_bytes` limits.
+    template <typename R>
+    auto print_hex_range(
+        R&& range, bool is_dump, Config_ const& config
+    ) -> typename std::enable_if<
+        is_byte<remove_cvref_t<get_reference_t<get_iterator_t<R>>>>::value, PrintingNode
+    >::type
     {
-        switch (getOstreamTypeMode(ostrm))
-        {
-        case OstreamTypeMode::character:
-        case OstreamTypeMode::string:
-            ostrm << code_units.to_string();
-            break;
+        constexpr auto row_size = size_t{16};
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::debug:
-            for (auto cu : code_units)
+        auto const max_bytes = config.max_range_elements();
+        auto rows = std::vector<PrintingNode>{};
+        unsigned char row[row_size];
+        auto n_row_bytes = size_t{0};
+        auto offset = size_t{0};
+
+        auto it = begin(range);
+        auto const end_it = end(range);
+        for (; it != end_it && offset + n_row_bytes < max_bytes; ++it)
+        {
+            row[n_row_bytes++] = static_cast<unsigned char>(*it);
+            if (n_row_bytes == row_size)
             {
-                switch (cu)
+                rows.push_back(build_hex_row(row, n_row_bytes, offset, is_dump));
+                offset += n_row_bytes;
+                n_row_bytes = 0;
+
+                if (OutputBudget::is_exhausted())
                 {
-                case '\a':
-                    ostrm << "\\a";
-                    break;
-                case '\b':
-                    ostrm << "\\b";
-                    break;
-                case '\t':
-                    ostrm << "\\t";
-                    break;
-                case '\n':
-                    ostrm << "\\n";
-                    break;
-                case '\v':
-                    ostrm << "\\v";
                     break;
-                case '\f':
-                    ostrm << "\\f";
-                    break;
-                case '\r':
-                    ostrm << "\\r";
-                    break;
-                case '\0':
-                    ostrm << "\\u{0}";
-                    break;
-                case Quote:
-                    ostrm << "\\" << Quote;
-                    break;
-                default:
-                    ostrm << cu;
                 }
             }
-            break;
+        }
 
-        case OstreamTypeMode::binary:
-        case OstreamTypeMode::BINARY:
-        case OstreamTypeMode::non_binary_integer:
-        default:
-            ICECREAM_UNREACHABLE;
+        if (n_row_bytes > 0)
+        {
+            rows.push_back(build_hex_row(row, n_row_bytes, offset, is_dump));
+        }
 
+        if (it != end_it)
+        {
+            rows.push_back(PrintingNode("..."));
         }
+
+        return PrintingNode("[", " ", "]", std::move(rows));
     }
 
-    // Prints char32_t characters
-    template <char quote>
-    auto print_text(
-        U32StringView code_units, Config_ const& config, std::ostringstream& ostrm
-    ) -> void
+    template <typename R>
+    auto print_hex_range(
+        R&&, bool, Config_ const&
+    ) -> typename std::enable_if<
+        !is_byte<remove_cvref_t<get_reference_t<get_iterator_t<R>>>>::value, PrintingNode
+    >::type
     {
-        switch (getOstreamTypeMode(ostrm))
-        {
-        case OstreamTypeMode::character:
-        case OstreamTypeMode::string:
-            ostrm << config.transcode_unicode(code_units);
-            break;
+        return PrintingNode("<this range doesn't support hex formatting>");
+    }
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::debug:
-            for (auto cu : code_units)
+    // Visitor of the SliceFunctor built to a range of bools, pushing the yielded elements
+    // to a BitsRenderer.
+    struct BitsRangePrinter
+    {
+        BitsRenderer& renderer;
+        bool& is_truncated;
+
+        template <typename F>
+        auto operator()(F slice_functor) -> void
+        {
+            auto mb_element = slice_functor();
+            while (mb_element)
             {
-                if (is_code_point_valid(cu))
-                {
-                    print_text<quote>(
-                        config.transcode_unicode(U32StringView(&cu, 1)), config, ostrm
-                    );
-                }
-                else
+                if (this->renderer.is_full())
                 {
-                    ostrm << "\\x{"
-                          << std::hex
-                          << std::nouppercase
-                          << std::char_traits<char32_t>::to_int_type(cu)
-                          << "}";
+                    this->is_truncated = true;
+                    break;
                 }
+
+                this->renderer.push(static_cast<bool>(*mb_element));
+                mb_element = slice_functor();
             }
-            break;
+        }
+    };
 
-        case OstreamTypeMode::binary:
-        case OstreamTypeMode::BINARY:
-        case OstreamTypeMode::non_binary_integer:
-        default:
-            ICECREAM_UNREACHABLE;
+    // Prints a range of bools in one of the BitsFormat forms. If `is_msb_first`, the `bits`
+    // form is printed as a binary number, as described at BitsRenderer.
+    template <typename R>
+    auto print_bits_range(
+        R&& range, BitsFormat const& format, bool is_msb_first, Config_ const& config
+    ) -> typename std::enable_if<is_bool_range<R>::value, PrintingNode>::type
+    {
+        auto const mb_slice = Slice::build(format.slicing);
+        if (!mb_slice)
+        {
+            return PrintingNode("<invalid range slicing>");
+        }
+
+        auto renderer = BitsRenderer(format.mode, config.max_range_elements(), is_msb_first);
+        auto is_truncated = false;
+        auto const mb_error =
+            visit_slice_functor(range, *mb_slice, BitsRangePrinter{renderer, is_truncated});
+        if (mb_error)
+        {
+            return PrintingNode(*mb_error);
         }
+
+        return renderer.build(
+            format.slicing.empty() ? "[" : format.slicing.to_string() + "->[", is_truncated
+        );
     }
 
-    // Prints char8_t and char16_t characters
-    template <char quote, typename CharT>
-    auto print_text(
-        BasicStringView<CharT> code_units, Config_ const& config, std::ostringstream& ostrm
-    ) -> void
+    template <typename R>
+    auto print_bits_range(
+        R&&, BitsFormat const&, bool, Config_ const&
+    ) -> typename std::enable_if<!is_bool_range<R>::value, PrintingNode>::type
     {
-        switch (getOstreamTypeMode(ostrm))
-        {
-        case OstreamTypeMode::character:
-        case OstreamTypeMode::string:
-            ostrm << config.transcode_unicode(to_utf32_u32string(code_units));
-            break;
+        return PrintingNode("<this range doesn't support bits formatting>");
+    }
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::debug:
-            while (!code_units.empty())
+    // Accumulates the summary statistics of a sequence of numbers in a single pass. The mean
+    // and the variance are updated by the Welford's algorithm, which keeps them accurate
+    // over long sequences. NaN values are left out of all the statistics but the counts, and
+    // the infinite values are left out of the mean and the standard deviation.
+    template <typename T>
+    class RangeStats
+    {
+    public:
+        // The `slicing` selecting the values, if any, is printed before the statistics.
+        explicit RangeStats(std::string slicing)
+            : slicing_(std::move(slicing))
+            , count_(0)
+            , n_values_(0)
+            , n_finite_(0)
+            , min_()
+            , max_()
+            , mean_(0.0)
+            , m2_(0.0)
+        {}
+
+        auto push(T value) -> void
+        {
+            ++this->count_;
+            if (std::isnan(value))
             {
-                auto result = Variant<char32_t, CharT>{};
-                std::tie(code_units, result) = to_codepoint(code_units);
+                return;
+            }
 
-                if (result.index() == 0)
-                {
-                    print_text<quote>(
-                        U32StringView(&get<char32_t>(result), 1), config, ostrm
-                    );
-                }
-                else
-                {
-                    ostrm << "\\x{"
-                          << std::hex
-                          << std::nouppercase
-                          << std::char_traits<CharT>::to_int_type(get<CharT>(result))
-                          << "}";
-                }
+            if (this->n_values_ == 0 || value < this->min_)
+            {
+                this->min_ = value;
             }
-            break;
+            if (this->n_values_ == 0 || this->max_ < value)
+            {
+                this->max_ = value;
+            }
+            ++this->n_values_;
 
-        case OstreamTypeMode::binary:
-        case OstreamTypeMode::BINARY:
-        case OstreamTypeMode::non_binary_integer:
-        default:
-            ICECREAM_UNREACHABLE;
+            if (std::isinf(value))
+            {
+                return;
+            }
+
+            ++this->n_finite_;
+            auto const x = static_cast<double>(value);
+            auto const delta = x - this->mean_;
+            this->mean_ += delta / static_cast<double>(this->n_finite_);
+            this->m2_ += delta * (x - this->mean_);
         }
-    }
 
-    // Prints wchar_t characters
-    template <char quote>
-    auto print_text(
-        WStringView code_units, Config_ const& config, std::ostringstream& ostrm
-    ) -> void
-    {
-        switch (getOstreamTypeMode(ostrm))
+        // The `fmt` string formats the min and max values, and, with floating point values,
+        // the mean and standard deviation too.
+        auto build(StringView fmt, Config_ const& config) const -> PrintingNode
         {
-        case OstreamTypeMode::character:
-        case OstreamTypeMode::string:
-            ostrm << config.transcode_wide_string(code_units);
-            break;
+            auto children = std::vector<PrintingNode>{};
+            children.push_back(PrintingNode("count: " + std::to_string(this->count_)));
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::debug:
-            print_text<quote>(config.transcode_wide_string(code_units), config, ostrm);
-            break;
+            if (this->n_values_ > 0)
+            {
+                children.push_back(
+                    make_labeled_node("min: ", make_printing_branch(this->min_, fmt, config))
+                );
+                children.push_back(
+                    make_labeled_node("max: ", make_printing_branch(this->max_, fmt, config))
+                );
+            }
 
-        case OstreamTypeMode::binary:
-        case OstreamTypeMode::BINARY:
-        case OstreamTypeMode::non_binary_integer:
-        default:
-            ICECREAM_UNREACHABLE;
+            if (this->n_finite_ > 0)
+            {
+                auto const real_fmt = std::is_floating_point<T>::value ? fmt : StringView{};
+                auto const stddev = std::sqrt(this->m2_ / static_cast<double>(this->n_finite_));
+                children.push_back(
+                    make_labeled_node(
+                        "mean: ", make_printing_branch(this->mean_, real_fmt, config)
+                    )
+                );
+                children.push_back(
+                    make_labeled_node(
+                        "stddev: ", make_printing_branch(stddev, real_fmt, config)
+                    )
+                );
+            }
+
+            if (std::is_floating_point<T>::value)
+            {
+                children.push_back(
+                    PrintingNode("nan: " + std::to_string(this->count_ - this->n_values_))
+                );
+                children.push_back(
+                    PrintingNode("inf: " + std::to_string(this->n_values_ - this->n_finite_))
+                );
+            }
+
+            auto const opening = this->slicing_.empty() ? "{" : this->slicing_ + "->{";
+            return PrintingNode(opening, ", ", "}", std::move(children));
         }
-    }
 
+    private:
+        std::string slicing_;
 
-    template <typename CharT>
-    auto do_print_string(
-        BasicStringView<CharT> value, Config_ const& config, std::ostringstream& ostrm
-    ) -> PrintingNode
-    {
-        switch (getOstreamTypeMode(ostrm))
-        {
-        case OstreamTypeMode::string:
-            print_text<'"'>(value, config, ostrm);
-            return PrintingNode(ostrm.str());
+        // The number of values, of not NaN values, and of finite values.
+        size_t count_;
+        size_t n_values_;
+        size_t n_finite_;
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::debug:
-            ostrm << '"';
-            print_text<'"'>(value, config, ostrm);
-            ostrm << '"';
-            return PrintingNode(ostrm.str());
+        T min_;
+        T max_;
+        double mean_;
 
-        case OstreamTypeMode::binary:
-        case OstreamTypeMode::BINARY:
-        case OstreamTypeMode::character:
-        case OstreamTypeMode::non_binary_integer:
-        default:
-            return PrintingNode("*Error* in formatting string");
-        }
-    }
+        // The sum of the squared differences from the mean.
+        double m2_;
+    };
 
-    // Print C string
     template <typename T>
     auto make_printing_branch(
         T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<is_c_string<remove_ref_t<T>>::value, PrintingNode>::type
+    ) -> typename std::enable_if<is_range_stats<remove_ref_t<T>>::value, PrintingNode>::type
     {
-        using CharT =
-            remove_cvref_t<
-                typename std::remove_pointer<
-                    typename std::decay<T>::type
-                >::type
-            >;
+        return value.build(fmt, config);
+    }
 
-        auto mb_ostrm = build_ostream(fmt);
-        if (!mb_ostrm)
+    // Visitor of the SliceFunctor built to a range of numbers, pushing the yielded elements
+    // to a RangeStats.
+    template <typename T>
+    struct StatsRangePusher
+    {
+        RangeStats<T>& stats;
+
+        template <typename F>
+        auto operator()(F slice_functor) -> void
         {
-            return PrintingNode("*Error* in formatting string");
+            auto mb_element = slice_functor();
+            while (mb_element)
+            {
+                this->stats.push(*mb_element);
+                mb_element = slice_functor();
+            }
         }
+    };
 
-        // If config.decay_char_array() is not true, any character array with a known size
-        // should be printed as a range
-        if (is_bounded_array<remove_ref_t<T>>::value && !config.decay_char_array())
+    // Prints the summary statistics of a range of numbers, instead of its elements.
+    template <typename R>
+    auto print_stats_range(
+        R&& range, StringView slicing, StringView elements_fmt, Config_ const& config
+    ) -> typename std::enable_if<
+        is_stats_number<get_reference_t<get_iterator_t<R>>>::value, PrintingNode
+    >::type
+    {
+        using T = remove_cvref_t<get_reference_t<get_iterator_t<R>>>;
+
+        auto const mb_slice = Slice::build(slicing);
+        if (!mb_slice)
         {
-            return do_print_range(std::forward<T>(value), fmt, config);
+            return PrintingNode("<invalid range slicing>");
         }
 
-        if (config.show_c_string())
+        auto stats = RangeStats<T>(slicing.to_string());
+        auto const mb_error = visit_slice_functor(range, *mb_slice, StatsRangePusher<T>{stats});
+        if (mb_error)
         {
-            do_print_string<CharT>(value, config, *mb_ostrm);
+            return PrintingNode(*mb_error);
         }
-        else
+
+        return stats.build(elements_fmt, config);
+    }
+
+    template <typename R>
+    auto print_stats_range(
+        R&&, StringView, StringView, Config_ const&
+    ) -> typename std::enable_if<
+        !is_stats_number<get_reference_t<get_iterator_t<R>>>::value, PrintingNode
+    >::type
+    {
+        return PrintingNode("<this range doesn't support stats formatting>");
+    }
+
+    // Visitor of the SliceFunctor built to a range, feeding its yielded elements to a Xxh64
+    // hasher. The elements hashable by their bytes are fed that way, and all the others by
+    // their formatting, each one followed by a null byte.
+    struct HashRangeFeeder
+    {
+        Xxh64& hasher;
+        size_t& size;
+        StringView elements_fmt;
+        Config_ const& config;
+
+        template <typename F>
+        auto operator()(F slice_functor) -> void
+        {
+            auto mb_element = slice_functor();
+            while (mb_element)
+            {
+                this->feed(*mb_element);
+                ++this->size;
+                mb_element = slice_functor();
+            }
+        }
+
+        template <typename E>
+        auto feed(E const& element) ->
+            typename std::enable_if<is_hashable_by_bytes<E>::value>::type
         {
-            *mb_ostrm << reinterpret_cast<void const*>(value);
+            this->hasher.update(std::addressof(element), sizeof(E));
         }
 
-        return PrintingNode(mb_ostrm->str());
+        template <typename E>
+        auto feed(E&& element) ->
+            typename std::enable_if<!is_hashable_by_bytes<remove_cvref_t<E>>::value>::type
+        {
+            auto const text =
+                make_printing_branch(std::forward<E>(element), this->elements_fmt, this->config)
+                    .print();
+            this->hasher.update(text.c_str(), text.size() + 1);
+        }
+    };
+
+    // Hashes all the elements of a contiguous range at once. Returns false if the range
+    // isn't contiguous, or has elements not hashable by their bytes.
+    template <typename R>
+    auto hash_contiguous_range(R& range, Xxh64& hasher, size_t& size) ->
+        typename std::enable_if<
+            is_contiguous_range<R>::value
+            && is_hashable_by_bytes<remove_cvref_t<get_reference_t<get_iterator_t<R>>>>::value,
+            bool
+        >::type
+    {
+        size = static_cast<size_t>(range.size());
+        hasher.update(range.data(), size * sizeof(*range.data()));
+        return true;
     }
 
-    // Print std::string and std::string_view
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) ->
+    template <typename R>
+    auto hash_contiguous_range(R&, Xxh64&, size_t&) ->
         typename std::enable_if<
-            is_std_string<remove_ref_t<T>>::value || is_string_view<remove_ref_t<T>>::value,
-            PrintingNode
+            !is_contiguous_range<R>::value
+            || !is_hashable_by_bytes<remove_cvref_t<get_reference_t<get_iterator_t<R>>>>::value,
+            bool
         >::type
     {
-        using CharT = typename remove_ref_t<T>::value_type;
+        return false;
+    }
 
-        auto mb_ostrm = build_ostream(fmt);
-        if (!mb_ostrm)
+    // Prints the number of elements and the hash of a range, instead of its elements.
+    template <typename R>
+    auto print_hash_range(
+        R&& range, StringView slicing, StringView elements_fmt, Config_ const& config
+    ) -> PrintingNode
+    {
+        auto const mb_slice = Slice::build(slicing);
+        if (!mb_slice)
         {
-            return PrintingNode("*Error* in formatting string");
+            return PrintingNode("<invalid range slicing>");
         }
 
-        return do_print_string<CharT>(value, config, *mb_ostrm);
+        auto hasher = Xxh64{};
+        auto size = size_t{0};
+        {
+            // The formatting of the hashed elements is never printed, so it shouldn't use
+            // the output budget. The enclosing level keeps the elements from being streamed.
+            OutputBudget const budget(std::numeric_limits<size_t>::max());
+            NestingLevel const nesting_level;
+
+            if (!slicing.empty() || !hash_contiguous_range(range, hasher, size))
+            {
+                auto const mb_error = visit_slice_functor(
+                    range, *mb_slice, HashRangeFeeder{hasher, size, elements_fmt, config}
+                );
+                if (mb_error)
+                {
+                    return PrintingNode(*mb_error);
+                }
+            }
+        }
+
+        auto node = make_hash_node(size, hasher.digest());
+        return slicing.empty() ?
+            std::move(node)
+            : make_labeled_node(slicing.to_string() + "->", std::move(node));
     }
 
-    template <typename T>
-    auto do_print_char(T value, Config_ const& config, std::ostringstream& ostrm) -> PrintingNode
+    // Visitor of the SliceFunctor built to a range of numbers, printing the position in the
+    // source range and the value of each one of the yielded elements that isn't zero.
+    struct NonzeroRangePrinter
     {
-        using CharT = remove_cvref_t<T>;
+        StringView elements_fmt;
+        Config_ const& config;
+        RangeChildren& children;
 
-        switch (getOstreamTypeMode(ostrm))
+        template <typename F>
+        auto operator()(F slice_functor) -> void
         {
-        case OstreamTypeMode::character:
-            print_text<'\''>(BasicStringView<CharT>(&value, 1), config, ostrm);
-            return PrintingNode(ostrm.str());
+            auto mb_element = slice_functor();
+            while (mb_element && this->push(slice_functor.index(), *mb_element))
+            {
+                mb_element = slice_functor();
+            }
+        }
 
-        case OstreamTypeMode::none:
-        case OstreamTypeMode::debug:
-            ostrm << '\'';
-            print_text<'\''>(BasicStringView<CharT>(&value, 1), config, ostrm);
-            ostrm << '\'';
-            return PrintingNode(ostrm.str());
+        // Returns false if no more elements should be pushed.
+        template <typename E>
+        auto push(size_t idx, E&& element) -> bool
+        {
+            if (element == 0)
+            {
+                return true;
+            }
 
-        case OstreamTypeMode::non_binary_integer:
-        case OstreamTypeMode::binary:
-        case OstreamTypeMode::BINARY:
-            return do_print_integral(std::char_traits<CharT>::to_int_type(value), config, ostrm);
+            if (this->children.is_full())
+            {
+                this->children.push_marker("...");
+                return false;
+            }
 
-        case OstreamTypeMode::string:
-        default:
-            return PrintingNode("*Error* in formatting string");
+            this->children.push_labeled(
+                std::to_string(idx) + ": ",
+                std::forward<E>(element),
+                this->elements_fmt,
+                this->config
+            );
+            return true;
         }
-    }
+    };
 
-    // Print character
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<
-            is_character<remove_ref_t<T>>::value, PrintingNode
-        >::type
+    // Prints the non-zero elements of a range of numbers, each one after its position.
+    template <typename R>
+    auto print_nonzero_range(
+        R&& range, StringView slicing, StringView elements_fmt, Config_ const& config
+    ) -> typename std::enable_if<is_nonzero_range<R>::value, PrintingNode>::type
     {
-        auto mb_ostrm = build_ostream(fmt);
-        if (!mb_ostrm)
+        auto const mb_slice = Slice::build(slicing);
+        if (!mb_slice)
         {
-            return PrintingNode("*Error* in formatting string");
+            return PrintingNode("<invalid range slicing>");
         }
 
-        return do_print_char(value, config, *mb_ostrm);
+        auto children = RangeChildren(config.max_range_elements());
+        auto printer = NonzeroRangePrinter{elements_fmt, config, children};
+
+        // Without a slicing, the range is scanned directly, since most of its elements are
+        // expected to be zeros.
+        if (slicing.empty())
+        {
+            auto idx = size_t{0};
+            auto const last = end(range);
+            for (auto it = begin(range); it != last && printer.push(idx, *it); ++it)
+            {
+                ++idx;
+            }
+        }
+        else
+        {
+            auto const mb_error = visit_slice_functor(range, *mb_slice, printer);
+            if (mb_error)
+            {
+                return PrintingNode(*mb_error);
+            }
+        }
+
+        auto const opening = slicing.empty() ? "{" : slicing.to_string() + "->{";
+        return PrintingNode(opening, ", ", "}", children.release());
     }
 
-    // Print signed and unsigned char
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const&
-    ) -> typename std::enable_if<is_xsig_char<remove_ref_t<T>>::value, PrintingNode>::type
+    template <typename R>
+    auto print_nonzero_range(
+        R&&, StringView, StringView, Config_ const&
+    ) -> typename std::enable_if<!is_nonzero_range<R>::value, PrintingNode>::type
     {
-        using T0 =
-            typename std::conditional<
-                std::is_signed<T>::value, int, unsigned int
-            >::type;
+        return PrintingNode("<this range doesn't support nonzero formatting>");
+    }
 
-        auto mb_ostrm = build_ostream(fmt);
-        if (!mb_ostrm)
+    // Visitor of the SliceFunctor built to a range, printing the elements yielded by it.
+    template <typename R>
+    struct RangeElementsPrinter
+    {
+        R& range;
+
+        // The number of elements in the range, if it is known and the whole of it is
+        // being printed.
+        Optional<size_t> mb_size;
+
+        size_t edge_items;
+        StringView elements_fmt;
+        Config_ const& config;
+        RangeChildren& children;
+
+        template <typename F>
+        auto operator()(F slice_functor) -> void
         {
-            return PrintingNode("*Error* in formatting string");
-        }
+            // The number of sliced elements, computed in constant time if the range is
+            // random access.
+            auto const mb_slice_size = this->mb_size ? this->mb_size : slice_functor.size();
+            auto const edge_counts = get_edge_counts(
+                this->edge_items, this->children.max_elements() - this->children.n_elements()
+            );
 
-        *mb_ostrm << static_cast<T0>(value);
-        return PrintingNode(mb_ostrm->str());
-    }
+            if (
+                this->edge_items > 0
+                && mb_slice_size
+                && *mb_slice_size > edge_counts.first + edge_counts.second
+            ) {
+                print_range_edges(
+                    slice_functor,
+                    *mb_slice_size,
+                    edge_counts,
+                    this->elements_fmt,
+                    this->config,
+                    this->children
+                );
+            }
+            else if (this->edge_items > 0 && !mb_slice_size)
+            {
+                print_range_edges_single_pass(
+                    slice_functor, this->edge_items, this->elements_fmt, this->config, this->children
+                );
+            }
+            else if (
+                this->mb_size
+                && *this->mb_size >= this->config.parallel_range_threshold()
+                && print_range_parallel(
+                    this->range, *this->mb_size, this->elements_fmt, this->config, this->children
+                )
+            ) {
+                return;
+            }
+            else
+            {
+                if (this->mb_size)
+                {
+                    this->children.reserve(*this->mb_size);
+                }
+
+                auto mb_element = slice_functor();
+                while (mb_element)
+                {
+                    if (this->children.is_full())
+                    {
+                        this->children.push_marker(
+                            this->mb_size ?
+                                make_elision_marker(
+                                    *this->mb_size - this->children.n_elements()
+                                )
+                                : std::string{"..."}
+                        );
+                        break;
+                    }
+
+                    this->children.push(*mb_element, this->elements_fmt, this->config);
+                    mb_element = slice_functor();
+                }
+            }
+        }
+    };
 
-    // Print smart pointers without an operator<<(ostream&) overload.
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<
-        // On C++20 unique_ptr will have a << overload.
-        is_unstreamable_ptr<remove_ref_t<T>>::value && !is_baseline_printable<T>::value,
-        PrintingNode
-    >::type
-    {
-        return make_printing_branch(
-            reinterpret_cast<void const*>(value.get()), fmt, config
-        );
-    }
+    // --------------------------------------------------
 
-    // Print weak pointer classes
     template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<is_weak_ptr<remove_ref_t<T>>::value, PrintingNode>::type
+    auto do_print_range(
+        T&&, StringView, Config_ const&
+    ) -> typename std::enable_if<!is_range<T>::value, PrintingNode>::type
     {
-        return value.expired() ?
-            PrintingNode("expired") : make_printing_branch(value.lock(), fmt, config);
+        ICECREAM_UNREACHABLE;
+        return PrintingNode("");
     }
 
-  #if defined(ICECREAM_OPTIONAL_HEADER)
-    // Print std::optional<> classes
     template <typename T>
-    auto make_printing_branch(
+    auto do_print_range(
         T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<
-        is_optional<remove_ref_t<T>>::value && !is_baseline_printable<T>::value,
-        PrintingNode
-    >::type
+    ) -> typename std::enable_if<is_range<T>::value , PrintingNode>::type
     {
-        auto container_fmt = StringView{};
-        auto element_fmt = StringView{};
+        auto range_fmt = StringView{};
+        auto elements_fmt = StringView{};
+        std::tie(range_fmt, elements_fmt) = split_range_fmt_string(fmt);
 
-        auto const cut_idx = fmt.find(":");
-        if (cut_idx != StringView::npos)
+        if (range_fmt == "hex" || range_fmt == "hexdump")
         {
-            auto const fmt_parts = split(fmt, std::vector<size_t>{cut_idx});
-            container_fmt = fmt_parts[0];
-            element_fmt = fmt_parts[1];
+            return print_hex_range(std::forward<T>(value), range_fmt == "hexdump", config);
         }
-        else
+
+        auto const mb_bits_format = BitsFormat::build(range_fmt);
+        if (mb_bits_format)
         {
-            container_fmt = fmt;
+            return print_bits_range(std::forward<T>(value), *mb_bits_format, false, config);
         }
 
-        // std::optional hasn't any container formatting string
-        if (!container_fmt.empty())
+        auto const mb_stats_slicing = split_range_fmt_keyword(range_fmt, "stats");
+        if (mb_stats_slicing)
         {
-            return PrintingNode("*Error* in formatting string");
+            return print_stats_range(
+                std::forward<T>(value), *mb_stats_slicing, elements_fmt, config
+            );
         }
 
-        return value.has_value() ?
-            make_printing_branch(*value, element_fmt, config) : PrintingNode("nullopt");
-    }
-  #endif
+        auto const mb_nonzero_slicing = split_range_fmt_keyword(range_fmt, "nonzero");
+        if (mb_nonzero_slicing)
+        {
+            return print_nonzero_range(
+                std::forward<T>(value), *mb_nonzero_slicing, elements_fmt, config
+            );
+        }
 
-    template <typename Variant>
-    struct Visitor
-    {
-        Visitor(Variant const& variant, StringView fmt, Config_ const& config)
-            : variant_(variant)
-            , elements_fmt(
-                [&]() -> std::vector<StringView>
-                {
-                    if (fmt.empty())
-                    {
-                        // No element specifications is equivalent to all them having an empty string
-                        return std::vector<StringView>(variant_size<Variant>::value, StringView{});
-                    }
+        auto const mb_hash_slicing = split_range_fmt_keyword(range_fmt, "hash");
+        if (mb_hash_slicing)
+        {
+            return print_hash_range(
+                std::forward<T>(value), *mb_hash_slicing, elements_fmt, config
+            );
+        }
 
-                    auto const sep = fmt[0];
-                    fmt.remove_prefix(1);
-                    return split(fmt, sep);
-                }()
-            )
-            , config_(config)
-        {}
+        auto const is_key_slicing = !range_fmt.empty() && range_fmt.front() == '{';
+        auto const mb_slice = is_key_slicing ? Optional<Slice>{} : Slice::build(range_fmt);
+        auto const mb_key_slice =
+            is_key_slicing ? KeySlice::build(range_fmt) : Optional<KeySlice>{};
+        if (!mb_slice && !mb_key_slice)
+        {
+            return PrintingNode("<invalid range slicing>");
+        }
 
-        template <typename T>
-        auto operator()(T const& arg) -> PrintingNode
+        auto const opening = range_fmt.empty() ? "[" : range_fmt.to_string() + "->[";
+
+        NestingLevel const nesting_level;
+        if (NestingLevel::current() > config.max_nesting_depth())
         {
-            if (this->elements_fmt.size() != variant_size<Variant>::value)
+            return PrintingNode(opening + "...]");
+        }
+
+        // The number of elements is known only when printing the whole of a sized range.
+        // Otherwise, counting them could take an unbounded time.
+        auto const mb_size = range_fmt.empty() ? maybe_get_size(value) : Optional<size_t>{};
+        auto children = RangeChildren(config.max_range_elements());
+
+        // Only the ranges at the top level of an IC call can be streamed.
+        if (NestingLevel::current() == 1)
+        {
+            auto const mb_range_size = maybe_get_size(value);
+            if (mb_range_size)
             {
-                return PrintingNode("*Error* in formatting string");
+                children.stream_to(RangeStreamer::find(*mb_range_size), opening);
             }
+        }
 
-            auto const fmt = this->elements_fmt.at(this->variant_.index());
-            return make_printing_branch(arg, fmt, this->config_);
+        auto printer = RangeElementsPrinter<remove_ref_t<T>>{
+            value, mb_size, config.range_edge_items(), elements_fmt, config, children
+        };
+        auto const mb_error =
+            mb_key_slice ?
+                visit_key_slice_functor(value, *mb_key_slice, printer)
+                : visit_slice_functor(value, *mb_slice, printer);
+
+        if (mb_error)
+        {
+            return PrintingNode(*mb_error);
         }
 
-        Variant const& variant_;
-        std::vector<StringView> elements_fmt;
-        Config_ const& config_;
-    };
+        // A placeholder node, since the range was already written.
+        if (children.is_streamed())
+        {
+            children.release();
+            return PrintingNode("");
+        }
 
-    template <typename T>
-    auto do_print_variant(
-        T&&, StringView, Config_ const&
-    ) -> typename std::enable_if<!is_variant<remove_ref_t<T>>::value, PrintingNode>::type
-    {
-        ICECREAM_UNREACHABLE;
-        return PrintingNode("");
+        return PrintingNode(opening, ", ", "]", children.release());
     }
 
+    // Print all elements of a range
     template <typename T>
-    auto do_print_variant(
+    auto make_printing_branch(
         T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<is_variant<remove_ref_t<T>>::value, PrintingNode>::type
+    ) -> typename std::enable_if<
+        (
+            is_range<T>::value                      // it is range
+            && !is_baseline_printable<T>::value     // but it is not printable by baseline strategies
+            && !bypass_baseline_printing<T>::value  // and it hasn't its own strategy
+         ) || (
+            // Except by arrays of anything other than character, which are baseline
+            // printable, but should be printed by this strategy instead.
+            std::is_array<remove_ref_t<T>>::value
+            && !is_c_string<remove_ref_t<T>>::value
+        )
+        , PrintingNode
+    >::type
     {
-        return visit(Visitor<remove_cvref_t<T>>(value, fmt, config), value);
+        return do_print_range(std::forward<T>(value), fmt, config);
     }
 
-    // Print *::variant<Ts...> classes
+    // ---------------------------------------------------------------------------------------------
+
+    // Print classes deriving from only std::exception and not from boost::exception
     template <typename T>
     auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
+        T&& value, StringView, Config_ const&
     ) -> typename std::enable_if<
-        is_variant<remove_ref_t<T>>::value && !is_baseline_printable<T>::value,
+        std::is_base_of<std::exception, remove_cvref_t<T>>::value
+        && !std::is_base_of<boost::exception, remove_cvref_t<T>>::value
+        && !is_baseline_printable<T>::value,
         PrintingNode
     >::type
     {
-        return do_print_variant(std::forward<T>(value), fmt, config);
-    }
-
-    template <size_t... N, typename T>
-    inline auto tuple_traverser(
-        int_sequence<N...>,
-        T const& t,
-        std::vector<StringView> const& fmt,
-        Config_ const& config
-    ) -> std::vector<PrintingNode>
-    {
-        auto result = std::vector<PrintingNode>{};
-
-        (void) std::initializer_list<int>{
-            (
-                result.push_back(
-                    make_printing_branch(std::get<N>(t), fmt[N], config)
-                ),
-                0
-            )...
-        };
-
-        return result;
+        return PrintingNode(value.what());
     }
 
+    // Print classes deriving from both std::exception and boost::exception
     template <typename T>
-    auto do_print_tuple(
-        T&&, StringView, Config_ const&
-    ) ->
-        typename std::enable_if<
-            !is_tuple<remove_cvref_t<T>>::value
-            , PrintingNode
-        >::type
+    auto make_printing_branch(
+        T&& value, StringView, Config_ const&
+    ) -> typename std::enable_if<
+        std::is_base_of<std::exception, remove_cvref_t<T>>::value
+        && std::is_base_of<boost::exception, remove_cvref_t<T>>::value
+        && !is_baseline_printable<T>::value,
+        PrintingNode
+    >::type
     {
-        ICECREAM_UNREACHABLE;
-        return PrintingNode("");
+        return PrintingNode(
+            value.what()
+            + std::string {"\n"}
+            + boost::exception_detail::diagnostic_information_impl(
+                  &value, &value, true, true
+            )
+        );
     }
 
+  #if defined(ICECREAM_DUMP_STRUCT_CLANG)
+    static auto ds_this = static_cast<PrintingNode*>(nullptr);
+    static auto ds_delayed_structs = std::vector<std::pair<std::string, std::function<void()>>>{};
+    static auto ds_fmt_ref = StringView{};
+    static auto ds_config_ref = static_cast<Config_ const*>(nullptr);
+    static auto ds_call_count = int{0};
+    template<typename... T> auto parse_dump_struct(char const* format, T&& ...args) -> int;
+
+    // Print classes using clang's __builtin_dump_struct (clang >= 15).
     template <typename T>
-    auto do_print_tuple(
+    auto make_printing_branch(
         T&& value, StringView fmt, Config_ const& config
-    ) ->
-        typename std::enable_if<
-            is_tuple<remove_cvref_t<T>>::value
-            , PrintingNode
-        >::type
+    ) -> typename std::enable_if<is_handled_by_clang_dump_struct<T>::value, PrintingNode>::type
     {
-        auto const tuple_size = std::tuple_size<remove_cvref_t<T>>::value;
+        // If this is the outermost class being printed
+        if (!ds_this)
+        {
+            auto branch_node = PrintingNode("");
 
-        auto opening = std::string{"("};
-        auto separator = std::string{", "};
-        auto closing = std::string{")"};
+            ds_this = &branch_node;  // Put `this` on scope to be assigned inside `parse_dump_struct`
+            ds_fmt_ref = fmt;
+            ds_config_ref = &config;
+            __builtin_dump_struct(&value, &parse_dump_struct);  // Print the outermost class
 
-        if (!fmt.empty() && fmt[0] == 'n')
-        {
-            opening = "";
-            separator = ", ";
-            closing = "";
-            fmt.remove_prefix(1);
-        }
-        else if (!fmt.empty() && fmt[0] == 'm')
-        {
-            if (tuple_size != 2)
+            // Loop on each class that is an internal attribute of the outermost class
+            while (!ds_delayed_structs.empty())
             {
-                return PrintingNode(
-                    "<*Error*: the `m` specifier is only valid for pairs or 2-tuples>"
-                );
+                auto const delayed_struct = ds_delayed_structs.back();
+                ds_delayed_structs.pop_back();
+
+                // Put that attribute class on scope to `parse_struct_dump`
+                ds_this = branch_node.find_leaf(delayed_struct.first);
+
+                if (ds_this == nullptr)
+                {
+                    std::cerr
+                        << "ICECREAM: Failure finding a child Tree, this should not have happened. "
+                        "Please report a bug on https://github.com/renatoGarcia/icecream-cpp/issues\n";
+                }
+
+                delayed_struct.second();  // Print the class
             }
-            opening = "";
-            separator = ": ";
-            closing = "";
-            fmt.remove_prefix(1);
+
+            ds_this = nullptr;
+            ds_call_count = 0;
+
+            return branch_node;
         }
 
-        auto const elements_fmt =
-            [&]() -> std::vector<StringView>
-            {
-                if (fmt.empty())
+        // Otherwise, the class at hand is an internal attribute from the outermost
+        // class. If this is the case, this present calling of Tree constructor is
+        // being made from inside a __builtin_dump_struct calling. So here we delay
+        // the calling of __builtin_dump_struct to avoid a reentrant function call.
+        else
+        {
+            auto const unique_id =
+                "icecream_415a8a88-aa51-44d5-8ccb-377d953413ef_" + std::to_string(ds_call_count);
+
+            ds_delayed_structs.emplace_back(
+                unique_id,
+                [&value]()
                 {
-                    // No element specifications is equivalent to all them having an empty string
-                    return std::vector<StringView>(tuple_size, StringView{});
+                    __builtin_dump_struct(&value, &parse_dump_struct);
                 }
+            );
+            ds_call_count += 1;
 
-                auto const sep = fmt[0];
-                fmt.remove_prefix(1);
-                return split(fmt, sep);
-            }();
+            // Return a placeholder node that will be replaced by the `if` above at the right time.
+            return PrintingNode(unique_id);
+        }
+    }
 
-        if (elements_fmt.size() != tuple_size)
+    // Receives an argument from parse_dump_struct and builds a Tree using it.
+    //
+    // When clang doesn't know how to format a value within __builtin_dump_struct, it will
+    // pass a pointer to that value instead of a reference. This function specialization
+    // will handle that scenario, as it specializes on pointers. However, to distinguish
+    // between actual pointer values and a "don't know how to format" value, the `deref`
+    // boolean is used.
+    template<typename T>
+    auto build_tree(bool deref, T* const& t) -> PrintingNode
+    {
+        if (deref)
         {
-            return PrintingNode(
-                "<*Error*: expected "
-                + std::to_string(tuple_size)
-                + " element formatting specifiers>"
-            );
+            return make_printing_branch(*t, ds_fmt_ref, *ds_config_ref);
+        }
+        else
+        {
+            return make_printing_branch(t, ds_fmt_ref, *ds_config_ref);
         }
-
-        return PrintingNode(
-            opening,
-            separator,
-            closing,
-            tuple_traverser(
-                make_int_sequence<tuple_size>(),
-                value,
-                elements_fmt,
-                config
-            )
-        );
     }
 
-    // Print tuple like classes
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<
-        is_tuple<remove_cvref_t<T>>::value && !is_baseline_printable<T>::value,
-        PrintingNode
-    >::type
+    // Receives an argument from parse_dump_struct and builds a Tree using it.
+    template<typename T>
+    auto build_tree(bool, T const& t) -> PrintingNode
     {
-        return do_print_tuple(std::forward<T>(value), fmt, config);
+        return make_printing_branch(t, ds_fmt_ref, *ds_config_ref);
     }
 
+    // Receives all the variadic inputs from parse_dump_struct and returns a pair with the
+    // argument name and its Tree representation.
+    // This overload accepts zero, one, or two values from the variadic inputs. It is
+    // here just so the code compiles and never will be called. When receiving these
+    // number of inputs an argument to be printed will never be among them.
+    inline auto build_name_tree_pair(
+        bool, std::string const& = "", std::string const& = ""
+    ) -> std::pair<std::string, PrintingNode>
+    {
+        ICECREAM_UNREACHABLE;
+        return std::pair<std::string, PrintingNode>("", PrintingNode(""));
+    }
 
-    // -------------------------------------------------- Range classes
+    // Receives all the variadic inputs from parse_dump_struct and returns a pair with the
+    // argument name and its Tree representation.
+    // This overload will be called when starting the printing of an argument that is
+    // itself a struct with other attributes. The empty `Tree` is a placeholder that will
+    // be replaced when the actual tree is built.
+    inline auto build_name_tree_pair(
+        bool, std::string const&, std::string const&, std::string const& arg_name
+    ) -> std::pair<std::string, PrintingNode>
+    {
+        return std::pair<std::string, PrintingNode>(arg_name, PrintingNode(""));
+    }
 
-    // Direct representation of a slicing string.
-    struct Slice
+    // Receives all the variadic inputs from parse_dump_struct and returns a pair with the
+    // argument name and its Tree representation.
+    template<typename T>
+    auto build_name_tree_pair(
+        bool deref,
+        std::string const&,
+        std::string const&,
+        std::string const& arg_name,
+        T const& value
+    ) -> std::pair<std::string, PrintingNode>
     {
-        Optional<ptrdiff_t> start;
-        Optional<ptrdiff_t> stop;
-        Optional<ptrdiff_t> step;
+        return std::pair<std::string, PrintingNode>(arg_name, build_tree(deref, value));
+    }
 
-        // Receives a slicing string, like "[:-2:2]" and returns an instance of `Slice`
-        // class that represents it. If the string is an invalid slicing, returns nothing.
-        static auto build(StringView fmt) -> Optional<Slice>
-        {
-            if (fmt.empty())
-            {
-                return Slice{{}, {}, {}};
-            }
+    // Each call to `parse_dump_struct` will deal with at most one attribute from the
+    // struct being printed. This `attributes_stack` will hold the pairs (argument name,
+    // Tree) constructed to each attribute until all of them are processed.
+    static auto attributes_stack = std::vector<std::vector<std::pair<std::string, PrintingNode>>>{};
 
-            // All iterable slicings must start with '[' and finish with ']'
-            if (fmt.front() != '[' || fmt.back() != ']')
+    // When printing the attributes of a base class (inheritance), Clang will open and
+    // close braces, similarly to when printing an attribute that is a struct
+    // (composition). It is possible distinguish the two cases when at opening, but they
+    // are identical when closing. This vector mark if the current context is inside an
+    // inheritance attributes or a composition attributes.
+    static auto is_inside_baseclass = std::vector<bool>{};
+
+    template<typename... T>
+    int parse_dump_struct(char const* format_, T&&... args)
+    {
+        // Removes any left and right white spaces
+        auto const trim =
+            [](std::string const& str) -> std::string
             {
-                return {};
-            }
+                auto const left = str.find_first_not_of(" \t\n");
+                if (left == std::string::npos) return "";
 
-            // Remove the opening '[' and the closing ']'
-            fmt.remove_prefix(1);
-            fmt.remove_suffix(1);
+                auto const right = str.find_last_not_of(" \t\n");
+                return str.substr(left, right-left+1);
+            };
 
-            // An empty '[]' slicing is invalid
-            if (fmt.empty())
+        // Check if the last format specifier, the one related to the value to be printed,
+        // means that clang doesn't know how to format that value.
+        auto const knows_how_to_format =
+            [](std::string const& str) -> bool
             {
-                return {};
-            }
+                auto const left = str.find_last_of(" \t");
+                return str.substr(left+1) != "*%p";
+            };
 
-            auto indexes = std::vector<Optional<ptrdiff_t>>{};
-            for (auto idx_string : split(fmt, ':'))
-            {
-                idx_string.trim();
+        auto const format = trim(format_);
 
-                if (idx_string.empty())
-                {
-                    indexes.push_back({});
-                    continue;
-                }
+        // When true, the next parse_dump_struct call will be the opening brace of a base
+        // class scope.
+        if (sizeof...(args) == 2)
+        {
+            is_inside_baseclass.push_back(true);
+        }
 
-                auto end = static_cast<char*>(nullptr);
-                auto const null_terminated = idx_string.to_string();
-                auto const lnum = strtol(null_terminated.data(), &end, 10);
-                if (
-                    // if idx_string in its whole isn't a number
-                    end != (null_terminated.data() + null_terminated.size())
+        // When true, the next parse_dump_struct call will be the opening brace of a scope
+        // printing the content of an atrribute that is a struct.
+        else if (sizeof...(args) == 3)
+        {
+            is_inside_baseclass.push_back(false);
 
-                    // or if there is an overflow on long int
-                    || (
-                        (
-                         lnum == std::numeric_limits<long>::max()
-                         || lnum == std::numeric_limits<long>::lowest()
-                        )
-                        && errno == ERANGE
-                    )
+            attributes_stack.back().push_back(
+                build_name_tree_pair(!knows_how_to_format(format), args...)
+            );
 
-                    // or if there is an overflow to convert from long to ptrdiff
-                    || (
-                        lnum > std::numeric_limits<ptrdiff_t>::max()
-                        || lnum < std::numeric_limits<ptrdiff_t>::lowest()
-                    )
-                ) {
-                    return {};
-                }
+            // The next attributes will be from this struct attribute being printed.
+            // Collect them all before merging on a Tree.
+            attributes_stack.emplace_back();
+        }
 
-                indexes.push_back(lnum);
-            }
+        // When true, it is printing an actual value. Like "int i = 7".
+        else if (sizeof...(args) == 4)
+        {
+            attributes_stack.back().push_back(
+                build_name_tree_pair(!knows_how_to_format(format), args...)
+            );
+        }
 
-            // If indexing an element ("[3]") instead of a proper slicing.
-            if (indexes.size() == 1 && indexes[0])
+        // The closing brace of a baseclass attributes section
+        else if (format.back() == '}' && is_inside_baseclass.back())
+        {
+            is_inside_baseclass.pop_back();
+        }
+
+        // The closing brace of either a struct attribute or the root struct being printed
+        else if (format.back() == '}')
+        {
+            is_inside_baseclass.pop_back();
+
+            auto top_atrributes = std::move(attributes_stack.back());
+            attributes_stack.pop_back();
+
+            auto children = std::vector<PrintingNode>{};
+            for (auto& att : top_atrributes)
             {
-                auto const idx = *indexes[0];
-                return Slice{idx, idx+1, {}};
+                auto t_pair = std::vector<PrintingNode>{};
+                t_pair.push_back(PrintingNode(std::get<0>(att)));
+                t_pair.push_back(std::move(std::get<1>(att)));
+
+                children.emplace_back("", ": ", "", std::move(t_pair));
             }
 
-            while (indexes.size() < 3)
+            auto built_tree = PrintingNode("{", ", ", "}", std::move(children));
+
+            if (attributes_stack.empty())
+            {
+                *ds_this = std::move(built_tree);
+            }
+            else
             {
-                indexes.push_back({});
+                std::get<1>(attributes_stack.back().back()) = std::move(built_tree);
             }
-
-            if (indexes.size() != 3) return {};
-
-            return Slice{indexes[0], indexes[1], indexes[2]};
         }
-    };
 
-    // Advances `it` for `n` steps. Will stop before advancing `n` steps if `sentinel` is
-    // reached. Returns the actual displacement.
-    template <typename I, typename S>
-    auto advance_it(I it, S const& sentinel, size_t n) -> I
-    {
-        auto offset = size_t{0};
-        while (it != sentinel && offset != n)
+        // The opening of the root struct being printed
+        else if (sizeof...(args) == 1)
         {
-            std::advance(it, 1);
-            offset += 1;
+            attributes_stack.emplace_back();
+            is_inside_baseclass.push_back(false);
         }
 
-        return it;
+        return 0;
     }
+  #endif  // ICECREAM_DUMP_STRUCT_CLANG
 
-    // A functor whose nullary function call operator will return an Optional element in
-    // the range [it, sentinel) spaced by `step`. After exhausting the range, any call
-    // will return an empty Optional.
-    template <typename I, typename S>
-    class SliceFunctorImpl
-    {
-    private:
-        I it_;
-        S sentinel_;
-        size_t step_;
 
-    public:
-        SliceFunctorImpl(I it, S sentinel, size_t step)
-            : it_(it)
-            , sentinel_(sentinel)
-            , step_(step)
-        {}
+    // -------------------------------------------------- is_printable
 
-        auto operator()() -> Optional<get_reference_t<I>>
-        {
-            if (this->it_ == this->sentinel_) return {};
+    template <typename T>
+    auto is_printable_impl(int) ->
+        decltype(
+            make_printing_branch(
+                std::declval<T&>(),
+                std::declval<StringView&>(),
+                std::declval<Config_ const&>()
+            ),
+            std::true_type{}
+        );
 
-            auto old_it = this->it_;
-            this->it_ = advance_it(this->it_, this->sentinel_, this->step_);
+    template <typename T>
+    auto is_printable_impl(...) -> std::false_type;
 
-            return {*old_it};
-        }
+    // Check if IceCream can print the type T.
+    template <typename T>
+    using is_printable = decltype(is_printable_impl<T>(0));
+
+
+    // -------------------------------------------------- Icecream
+
+    // Holds a pair of argument and formatting string. Created by the macro `IC_`.
+    template <typename T>
+    struct FormattingArgument
+    {
+        std::string fmt;
+        T&& value;
     };
 
-    template <typename R>
-    using SliceFunctor = std::function<Optional<get_reference_t<get_iterator_t<R>>>()>;
+    template <typename T>
+    struct formatting_argumet_type_impl {using type = T;};
+
+    template <typename T>
+    struct formatting_argumet_type_impl<FormattingArgument<T>&> {using type = T;};
+
+    template <typename T>
+    using formatting_argumet_type =
+        typename formatting_argumet_type_impl<T>::type;
 
-    template <typename R, typename I, typename S>
-    auto make_slice_functor(I iterator, S sentinel, size_t step) -> SliceFunctor<R>
+
+    // If the type has an overload of to_string, call it.
+    template <typename T>
+    auto call_to_string(T const& t) ->
+        typename std::enable_if<
+            has_to_string<T>::value,
+            std::string
+        >::type
     {
-        return SliceFunctorImpl<I, S>{iterator, sentinel, step};
+        return to_string(t);
     }
 
-    template <typename R>
-    auto build_slice_functor_p(
-        R&& range,
-        Optional<size_t> mb_start,
-        Optional<size_t> mb_stop,
-        size_t step
-    ) -> SliceFunctor<R>
+    // If the type is a string like, just return it.
+    template <typename T>
+    auto call_to_string(T const& t) ->
+        typename std::enable_if<
+            !has_to_string<T>::value
+            && (
+                is_character<remove_ref_t<T>>::value
+                || is_c_string<remove_ref_t<T>>::value
+                || is_std_string<remove_ref_t<T>>::value
+                || is_string_view<remove_ref_t<T>>::value
+            ),
+            std::string
+        >::type
     {
-        auto const start_it = mb_start ? advance_it(begin(range), end(range), *mb_start) : begin(range);
-
-        if (!mb_stop)
-        {
-            return make_slice_functor<R>(start_it, end(range), step);
-        }
-        else if (is_sized<R>::value)  // So it has a value and it is normalized
-        {
-            auto stop_it = begin(range);
-            std::advance(stop_it, static_cast<ptrdiff_t>(*mb_stop));
-            return make_slice_functor<R>(start_it, stop_it, step);
-        }
-        else
-        {
-            return make_slice_functor<R>(
-                start_it,
-                advance_it(begin(range), end(range), *mb_stop),
-                step
-            );
-        }
+        return t;
     }
 
-    template <typename R>
-    auto build_slice_functor_n(
-        R&& range,
-        Optional<size_t> mb_start,
-        Optional<size_t> mb_stop,
-        size_t step
-    ) ->
+    // Just to compile, should not be called.
+    template <typename T>
+    auto call_to_string(T const&) ->
         typename std::enable_if<
-            is_bidirectional_range<R>::value,
-            SliceFunctor<R>
+            !has_to_string<T>::value
+            && !(
+                is_character<remove_ref_t<T>>::value
+                || is_c_string<remove_ref_t<T>>::value
+                || is_std_string<remove_ref_t<T>>::value
+                || is_string_view<remove_ref_t<T>>::value
+            ),
+            std::string
         >::type
     {
-        auto make_reverse_iterator = [](get_iterator_t<R> it)
+        ICECREAM_UNREACHABLE;
+        return "";
+    }
+
+    // Would be better if this function could be on calling site as a lambda
+    // function, however older compilers (gcc<=9 and clang<=10 for example) fail
+    // to see a parameter pack expansion when inside of a lambda.
+    template <typename T>
+    auto concat_fmt(T const& t, std::string& fmt, size_t& i_arg, size_t n_args) -> void
+    {
+        ++i_arg;
+        if (i_arg < n_args)
         {
-            return std::reverse_iterator<get_iterator_t<R>>(it);
+            fmt += call_to_string(t);
+        }
+    }
+
+    // Returns a FormattingArgument where the value type is the same as the type
+    // of the last `args`, and the formatting string is the concatenation of all
+    // arguments except by the last.
+    template <typename... Ts>
+    auto make_formatting_argument(
+        Ts&&... args
+    ) -> FormattingArgument<typename std::tuple_element<sizeof...(Ts)-1, std::tuple<Ts&&...>>::type>
+    {
+        auto constexpr value_idx = sizeof...(Ts) - 1;
+        using T = typename std::tuple_element<value_idx, std::tuple<Ts&&...>>::type;
+
+        auto i_arg = size_t{0};
+        auto fmt = std::string{};
+
+        // Build `fmt` as the concatenation of all args, except by the last,
+        // after converting them to a string through `call_to_string`.
+        (void) std::initializer_list<int>{
+            (concat_fmt(args, fmt, i_arg, sizeof...(Ts)), 0)...
         };
 
-        auto start_it = mb_start ?
-            advance_it(begin(range), end(range), *mb_start) :
+        T value = std::get<value_idx>(std::forward_as_tuple(std::forward<Ts>(args)...));
+        return FormattingArgument<T>{fmt, std::forward<T>(value)};
+    }
 
-            // An Iterator instance evaluating equal to the range Sentinel. Since we will
-            // backwardly iterate over the range, that is the default starting point.
-            advance_it(begin(range), end(range), std::numeric_limits<size_t>::max());
 
-        // When derreferencing a `reverse_iterator<IT>`, the retrieved element will be one
-        // before the element pointed by IT. So here we fix that offset.
-        if (start_it != end(range)) ++start_it;
+    // Holds a triple of argument name, formatting string, and value. Those are
+    // all the info required to print an argument.
+    template <typename T>
+    struct PrintingArgument
+    {
+        StringView name;
+        StringView fmt;
+        T&& value;
+    };
 
-        // If we don't have a stop value, set it to the beginning of the range
-        if (!mb_stop)
+
+    // Print a forest that fits into a single line.
+    inline auto print_one_line_forest(
+        StringView prefix,
+        StringView context,
+        StringView delimiter,
+        std::vector<std::tuple<StringView, PrintingNode>> const& forest
+    ) -> std::string
+    {
+        auto result = prefix.to_string();
+        if (!context.empty())
         {
-            auto stop_it = begin(range);
-            return make_slice_functor<R>(
-                make_reverse_iterator(start_it), make_reverse_iterator(stop_it), step
-            );
+            result += context.to_string() + delimiter.to_string();
         }
 
-        // If we do have a stop value, and its value is normalized within [0, range_size]
-        else if (is_sized<R>::value)
+        for (auto it = forest.begin(); it != forest.end(); ++it)
         {
-            auto stop_it = begin(range);
-            std::advance(stop_it, static_cast<ptrdiff_t>(*mb_stop));
-            if (stop_it != end(range)) ++stop_it;
+            auto const& arg_name = std::get<0>(*it);
+            auto const& tree = std::get<1>(*it);
+
+            result += arg_name.to_string() + ": " + tree.print();
+
+            if (it+1 != forest.end())
+            {
+                    result += ", ";
+            }
+        }
+
+        return result;
+    }
+
+    // Print a forest that will be broken on multiple lines.
+    inline auto print_multi_line_forest(
+        StringView prefix,
+        StringView context,
+        std::vector<std::tuple<StringView, PrintingNode>> const& forest,
+        size_t const line_wrap_width
+    ) -> std::string
+    {
+        auto result = prefix.to_string();
+        if (!context.empty())
+        {
+            result += context.to_string();
+        }
+        result +=  + "\n";
+
+        for (auto it = forest.begin(); it != forest.end(); ++it)
+        {
+            auto const& arg_name = std::get<0>(*it);
+            auto const& tree = std::get<1>(*it);
+
+            result += std::string(Config_::INDENT_BASE, ' ') + arg_name.to_string() + ": ";
+            if (count_utf8_code_point(result) + tree.code_point_length() < line_wrap_width)
+            {
+                result += tree.print();
+            }
+            else
+            {
+                result += tree.print(2, line_wrap_width);
+            }
 
-            return make_slice_functor<R>(
-                make_reverse_iterator(start_it), make_reverse_iterator(stop_it), step
-            );
+            if (it+1 != forest.end())
+            {
+                result += ",\n";
+            }
         }
 
-        // If we do have a stop value, and its value is not normalized
-        else
-        {
-            auto stop_it = advance_it(begin(range), end(range), *mb_stop);
-            return make_slice_functor<R>(
-                make_reverse_iterator(start_it), make_reverse_iterator(stop_it), step
-            );
-        }
+        return result;
     }
 
-    template <typename R>
-    auto build_slice_functor_n(R&& r, Optional<size_t>, Optional<size_t>, size_t) ->
-        typename std::enable_if<
-            !is_bidirectional_range<R>::value,
-            SliceFunctor<R>
-        >::type
+    // Print the "hash" formatting of a C string
+    template <typename T>
+    auto print_hash(
+        T const& value, Config_ const&
+    ) -> typename std::enable_if<is_c_string<T>::value, PrintingNode>::type
     {
-        ICECREAM_UNREACHABLE;
-        return make_slice_functor<R>(begin(r), begin(r), 0);
+        using CharT =
+            remove_cvref_t<typename std::remove_pointer<typename std::decay<T>::type>::type>;
+        auto const str = BasicStringView<CharT>(value);
+        return make_string_hash_node(str.data(), str.size());
     }
 
-    template <typename R>
-    auto maybe_get_size(
-        R&& range
+    // Print the "hash" formatting of any other range, including std::string and
+    // std::string_view
+    template <typename T>
+    auto print_hash(
+        T const& value, Config_ const& config
     ) -> typename std::enable_if<
-        has_size_function_overload<R>::value,
-        Optional<size_t>
+        is_range<T const&>::value && !is_c_string<T>::value, PrintingNode
     >::type
     {
-        return size(range);
+        return make_printing_branch(value, "hash", config);
     }
 
-    template <typename R>
-    auto maybe_get_size(
-        R&& range
+    // Print the "hash" formatting of the object representation of a value without padding
+    // bits
+    template <typename T>
+    auto print_hash(
+        T const& value, Config_ const&
+    ) -> typename std::enable_if<is_hashable_by_bytes<T>::value, PrintingNode>::type
+    {
+        auto hasher = Xxh64{};
+        hasher.update(std::addressof(value), sizeof(T));
+        return make_hash_node(sizeof(T), hasher.digest());
+    }
+
+    // Print the "hash" formatting of any other trivially copyable value. Its object
+    // representation could have padding bytes, with unspecified values, so its
+    // formatting is hashed instead.
+    template <typename T>
+    auto print_hash(
+        T&& value, Config_ const& config
     ) -> typename std::enable_if<
-        has_size_method<R>::value && !has_size_function_overload<R>::value,
-        Optional<size_t>
+        !is_range<remove_cvref_t<T> const&>::value
+        && !is_c_string<remove_cvref_t<T>>::value
+        && !is_hashable_by_bytes<remove_cvref_t<T>>::value
+        && std::is_trivially_copyable<remove_cvref_t<T>>::value,
+        PrintingNode
     >::type
     {
-        return range.size();
+        auto const text = make_printing_branch(std::forward<T>(value), "", config).print();
+        auto hasher = Xxh64{};
+        hasher.update(text.data(), text.size());
+        return make_hash_node(sizeof(remove_cvref_t<T>), hasher.digest());
     }
 
-    template <typename R>
-    auto maybe_get_size(
-        R&&
+    template <typename T>
+    auto print_hash(
+        T const&, Config_ const&
     ) -> typename std::enable_if<
-        !is_sized<R>::value,
-        Optional<size_t>
+        !is_range<T const&>::value
+        && !is_c_string<T>::value
+        && !std::is_trivially_copyable<T>::value,
+        PrintingNode
     >::type
     {
-        return {};
+        return PrintingNode("<this value doesn't support hash formatting>");
     }
 
-    template <typename R>
-    auto maybe_make_slice_functor(
-        R&& range, Slice const& slice
-    ) -> Variant<std::string,  SliceFunctor<R>>
+    // The name of the strategy used to print a value of type T, as written in the NDJSON
+    // records.
+    template <typename T>
+    auto get_type_strategy() -> StringView
     {
-        auto const mb_range_size = maybe_get_size(range);
+        using U = remove_cvref_t<T>;
+        return
+            (is_c_string<U>::value || is_std_string<U>::value || is_string_view<U>::value)
+                ? "string"
+            : is_character<U>::value ? "character"
+            : std::is_same<U, bool>::value ? "boolean"
+            : std::is_arithmetic<U>::value ? "number"
+            : is_range<U const&>::value ? "range"
+            : is_tuple<U>::value ? "tuple"
+            : is_optional<U>::value ? "optional"
+            : is_variant<U>::value ? "variant"
+            : (std::is_pointer<U>::value || is_unstreamable_ptr<U>::value || is_weak_ptr<U>::value)
+                ? "pointer"
+            : std::is_base_of<std::exception, U>::value ? "exception"
+            : "value";
+    }
 
-        if (
-            mb_range_size
-            && *mb_range_size > static_cast<size_t>(std::numeric_limits<ptrdiff_t>::max())
-        ) {
-            return std::string("<this range size greater than the maximum supported>");
+    // A number identifying the calling thread, given in sequence to each thread on its
+    // first call.
+    inline auto get_thread_number() -> size_t
+    {
+        static std::atomic<size_t> n_threads{0};
+        static thread_local auto const number = ++n_threads;
+        return number;
+    }
+
+    // The UTC ISO 8601 representation of `time`, with microseconds.
+    inline auto format_utc_timestamp(std::chrono::system_clock::time_point time) -> std::string
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        auto const us = duration_cast<microseconds>(time.time_since_epoch()).count();
+        auto const us_per_day = int64_t{86400} * 1000000;
+        auto days = static_cast<int64_t>(us / us_per_day);
+        auto us_of_day = static_cast<int64_t>(us % us_per_day);
+        if (us_of_day < 0)
+        {
+            us_of_day += us_per_day;
+            --days;
+        }
+
+        // The civil date from the number of days since 1970-01-01, as in the
+        // "civil_from_days" algorithm by Howard Hinnant.
+        days += 719468;
+        auto const era = (days >= 0 ? days : days - 146096) / 146097;
+        auto const doe = days - era * 146097;
+        auto const yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+        auto const doy = doe - (365*yoe + yoe/4 - yoe/100);
+        auto const mp = (5*doy + 2) / 153;
+        auto const day = doy - (153*mp + 2)/5 + 1;
+        auto const month = mp < 10 ? mp + 3 : mp - 9;
+        auto const year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+        char buffer[128];
+        std::snprintf(
+            buffer,
+            sizeof(buffer),
+            "%04lld-%02lld-%02lldT%02lld:%02lld:%02lld.%06lldZ",
+            static_cast<long long>(year),
+            static_cast<long long>(month),
+            static_cast<long long>(day),
+            static_cast<long long>(us_of_day / 3600000000),
+            static_cast<long long>(us_of_day / 60000000 % 60),
+            static_cast<long long>(us_of_day / 1000000 % 60),
+            static_cast<long long>(us_of_day % 1000000)
+        );
+        return buffer;
+    }
+
+    inline auto get_level_name(Level level) -> StringView
+    {
+        switch (level)
+        {
+        case Level::trace: return "trace";
+        case Level::debug: return "debug";
+        case Level::info: return "info";
+        case Level::warn: return "warn";
+        case Level::error: return "error";
         }
+        return "";
+    }
 
-        // If the range size is unknown it is not possible to normalize a negative index.
-        // So here we return an error message if we have that situation.
-        if (
-            !mb_range_size
-            && ((slice.start && *slice.start < 0) || (slice.stop && *slice.stop < 0))
-        ) {
-            return std::string{"<this range supports only non-negative start and stop slice indexes>"};
+    // Print the NDJSON record of an IC call, a JSON object in a single line. Each argument
+    // has its name, the strategy of its `types`, and its value.
+    inline auto print_json_record(
+        StringView file,
+        int line,
+        StringView function,
+        Optional<Level> const& level,
+        std::vector<std::tuple<StringView, PrintingNode>> const& forest,
+        std::vector<StringView> const& types
+    ) -> std::string
+    {
+        auto result = std::string{"{\"file\":"};
+        append_json_string(result, file);
+        result += ",\"line\":" + std::to_string(line) + ",\"function\":";
+        append_json_string(result, function);
+        result += ",\"timestamp\":";
+        append_json_string(result, format_utc_timestamp(std::chrono::system_clock::now()));
+        result += ",\"thread\":" + std::to_string(get_thread_number()) + ",\"level\":";
+        if (level)
+        {
+            append_json_string(result, get_level_name(*level));
+        }
+        else
+        {
+            result += "null";
         }
 
-        auto const step = slice.step ? *slice.step : 1;
-        if (step == 0)
+        result += ",\"args\":[";
+        for (auto i = size_t{0}; i < forest.size(); ++i)
         {
-            return std::string{"<slice step cannot be zero>"};
+            if (i > 0)
+            {
+                result += ',';
+            }
+            result += "{\"name\":";
+            append_json_string(result, std::get<0>(forest[i]));
+            result += ",\"type\":";
+            append_json_string(result, types[i]);
+            result += ",\"value\":";
+            std::get<1>(forest[i]).print_json(result);
+            result += '}';
         }
-        if (!is_bidirectional_range<R>::value && step < 0)
+        result += "]}\n";
+
+        return result;
+    }
+
+    template <typename... Ts>
+    auto build_forest(
+        Config_ const& config, PrintingArgument<Ts>&... args
+    ) -> std::vector<std::tuple<StringView, PrintingNode>>
+    {
+        OutputBudget const budget(config.max_output_bytes());
+
+        // The arguments after the output budget is exhausted will be elided, without
+        // being formatted.
+        auto forest = std::vector<std::tuple<StringView, PrintingNode>>{};
+        (void) std::initializer_list<int>{
+            (
+                RangeStreamer::enter_argument(forest, args.name),
+                (void) forest.emplace_back(
+                    args.name,
+                    OutputBudget::is_exhausted() ?
+                        PrintingNode("...")
+                        : args.fmt == "hash" ?
+                            print_hash(args.value, config)
+                            : make_printing_branch(args.value, args.fmt, config)
+                ),
+                0
+            )...
+        };
+
+        return forest;
+    }
+
+    // The sinks of `config` accepting a call with the severity `level`. When all of them
+    // accept it, as always happens to an unleveled call, the list of `config` itself is
+    // returned.
+    inline auto get_accepting_sinks(
+        Config_ const& config, Optional<Level> const& level
+    ) -> std::shared_ptr<SinkList const>
+    {
+        auto sinks = config.get_sinks();
+        auto const accepts =
+            [&](std::shared_ptr<Sink> const& sink) {return sink->accepts(level);};
+        if (std::all_of(sinks->begin(), sinks->end(), accepts))
         {
-            return std::string{"<this range supports only strictly positive slice steps>"};
+            return sinks;
         }
 
-        auto const mb_start =
-            [&]() -> Optional<size_t> {
-                if (!slice.start)
-                {
-                    return {};
-                }
-                else if (mb_range_size)
+        auto accepting = std::make_shared<SinkList>();
+        std::copy_if(sinks->begin(), sinks->end(), std::back_inserter(*accepting), accepts);
+        return accepting;
+    }
+
+    template <typename... Ts>
+    auto print_args(
+        Config_& config,
+        StringView file,
+        int line,
+        StringView function,
+        Optional<Level> const& level,
+        PrintingArgument<Ts>... args
+    ) -> typename std::enable_if<
+            detail::conjunction<detail::is_printable<Ts>...>::value
+        >::type
+    {
+        config.flush_expired_repeats();
+
+        // The forest is built once, and only if any sink will write it.
+        auto const sinks = get_accepting_sinks(config, level);
+        if (sinks->empty())
+        {
+            return;
+        }
+
+        auto const prefix = config.gen_prefix();
+        auto const context =
+            [&]() -> std::string
+            {
+                // If used an empty IC macro, i.e.: IC().
+                if (config.include_context())
                 {
-                    auto const range_size = static_cast<ptrdiff_t>(*mb_range_size);
-                    auto const idx = (*slice.start >= 0) ? *slice.start : *slice.start + range_size;
-                    return (idx < 0) ?
-                        0
-                        : (idx > range_size) ? static_cast<size_t>(range_size) : static_cast<size_t>(idx);
+                  #if defined(_MSC_VER)
+                    auto const n = file.rfind('\\');
+                  #else
+                    auto const n = file.rfind('/');
+                  #endif
+                    return
+                        file.substr(n+1).to_string()
+                        + ":"
+                        + std::to_string(line)
+                        + " in \""
+                        + function.to_string()
+                        + '"';
                 }
                 else
                 {
-                    // If range is unsized, start was ensured as non-negative above
-                    return static_cast<size_t>(*slice.start);
+                    return "";
                 }
             }();
+        auto const delimiter = config.context_delimiter();
 
-        auto const mb_stop =
-            [&]() -> Optional<size_t> {
-                if (!slice.stop)
+        // A range is streamed only when written by a single sink, as text.
+        auto const is_streamable =
+            sinks->size() == 1 && sinks->front()->renderer() == Renderer::text;
+        RangeStreamer streamer(
+            config,
+            is_streamable ? sinks->front().get() : nullptr,
+            prefix,
+            context.empty() ? prefix : prefix + context
+        );
+        JsonPrinting const json_printing(
+            std::any_of(
+                sinks->begin(),
+                sinks->end(),
+                [](std::shared_ptr<Sink> const& sink)
                 {
-                    return {};
+                    return sink->renderer() == Renderer::ndjson;
                 }
-                else if (mb_range_size)
-                {
-                    auto const range_size = static_cast<ptrdiff_t>(*mb_range_size);
-                    auto const idx = (*slice.stop >= 0) ? *slice.stop : *slice.stop + range_size;
+            )
+        );
+        auto const forest = build_forest(config, args...);
 
-                    if (step < 0 && idx < 0)
-                    {
-                        return {};
-                    }
-                    else
-                    {
-                        return (idx < 0) ?
-                            0
-                            : (idx > range_size) ? static_cast<size_t>(range_size) : static_cast<size_t>(idx);
-                    }
-                }
-                else
+        // If any range argument was streamed, the output was already partially written.
+        if (streamer.is_started())
+        {
+            streamer.finish(forest);
+            return;
+        }
+
+        // Each renderer is run at most once, even if used by many sinks.
+        auto mb_text = Optional<std::string>{};
+        auto mb_single_line = Optional<std::string>{};
+        auto const render_single_line =
+            [&]() -> std::string const&
+            {
+                if (!mb_single_line)
                 {
-                    // If range is unsized, stop was ensured as non-negative above
-                    return static_cast<size_t>(*slice.stop);
+                    mb_single_line =
+                        print_one_line_forest(prefix, context, delimiter, forest).append("\n");
                 }
-            }();
+                return *mb_single_line;
+            };
 
-        // If the stop point would be placed before the start point. Return an empty slicing.
-        if (
-            mb_start && mb_stop &&
-            (
-                (step > 0 && *mb_stop <= *mb_start) ||
-                (step < 0 && *mb_stop >= *mb_start)
-            )
-        ) {
-            return build_slice_functor_p(range, 0, 0, 1);
-        }
+        // The number of codepoints used if the whole forest would be printed in an one
+        // line.
+        auto const get_one_line_forest_n_code_points =
+            [&]() -> size_t
+            {
+                auto n = count_utf8_code_point(prefix);
 
-        // At here, we know for sure that for all start, stop, and step; if they have a
-        // value, that value is non-negative and step non zero too. In addition to that,
-        // stop for sure is placed at the same location as start or in a place after
-        // start.
+                for (auto const& name_tree : forest)
+                {
+                    n +=
+                        count_utf8_code_point(std::get<0>(name_tree))
+                        + count_utf8_code_point(": ")
+                        + std::get<1>(name_tree).code_point_length();
+                }
 
-        if (step > 0)
-        {
-            return build_slice_functor_p(range, mb_start, mb_stop, static_cast<size_t>(step));
-        }
-        else  // step < 0
-        {
-            return build_slice_functor_n(range, mb_start, mb_stop, static_cast<size_t>(-step));
-        }
-    }
+                // The ", " separators between variables.
+                if (forest.size() > 1)
+                {
+                    n += (forest.size() - 1) * count_utf8_code_point(", ");
+                }
 
+                return n;
+            };
 
-    // Receives a range formatting string, "[:3]:#x" for instance, and splits it in a
-    // pair: the range formatting itself ("[:3]") and the elements formatting ("#x"). The
-    // cut point is the leftmost colon that is outside of a square bracket pair.
-    inline auto split_range_fmt_string(StringView fmt) -> std::tuple<StringView, StringView>
-    {
-        auto is_inside_square_brackets = false;
-        for (auto i = size_t{0}; i < fmt.size(); ++i)
-        {
-            if (fmt[i] == '[')
+        auto const render_text =
+            [&]() -> std::string const&
             {
-                is_inside_square_brackets = true;
-            }
-            else if (fmt[i] == ']')
+                if (!mb_text)
+                {
+                    if (get_one_line_forest_n_code_points() <= config.line_wrap_width())
+                    {
+                        mb_text = render_single_line();
+                    }
+                    else
+                    {
+                        mb_text = print_multi_line_forest(
+                            prefix, context, forest, config.line_wrap_width()
+                        ).append("\n");
+                    }
+                }
+                return *mb_text;
+            };
+
+        // The layout pass of the text renderers is skipped.
+        auto mb_json = Optional<std::string>{};
+        auto const render_json =
+            [&]() -> std::string const&
             {
-                is_inside_square_brackets = false;
-            }
-            else if (!is_inside_square_brackets && fmt[i] == ':')
+                if (!mb_json)
+                {
+                    mb_json = print_json_record(
+                        file,
+                        line,
+                        function,
+                        level,
+                        forest,
+                        std::vector<StringView>{get_type_strategy<Ts>()...}
+                    );
+                }
+                return *mb_json;
+            };
+
+        for (auto const& sink : *sinks)
+        {
+            switch (sink->renderer())
             {
-                auto const iterable_fmt = fmt.substr(0, i);
-                auto const element_fmt = fmt.substr(i + 1, StringView::npos);
-                return std::make_tuple(iterable_fmt, element_fmt);
+            case Renderer::text:
+                config.write_line(*sink, prefix, file, line, render_text());
+                break;
+            case Renderer::single_line:
+                config.write_line(*sink, prefix, file, line, render_single_line());
+                break;
+            case Renderer::ndjson:
+                // Every record is unique by its timestamp, so no repeat is coalesced. The
+                // records are always UTF-8, and so not transcoded.
+                sink->write(render_json());
+                break;
             }
         }
-
-        // If there isn't a colon cut point, all the input `fmt` string is the iterable
-        // formatting
-        return std::make_tuple(fmt, "");
-    }
-
-    // --------------------------------------------------
-
-    template <typename T>
-    auto do_print_range(
-        T&&, StringView, Config_ const&
-    ) -> typename std::enable_if<!is_range<T>::value, PrintingNode>::type
-    {
-        ICECREAM_UNREACHABLE;
-        return PrintingNode("");
     }
 
-    template <typename T>
-    auto do_print_range(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<is_range<T>::value , PrintingNode>::type
+    // Handles the printing of a nullary IC() call.
+    inline auto print_nullary(
+        Config_& config,
+        StringView file,
+        int line,
+        StringView function,
+        Optional<Level> const& level
+    ) -> void
     {
-        auto range_fmt = StringView{};
-        auto elements_fmt = StringView{};
-        std::tie(range_fmt, elements_fmt) = split_range_fmt_string(fmt);
+        config.flush_expired_repeats();
 
-        auto const mb_slice = Slice::build(range_fmt);
-        if (!mb_slice)
+        auto const sinks = get_accepting_sinks(config, level);
+        if (sinks->empty())
         {
-            return PrintingNode("<invalid range slicing>");
+            return;
         }
 
-        auto mb_slice_functor = maybe_make_slice_functor(value, *mb_slice);
-
-        // If there was any error while creating the SliceFunctor
-        if (mb_slice_functor.index() == 0)
-        {
-            return PrintingNode(get<std::string>(mb_slice_functor));
-        }
+        auto const prefix = config.gen_prefix();
+        auto const context =
+            [&]() -> std::string
+            {
+              #if defined(_MSC_VER)
+                auto const n = file.rfind('\\');
+              #else
+                auto const n = file.rfind('/');
+              #endif
 
-        auto slice_functor = get<SliceFunctor<T const>>(mb_slice_functor);
+                return
+                    file.substr(n+1).to_string()
+                    + ":"
+                    + std::to_string(line)
+                    + " in \""
+                    + function.to_string()
+                    + '"';
+            }();
 
-        auto children = std::vector<PrintingNode>{};
-        auto mb_element = slice_functor();
-        while (mb_element)
+        auto const text = prefix + context + "\n";
+        for (auto const& sink : *sinks)
         {
-            children.push_back(make_printing_branch(*mb_element, elements_fmt, config));
-            mb_element = slice_functor();
+            if (sink->renderer() == Renderer::ndjson)
+            {
+                auto const forest = std::vector<std::tuple<StringView, PrintingNode>>{};
+                sink->write(print_json_record(file, line, function, level, forest, {}));
+            }
+            else
+            {
+                config.write_line(*sink, prefix, file, line, text);
+            }
         }
-
-        auto const opening = range_fmt.empty() ? "[" : range_fmt.to_string() + "->[";
-        return PrintingNode(opening, ", ", "]", std::move(children));
     }
 
-    // Print all elements of a range
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<
-        (
-            is_range<T>::value                      // it is range
-            && !is_baseline_printable<T>::value     // but it is not printable by baseline strategies
-            && !bypass_baseline_printing<T>::value  // and it hasn't its own strategy
-         ) || (
-            // Except by arrays of anything other than character, which are baseline
-            // printable, but should be printed by this strategy instead.
-            std::is_array<remove_ref_t<T>>::value
-            && !is_c_string<remove_ref_t<T>>::value
-        )
-        , PrintingNode
-    >::type
+    /** This function will receive a string as "foo, bar, baz" and return a vector with
+     * all the arguments split, such as ["foo", "bar", "baz"].
+     */
+    inline auto split_arguments(StringView all_names) -> std::vector<StringView>
     {
-        return do_print_range(std::forward<T>(value), fmt, config);
-    }
+        if (all_names.empty())
+        {
+            return {};
+        }
 
-    // ---------------------------------------------------------------------------------------------
+        // Check if the '>' char is the closing of a template arguments listing. It will
+        // be a template closing at `std::is_same<int, int>::value` but not at `5 > 2`
+        auto is_closing_template =
+            [&all_names](size_t idx, size_t const last_idx) -> bool
+            {
+                auto curr_char = all_names[idx];
+                if (curr_char != '>' || idx == last_idx)
+                {
+                    return false;
+                }
 
-    // Print classes deriving from only std::exception and not from boost::exception
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView, Config_ const&
-    ) -> typename std::enable_if<
-        std::is_base_of<std::exception, remove_cvref_t<T>>::value
-        && !std::is_base_of<boost::exception, remove_cvref_t<T>>::value
-        && !is_baseline_printable<T>::value,
-        PrintingNode
-    >::type
-    {
-        return PrintingNode(value.what());
-    }
+                do
+                {
+                    ++idx;
+                    curr_char = all_names[idx];
+                } while (
+                    idx != last_idx
+                    && (
+                        curr_char == ' '
+                        || curr_char == '\t'
+                        || curr_char == '\n'
+                        || curr_char == '\r'
+                        || curr_char == '\f'
+                        || curr_char == '\v'
+                    )
+                );
 
-    // Print classes deriving from both std::exception and boost::exception
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView, Config_ const&
-    ) -> typename std::enable_if<
-        std::is_base_of<std::exception, remove_cvref_t<T>>::value
-        && std::is_base_of<boost::exception, remove_cvref_t<T>>::value
-        && !is_baseline_printable<T>::value,
-        PrintingNode
-    >::type
-    {
-        return PrintingNode(
-            value.what()
-            + std::string {"\n"}
-            + boost::exception_detail::diagnostic_information_impl(
-                  &value, &value, true, true
-            )
-        );
-    }
+                return curr_char == ':' && idx != last_idx && all_names[idx + 1] == ':';
+            };
 
-  #if defined(ICECREAM_DUMP_STRUCT_CLANG)
-    static auto ds_this = static_cast<PrintingNode*>(nullptr);
-    static auto ds_delayed_structs = std::vector<std::pair<std::string, std::function<void()>>>{};
-    static auto ds_fmt_ref = StringView{};
-    static auto ds_config_ref = static_cast<Config_ const*>(nullptr);
-    static auto ds_call_count = int{0};
-    template<typename... T> auto parse_dump_struct(char const* format, T&& ...args) -> int;
+        auto parenthesis_count = int{0};
+        auto angle_bracket_count = int{0};
+        auto curly_bracket_count = int{0};
+        auto is_within_double_quote = false;
+        auto is_within_single_quote = false;
 
-    // Print classes using clang's __builtin_dump_struct (clang >= 15).
-    template <typename T>
-    auto make_printing_branch(
-        T&& value, StringView fmt, Config_ const& config
-    ) -> typename std::enable_if<is_handled_by_clang_dump_struct<T>::value, PrintingNode>::type
-    {
-        // If this is the outermost class being printed
-        if (!ds_this)
+        // Parse the arguments string backward. It is easier this way to check if a '<' or
+        // '>' character is either a comparison operator, or a opening and closing of
+        // templates arguments.
+        auto comma_idxs = std::vector<size_t>{};
+        auto last_idx = all_names.size() - 1;
+        for (auto idx = all_names.size(); idx-- > 0;)
         {
-            auto branch_node = PrintingNode("");
+            auto const curr_char = all_names[idx];
+            auto const prev_char = idx > 0 ? all_names[idx-1] : '\0';
 
-            ds_this = &branch_node;  // Put `this` on scope to be assigned inside `parse_dump_struct`
-            ds_fmt_ref = fmt;
-            ds_config_ref = &config;
-            __builtin_dump_struct(&value, &parse_dump_struct);  // Print the outermost class
+            if (is_within_double_quote)
+            {
+                // if current char is the left double quote
+                if (curr_char == '"' && prev_char != '\\') is_within_double_quote = false;
+            }
 
-            // Loop on each class that is an internal attribute of the outermost class
-            while (!ds_delayed_structs.empty())
+            else if (is_within_single_quote)
             {
-                auto const delayed_struct = ds_delayed_structs.back();
-                ds_delayed_structs.pop_back();
+                // if current char is the left single quote
+                if (curr_char == '\'' && prev_char != '\\') is_within_single_quote = false;
+            }
 
-                // Put that attribute class on scope to `parse_struct_dump`
-                ds_this = branch_node.find_leaf(delayed_struct.first);
+            else if (curr_char == '"' && prev_char != '\\')
+            {
+                is_within_double_quote = true;
+            }
 
-                if (ds_this == nullptr)
-                {
-                    std::cerr
-                        << "ICECREAM: Failure finding a child Tree, this should not have happened. "
-                        "Please report a bug on https://github.com/renatoGarcia/icecream-cpp/issues\n";
-                }
+            else if (curr_char == '\'' && prev_char != '\\')
+            {
+                is_within_single_quote = true;
+            }
 
-                delayed_struct.second();  // Print the class
+            // If it have found the comma separating two arguments
+            else if (
+                curr_char == ','
+                && parenthesis_count == 0
+                && angle_bracket_count == 0
+                && curly_bracket_count == 0
+            ) {
+                comma_idxs.push_back(idx);
+                last_idx = idx - 1;
             }
 
-            ds_this = nullptr;
-            ds_call_count = 0;
+            // It won't cut on a comma within parentheses, such as when the argument is a
+            // function call, as in IC(foo(1, 2))
+            else if (curr_char == ')')
+            {
+                ++parenthesis_count;
+            }
 
-            return branch_node;
-        }
+            else if (curr_char == '(')
+            {
+                --parenthesis_count;
+            }
 
-        // Otherwise, the class at hand is an internal attribute from the outermost
-        // class. If this is the case, this present calling of Tree constructor is
-        // being made from inside a __builtin_dump_struct calling. So here we delay
-        // the calling of __builtin_dump_struct to avoid a reentrant function call.
-        else
-        {
-            auto const unique_id =
-                "icecream_415a8a88-aa51-44d5-8ccb-377d953413ef_" + std::to_string(ds_call_count);
+            else if (curr_char == '}')
+            {
+                ++curly_bracket_count;
+            }
+
+            else if (curr_char == '{')
+            {
+                --curly_bracket_count;
+            }
 
-            ds_delayed_structs.emplace_back(
-                unique_id,
-                [&value]()
-                {
-                    __builtin_dump_struct(&value, &parse_dump_struct);
-                }
-            );
-            ds_call_count += 1;
+            // It won't cut on a comma within a template argument list, such as in
+            // IC(std::is_same<int, int>::value)
+            else if (is_closing_template(idx, last_idx))
+            {
+                ++angle_bracket_count;
+            }
 
-            // Return a placeholder node that will be replaced by the `if` above at the right time.
-            return PrintingNode(unique_id);
+            else if (curr_char == '<' && angle_bracket_count > 0)
+            {
+                --angle_bracket_count;
+            }
         }
-    }
 
-    // Receives an argument from parse_dump_struct and builds a Tree using it.
-    //
-    // When clang doesn't know how to format a value within __builtin_dump_struct, it will
-    // pass a pointer to that value instead of a reference. This function specialization
-    // will handle that scenario, as it specializes on pointers. However, to distinguish
-    // between actual pointer values and a "don't know how to format" value, the `deref`
-    // boolean is used.
-    template<typename T>
-    auto build_tree(bool deref, T* const& t) -> PrintingNode
-    {
-        if (deref)
-        {
-            return make_printing_branch(*t, ds_fmt_ref, *ds_config_ref);
-        }
-        else
+        auto result = split(all_names, {comma_idxs.rbegin(), comma_idxs.rend()});
+        for (auto& name : result)
         {
-            return make_printing_branch(t, ds_fmt_ref, *ds_config_ref);
+            name.trim();
         }
+
+        return result;
     }
 
-    // Receives an argument from parse_dump_struct and builds a Tree using it.
-    template<typename T>
-    auto build_tree(bool, T const& t) -> PrintingNode
+    template <typename T>
+    auto get_value(T&& t) ->
+        typename std::enable_if<
+            !is_instantiation<FormattingArgument, remove_cvref_t<T>>::value,
+            T&&
+        >::type
     {
-        return make_printing_branch(t, ds_fmt_ref, *ds_config_ref);
+        return std::forward<T>(t);
     }
 
-    // Receives all the variadic inputs from parse_dump_struct and returns a pair with the
-    // argument name and its Tree representation.
-    // This overload accepts zero, one, or two values from the variadic inputs. It is
-    // here just so the code compiles and never will be called. When receiving these
-    // number of inputs an argument to be printed will never be among them.
-    inline auto build_name_tree_pair(
-        bool, std::string const& = "", std::string const& = ""
-    ) -> std::pair<std::string, PrintingNode>
+    template <typename T>
+    auto get_value(T&& t) ->
+        typename std::enable_if<
+            is_instantiation<FormattingArgument, remove_cvref_t<T>>::value,
+            decltype(t.value)
+        >::type
     {
-        ICECREAM_UNREACHABLE;
-        return std::pair<std::string, PrintingNode>("", PrintingNode(""));
+        return std::forward<decltype(t.value)>(t.value);
     }
 
-    // Receives all the variadic inputs from parse_dump_struct and returns a pair with the
-    // argument name and its Tree representation.
-    // This overload will be called when starting the printing of an argument that is
-    // itself a struct with other attributes. The empty `Tree` is a placeholder that will
-    // be replaced when the actual tree is built.
-    inline auto build_name_tree_pair(
-        bool, std::string const&, std::string const&, std::string const& arg_name
-    ) -> std::pair<std::string, PrintingNode>
+    template <typename T>
+    auto get_fmt(T const&, StringView default_format) -> StringView
     {
-        return std::pair<std::string, PrintingNode>(arg_name, PrintingNode(""));
+        return default_format;
     }
 
-    // Receives all the variadic inputs from parse_dump_struct and returns a pair with the
-    // argument name and its Tree representation.
-    template<typename T>
-    auto build_name_tree_pair(
-        bool deref,
-        std::string const&,
-        std::string const&,
-        std::string const& arg_name,
-        T const& value
-    ) -> std::pair<std::string, PrintingNode>
+    template <typename T>
+    auto get_fmt(FormattingArgument<T> const& t, StringView) -> StringView
     {
-        return std::pair<std::string, PrintingNode>(arg_name, build_tree(deref, value));
+        return t.fmt;
     }
 
-    // Each call to `parse_dump_struct` will deal with at most one attribute from the
-    // struct being printed. This `attributes_stack` will hold the pairs (argument name,
-    // Tree) constructed to each attribute until all of them are processed.
-    static auto attributes_stack = std::vector<std::vector<std::pair<std::string, PrintingNode>>>{};
-
-    // When printing the attributes of a base class (inheritance), Clang will open and
-    // close braces, similarly to when printing an attribute that is a struct
-    // (composition). It is possible distinguish the two cases when at opening, but they
-    // are identical when closing. This vector mark if the current context is inside an
-    // inheritance attributes or a composition attributes.
-    static auto is_inside_baseclass = std::vector<bool>{};
-
-    template<typename... T>
-    int parse_dump_struct(char const* format_, T&&... args)
+    // A range over the bytes of an object representation. Used to hex dump any trivially
+    // copyable object through the IC_BYTES macro.
+    class ObjectBytes
     {
-        // Removes any left and right white spaces
-        auto const trim =
-            [](std::string const& str) -> std::string
-            {
-                auto const left = str.find_first_not_of(" \t\n");
-                if (left == std::string::npos) return "";
-
-                auto const right = str.find_last_not_of(" \t\n");
-                return str.substr(left, right-left+1);
-            };
-
-        // Check if the last format specifier, the one related to the value to be printed,
-        // means that clang doesn't know how to format that value.
-        auto const knows_how_to_format =
-            [](std::string const& str) -> bool
-            {
-                auto const left = str.find_last_of(" \t");
-                return str.substr(left+1) != "*%p";
-            };
-
-        auto const format = trim(format_);
-
-        // When true, the next parse_dump_struct call will be the opening brace of a base
-        // class scope.
-        if (sizeof...(args) == 2)
+    public:
+        template <typename T>
+        explicit ObjectBytes(T const& value)
+            : first_(reinterpret_cast<unsigned char const*>(std::addressof(value)))
+            , size_(sizeof(T))
         {
-            is_inside_baseclass.push_back(true);
+            static_assert(
+                std::is_trivially_copyable<T>::value,
+                "IC_BYTES requires a trivially copyable argument"
+            );
         }
 
-        // When true, the next parse_dump_struct call will be the opening brace of a scope
-        // printing the content of an atrribute that is a struct.
-        else if (sizeof...(args) == 3)
+        auto begin() const -> unsigned char const*
         {
-            is_inside_baseclass.push_back(false);
-
-            attributes_stack.back().push_back(
-                build_name_tree_pair(!knows_how_to_format(format), args...)
-            );
-
-            // The next attributes will be from this struct attribute being printed.
-            // Collect them all before merging on a Tree.
-            attributes_stack.emplace_back();
+            return this->first_;
         }
 
-        // When true, it is printing an actual value. Like "int i = 7".
-        else if (sizeof...(args) == 4)
+        auto end() const -> unsigned char const*
         {
-            attributes_stack.back().push_back(
-                build_name_tree_pair(!knows_how_to_format(format), args...)
-            );
+            return this->first_ + this->size_;
         }
 
-        // The closing brace of a baseclass attributes section
-        else if (format.back() == '}' && is_inside_baseclass.back())
+        auto size() const -> size_t
         {
-            is_inside_baseclass.pop_back();
+            return this->size_;
         }
 
-        // The closing brace of either a struct attribute or the root struct being printed
-        else if (format.back() == '}')
+    private:
+        unsigned char const* first_;
+        size_t size_;
+    };
+
+    // Two ranges, or two tuples, to be compared element by element. Used by the IC_CMP
+    // macro.
+    template <typename L, typename R>
+    struct Comparison
+    {
+        L const& left;
+        R const& right;
+
+        // The greatest difference between two equal floating point elements.
+        double tolerance;
+    };
+
+    // If the elements `a` and `b` of a Comparison are equal. When any of them is a floating
+    // point number they are equal within the tolerance, and two NaN are equal too.
+    template <typename A, typename B>
+    auto are_comparison_equal(A const& a, B const& b, double tolerance) ->
+        typename std::enable_if<
+            std::is_arithmetic<A>::value
+            && std::is_arithmetic<B>::value
+            && (std::is_floating_point<A>::value || std::is_floating_point<B>::value),
+            bool
+        >::type
+    {
+        auto const x = static_cast<double>(a);
+        auto const y = static_cast<double>(b);
+        if (std::isnan(x) || std::isnan(y))
         {
-            is_inside_baseclass.pop_back();
+            return std::isnan(x) && std::isnan(y);
+        }
 
-            auto top_atrributes = std::move(attributes_stack.back());
-            attributes_stack.pop_back();
+        return x == y || std::fabs(x - y) <= tolerance;
+    }
 
-            auto children = std::vector<PrintingNode>{};
-            for (auto& att : top_atrributes)
-            {
-                auto t_pair = std::vector<PrintingNode>{};
-                t_pair.push_back(PrintingNode(std::get<0>(att)));
-                t_pair.push_back(std::move(std::get<1>(att)));
+    template <typename A, typename B>
+    auto are_comparison_equal(A const& a, B const& b, double) ->
+        typename std::enable_if<
+            !std::is_arithmetic<A>::value
+            || !std::is_arithmetic<B>::value
+            || (!std::is_floating_point<A>::value && !std::is_floating_point<B>::value),
+            bool
+        >::type
+    {
+        return a == b;
+    }
 
-                children.emplace_back("", ": ", "", std::move(t_pair));
-            }
+    // Compares the elements of a Comparison and collects the nodes of the mismatching ones.
+    // The number of printed mismatches is bounded by the `max_range_elements` limit, but
+    // all of them are counted.
+    class MismatchCollector
+    {
+    public:
+        MismatchCollector(double tolerance, StringView fmt, Config_ const& config)
+            : tolerance_(tolerance)
+            , fmt_(fmt)
+            , config_(config)
+            , children_(config.max_range_elements())
+            , n_mismatches_(0)
+            , is_truncated_(false)
+        {}
 
-            auto built_tree = PrintingNode("{", ", ", "}", std::move(children));
+        template <typename A, typename B>
+        auto compare(size_t idx, A const& a, B const& b) -> void
+        {
+            if (are_comparison_equal(a, b, this->tolerance_))
+            {
+                return;
+            }
 
-            if (attributes_stack.empty())
+            ++this->n_mismatches_;
+            if (this->is_truncated_)
             {
-                *ds_this = std::move(built_tree);
+                return;
             }
-            else
+
+            if (this->children_.is_full())
             {
-                std::get<1>(attributes_stack.back().back()) = std::move(built_tree);
+                this->is_truncated_ = true;
+                this->children_.push_marker("...");
+                return;
             }
+
+            auto pair = std::vector<PrintingNode>{};
+            pair.push_back(make_printing_branch(a, this->fmt_, this->config_));
+            pair.push_back(make_printing_branch(b, this->fmt_, this->config_));
+            this->children_.push_node(
+                make_labeled_node(
+                    std::to_string(idx) + ": ", PrintingNode("(", ", ", ")", std::move(pair))
+                )
+            );
         }
 
-        // The opening of the root struct being printed
-        else if (sizeof...(args) == 1)
+        // Builds the node with the mismatches count, the sizes of the compared ranges or
+        // tuples if they differ, and the collected mismatches.
+        auto build(size_t left_size, size_t right_size) -> PrintingNode
         {
-            attributes_stack.emplace_back();
-            is_inside_baseclass.push_back(false);
-        }
+            auto nodes = std::vector<PrintingNode>{};
+            if (left_size != right_size)
+            {
+                nodes.push_back(
+                    PrintingNode(
+                        "sizes: (" + std::to_string(left_size) + ", "
+                        + std::to_string(right_size) + ")"
+                    )
+                );
+            }
+            nodes.push_back(PrintingNode("mismatches: " + std::to_string(this->n_mismatches_)));
 
-        return 0;
-    }
-  #endif  // ICECREAM_DUMP_STRUCT_CLANG
+            for (auto& node : this->children_.release())
+            {
+                nodes.push_back(std::move(node));
+            }
 
+            return PrintingNode("{", ", ", "}", std::move(nodes));
+        }
 
-    // -------------------------------------------------- is_printable
+    private:
+        double tolerance_;
+        StringView fmt_;
+        Config_ const& config_;
+        RangeChildren children_;
+        size_t n_mismatches_;
+        bool is_truncated_;
+    };
 
-    template <typename T>
-    auto is_printable_impl(int) ->
-        decltype(
-            make_printing_branch(
-                std::declval<T&>(),
-                std::declval<StringView&>(),
-                std::declval<Config_ const&>()
-            ),
-            std::true_type{}
-        );
+    template <size_t... N, typename L, typename R>
+    auto compare_tuples(
+        int_sequence<N...>, L const& left, R const& right, MismatchCollector& collector
+    ) -> void
+    {
+        (void) std::initializer_list<int>{
+            (collector.compare(N, std::get<N>(left), std::get<N>(right)), 0)...
+        };
+    }
 
-    template <typename T>
-    auto is_printable_impl(...) -> std::false_type;
+    // Compare two ranges
+    template <typename L, typename R>
+    auto do_print_comparison(
+        L const& left, R const& right, MismatchCollector& collector
+    ) -> typename std::enable_if<
+        is_range<L const&>::value && is_range<R const&>::value, PrintingNode
+    >::type
+    {
+        auto left_it = begin(left);
+        auto const left_last = end(left);
+        auto right_it = begin(right);
+        auto const right_last = end(right);
 
-    // Check if IceCream can print the type T.
-    template <typename T>
-    using is_printable = decltype(is_printable_impl<T>(0));
+        auto idx = size_t{0};
+        for (; left_it != left_last && right_it != right_last; ++left_it, ++right_it)
+        {
+            collector.compare(idx, *left_it, *right_it);
+            ++idx;
+        }
+
+        auto left_size = idx;
+        for (; left_it != left_last; ++left_it)
+        {
+            ++left_size;
+        }
 
+        auto right_size = idx;
+        for (; right_it != right_last; ++right_it)
+        {
+            ++right_size;
+        }
 
-    // -------------------------------------------------- Icecream
+        return collector.build(left_size, right_size);
+    }
 
-    // Holds a pair of argument and formatting string. Created by the macro `IC_`.
-    template <typename T>
-    struct FormattingArgument
+    // Compare two tuples
+    template <typename L, typename R>
+    auto do_print_comparison(
+        L const& left, R const& right, MismatchCollector& collector
+    ) -> typename std::enable_if<
+        (!is_range<L const&>::value || !is_range<R const&>::value)
+        && is_tuple<L>::value && is_tuple<R>::value,
+        PrintingNode
+    >::type
     {
-        std::string fmt;
-        T&& value;
-    };
-
-    template <typename T>
-    struct formatting_argumet_type_impl {using type = T;};
-
-    template <typename T>
-    struct formatting_argumet_type_impl<FormattingArgument<T>&> {using type = T;};
+        constexpr auto left_size = std::tuple_size<L>::value;
+        constexpr auto right_size = std::tuple_size<R>::value;
+
+        compare_tuples(
+            make_int_sequence<(left_size < right_size ? left_size : right_size)>(),
+            left,
+            right,
+            collector
+        );
 
-    template <typename T>
-    using formatting_argumet_type =
-        typename formatting_argumet_type_impl<T>::type;
+        return collector.build(left_size, right_size);
+    }
 
+    template <typename L, typename R>
+    auto do_print_comparison(
+        L const&, R const&, MismatchCollector&
+    ) -> typename std::enable_if<
+        (!is_range<L const&>::value || !is_range<R const&>::value)
+        && (!is_tuple<L>::value || !is_tuple<R>::value),
+        PrintingNode
+    >::type
+    {
+        return PrintingNode("<IC_CMP arguments must be two ranges or two tuples>");
+    }
 
-    // If the type has an overload of to_string, call it.
     template <typename T>
-    auto call_to_string(T const& t) ->
-        typename std::enable_if<
-            has_to_string<T>::value,
-            std::string
-        >::type
+    auto make_printing_branch(
+        T&& value, StringView fmt, Config_ const& config
+    ) -> typename std::enable_if<is_comparison<remove_cvref_t<T>>::value, PrintingNode>::type
     {
-        return to_string(t);
+        NestingLevel const nesting_level;
+        if (NestingLevel::current() > config.max_nesting_depth())
+        {
+            return PrintingNode("{...}");
+        }
+
+        auto collector = MismatchCollector(value.tolerance, fmt, config);
+        return do_print_comparison(value.left, value.right, collector);
     }
 
-    // If the type is a string like, just return it.
+    // The hash telling whether an IC_ON_CHANGE argument has changed. A value without
+    // padding bits, and which isn't a view to other objects, is hashed by its object
+    // representation, without being formatted.
     template <typename T>
-    auto call_to_string(T const& t) ->
-        typename std::enable_if<
-            !has_to_string<T>::value
-            && (
-                is_character<remove_ref_t<T>>::value
-                || is_c_string<remove_ref_t<T>>::value
-                || is_std_string<remove_ref_t<T>>::value
-                || is_string_view<remove_ref_t<T>>::value
-            ),
-            std::string
-        >::type
+    auto hash_change(T const& value, Config_ const&) -> typename std::enable_if<
+        is_hashable_by_bytes<T>::value, uint64_t
+    >::type
     {
-        return t;
+        auto hasher = Xxh64{};
+        hasher.update(std::addressof(value), sizeof(T));
+        return hasher.digest();
     }
 
-    // Just to compile, should not be called.
+    // A std::string is hashed by its code units, without being formatted.
     template <typename T>
-    auto call_to_string(T const&) ->
-        typename std::enable_if<
-            !has_to_string<T>::value
-            && !(
-                is_character<remove_ref_t<T>>::value
-                || is_c_string<remove_ref_t<T>>::value
-                || is_std_string<remove_ref_t<T>>::value
-                || is_string_view<remove_ref_t<T>>::value
-            ),
-            std::string
-        >::type
+    auto hash_change(T const& value, Config_ const&) -> typename std::enable_if<
+        is_std_string<T>::value, uint64_t
+    >::type
     {
-        ICECREAM_UNREACHABLE;
-        return "";
+        auto hasher = Xxh64{};
+        hasher.update(value.data(), value.size() * sizeof(*value.data()));
+        return hasher.digest();
     }
 
-    // Would be better if this function could be on calling site as a lambda
-    // function, however older compilers (gcc<=9 and clang<=10 for example) fail
-    // to see a parameter pack expansion when inside of a lambda.
+    // Any other value is hashed by its formatting, which also tells the changes of the
+    // objects seen through a string_view, a span, or a pointer.
     template <typename T>
-    auto concat_fmt(T const& t, std::string& fmt, size_t& i_arg, size_t n_args) -> void
+    auto hash_change(T const& value, Config_ const& config) -> typename std::enable_if<
+        !is_hashable_by_bytes<T>::value && !is_std_string<T>::value, uint64_t
+    >::type
     {
-        ++i_arg;
-        if (i_arg < n_args)
-        {
-            fmt += call_to_string(t);
-        }
+        auto const text = make_printing_branch(value, "", config).print();
+        auto hasher = Xxh64{};
+        hasher.update(text.data(), text.size());
+        return hasher.digest();
     }
 
-    // Returns a FormattingArgument where the value type is the same as the type
-    // of the last `args`, and the formatting string is the concatenation of all
-    // arguments except by the last.
-    template <typename... Ts>
-    auto make_formatting_argument(
-        Ts&&... args
-    ) -> FormattingArgument<typename std::tuple_element<sizeof...(Ts)-1, std::tuple<Ts&&...>>::type>
+    // An added, removed, or modified element of an IC_WATCH range.
+    struct WatchChange
     {
-        auto constexpr value_idx = sizeof...(Ts) - 1;
-        using T = typename std::tuple_element<value_idx, std::tuple<Ts&&...>>::type;
+        enum class Kind {added, removed, modified};
 
-        auto i_arg = size_t{0};
-        auto fmt = std::string{};
+        Kind kind;
 
-        // Build `fmt` as the concatenation of all args, except by the last,
-        // after converting them to a string through `call_to_string`.
-        (void) std::initializer_list<int>{
-            (concat_fmt(args, fmt, i_arg, sizeof...(Ts)), 0)...
-        };
+        // The element index, or its key, between brackets.
+        std::string path;
 
-        T value = std::get<value_idx>(std::forward_as_tuple(std::forward<Ts>(args)...));
-        return FormattingArgument<T>{fmt, std::forward<T>(value)};
-    }
+        // The formatted element before and after the change. Either one will be empty if
+        // the element was added or removed, and both if it is a set key.
+        std::string before;
+        std::string after;
+    };
 
+    // The changed elements of an IC_WATCH range since the previous call at the same site.
+    struct WatchChanges
+    {
+        std::vector<WatchChange> changes;
 
-    // Holds a triple of argument name, formatting string, and value. Those are
-    // all the info required to print an argument.
-    template <typename T>
-    struct PrintingArgument
+        // If the watched argument was a range at all.
+        bool is_range;
+    };
+
+    // The IC_WATCH values that are held by a copy, and compared to the new ones and hashed
+    // without being formatted. These are the values hashable by their bytes, and the
+    // strings, pairs, tuples, vectors, and maps of them. Any other value, like a pointer or
+    // a view, may see objects changing behind it, and so it is held formatted instead.
+    template <typename T, typename = void>
+    struct WatchCopy
     {
-        StringView name;
-        StringView fmt;
-        T&& value;
+        using is_supported = std::false_type;
     };
 
+    template <typename T>
+    using watch_copy_t = WatchCopy<typename std::remove_cv<T>::type>;
 
-    // Print a forest that fits into a single line.
-    inline auto print_one_line_forest(
-        StringView prefix,
-        StringView context,
-        StringView delimiter,
-        std::vector<std::tuple<StringView, PrintingNode>> const& forest
-    ) -> std::string
+    template <typename T>
+    struct WatchCopy<T, typename std::enable_if<is_hashable_by_bytes<T>::value>::type>
     {
-        auto result = prefix.to_string();
-        if (!context.empty())
+        using is_supported = std::true_type;
+
+        static auto equal(T const& a, T const& b) -> bool
         {
-            result += context.to_string() + delimiter.to_string();
+            return std::memcmp(std::addressof(a), std::addressof(b), sizeof(T)) == 0;
         }
 
-        for (auto it = forest.begin(); it != forest.end(); ++it)
+        static auto hash(Xxh64& hasher, T const& value) -> void
         {
-            auto const& arg_name = std::get<0>(*it);
-            auto const& tree = std::get<1>(*it);
+            hasher.update(std::addressof(value), sizeof(T));
+        }
+    };
 
-            result += arg_name.to_string() + ": " + tree.print();
+    template <typename C, typename Tr, typename A>
+    struct WatchCopy<std::basic_string<C, Tr, A>>
+    {
+        using is_supported = std::true_type;
 
-            if (it+1 != forest.end())
-            {
-                    result += ", ";
-            }
+        static auto equal(
+            std::basic_string<C, Tr, A> const& a, std::basic_string<C, Tr, A> const& b
+        ) -> bool
+        {
+            return a == b;
         }
 
-        return result;
-    }
+        static auto hash(Xxh64& hasher, std::basic_string<C, Tr, A> const& value) -> void
+        {
+            auto const size = value.size();
+            hasher.update(&size, sizeof(size));
+            hasher.update(value.data(), size * sizeof(C));
+        }
+    };
 
-    // Print a forest that will be broken on multiple lines.
-    inline auto print_multi_line_forest(
-        StringView prefix,
-        StringView context,
-        std::vector<std::tuple<StringView, PrintingNode>> const& forest,
-        size_t const line_wrap_width
-    ) -> std::string
+    template <typename A, typename B>
+    struct WatchCopy<std::pair<A, B>>
     {
-        auto result = prefix.to_string();
-        if (!context.empty())
+        using is_supported = conjunction<
+            typename watch_copy_t<A>::is_supported, typename watch_copy_t<B>::is_supported
+        >;
+
+        static auto equal(std::pair<A, B> const& a, std::pair<A, B> const& b) -> bool
         {
-            result += context.to_string();
+            return
+                watch_copy_t<A>::equal(a.first, b.first)
+                && watch_copy_t<B>::equal(a.second, b.second);
         }
-        result +=  + "\n";
 
-        for (auto it = forest.begin(); it != forest.end(); ++it)
+        static auto hash(Xxh64& hasher, std::pair<A, B> const& value) -> void
         {
-            auto const& arg_name = std::get<0>(*it);
-            auto const& tree = std::get<1>(*it);
+            watch_copy_t<A>::hash(hasher, value.first);
+            watch_copy_t<B>::hash(hasher, value.second);
+        }
+    };
 
-            result += std::string(Config_::INDENT_BASE, ' ') + arg_name.to_string() + ": ";
-            if (count_utf8_code_point(result) + tree.code_point_length() < line_wrap_width)
-            {
-                result += tree.print();
-            }
-            else
-            {
-                result += tree.print(2, line_wrap_width);
-            }
+    template <typename... Ts>
+    struct WatchCopy<std::tuple<Ts...>>
+    {
+        using is_supported = conjunction<typename watch_copy_t<Ts>::is_supported...>;
 
-            if (it+1 != forest.end())
-            {
-                result += ",\n";
-            }
+        static auto equal(std::tuple<Ts...> const& a, std::tuple<Ts...> const& b) -> bool
+        {
+            return WatchCopy::equal_from(a, b, std::integral_constant<size_t, 0>{});
         }
 
-        return result;
-    }
+        static auto hash(Xxh64& hasher, std::tuple<Ts...> const& value) -> void
+        {
+            WatchCopy::hash_from(hasher, value, std::integral_constant<size_t, 0>{});
+        }
 
-    template <typename... Ts>
-    auto build_forest(
-        Config_ const& config, PrintingArgument<Ts>&... args
-    ) -> std::vector<std::tuple<StringView, PrintingNode>>
-    {
-        auto forest = std::vector<std::tuple<StringView, PrintingNode>>{};
-        (void) std::initializer_list<int>{
-            (
-                (void) forest.emplace_back(
-                    args.name, make_printing_branch(args.value, args.fmt, config)
-                ),
-                0
-            )...
-        };
+    private:
+        template <size_t I>
+        static auto equal_from(
+            std::tuple<Ts...> const& a,
+            std::tuple<Ts...> const& b,
+            std::integral_constant<size_t, I>
+        ) -> typename std::enable_if<(I < sizeof...(Ts)), bool>::type
+        {
+            using E = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+            return
+                watch_copy_t<E>::equal(std::get<I>(a), std::get<I>(b))
+                && WatchCopy::equal_from(a, b, std::integral_constant<size_t, I + 1>{});
+        }
 
-        return forest;
-    }
+        template <size_t I>
+        static auto equal_from(
+            std::tuple<Ts...> const&,
+            std::tuple<Ts...> const&,
+            std::integral_constant<size_t, I>
+        ) -> typename std::enable_if<(I == sizeof...(Ts)), bool>::type
+        {
+            return true;
+        }
 
-    template <typename... Ts>
-    auto print_args(
-        Config_& config,
-        StringView file,
-        int line,
-        StringView function,
-        PrintingArgument<Ts>... args
-    ) -> typename std::enable_if<
-            detail::conjunction<detail::is_printable<Ts>...>::value
-        >::type
+        template <size_t I>
+        static auto hash_from(
+            Xxh64& hasher, std::tuple<Ts...> const& value, std::integral_constant<size_t, I>
+        ) -> typename std::enable_if<(I < sizeof...(Ts))>::type
+        {
+            using E = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+            watch_copy_t<E>::hash(hasher, std::get<I>(value));
+            WatchCopy::hash_from(hasher, value, std::integral_constant<size_t, I + 1>{});
+        }
+
+        template <size_t I>
+        static auto hash_from(
+            Xxh64&, std::tuple<Ts...> const&, std::integral_constant<size_t, I>
+        ) -> typename std::enable_if<(I == sizeof...(Ts))>::type
+        {}
+    };
+
+    // The containers whose copies are compared element by element, in their iteration
+    // order. That is the same for equal ordered containers, but not for unordered ones.
+    template <typename R>
+    struct WatchCopyContainer
     {
-      #if defined(ICECREAM_DISABLE)
-        return;
-      #endif
+        using Element = typename R::value_type;
 
-        if (!config.is_enabled()) return;
+        using is_supported = typename watch_copy_t<Element>::is_supported;
 
-        auto const prefix = config.gen_prefix();
-        auto const context =
-            [&]() -> std::string
+        static auto equal(R const& a, R const& b) -> bool
+        {
+            if (a.size() != b.size())
             {
-                // If used an empty IC macro, i.e.: IC().
-                if (config.include_context())
-                {
-                  #if defined(_MSC_VER)
-                    auto const n = file.rfind('\\');
-                  #else
-                    auto const n = file.rfind('/');
-                  #endif
-                    return
-                        file.substr(n+1).to_string()
-                        + ":"
-                        + std::to_string(line)
-                        + " in \""
-                        + function.to_string()
-                        + '"';
-                }
-                else
+                return false;
+            }
+
+            for (auto it_a = a.begin(), it_b = b.begin(); it_a != a.end(); ++it_a, ++it_b)
+            {
+                if (!watch_copy_t<Element>::equal(*it_a, *it_b))
                 {
-                    return "";
+                    return false;
                 }
-            }();
-        auto const delimiter = config.context_delimiter();
+            }
+            return true;
+        }
+
+        static auto hash(Xxh64& hasher, R const& value) -> void
+        {
+            auto const size = value.size();
+            hasher.update(&size, sizeof(size));
+            for (auto const& element : value)
+            {
+                watch_copy_t<Element>::hash(hasher, element);
+            }
+        }
+    };
+
+    template <typename E, typename A>
+    struct WatchCopy<std::vector<E, A>>: WatchCopyContainer<std::vector<E, A>> {};
+
+    template <typename K, typename V, typename C, typename A>
+    struct WatchCopy<std::map<K, V, C, A>>: WatchCopyContainer<std::map<K, V, C, A>> {};
+
+    template <typename K, typename V, typename C, typename A>
+    struct WatchCopy<std::multimap<K, V, C, A>>:
+        WatchCopyContainer<std::multimap<K, V, C, A>>
+    {};
 
-        auto const forest = build_forest(config, args...);
+    template <typename T>
+    using is_watch_copyable = typename watch_copy_t<T>::is_supported;
 
-        // The number of codepoints used if the whole forest would be printed in an one
-        // line.
-        auto const one_line_forest_n_code_points =
-            [&]() -> size_t
+    // The last seen value of a watched element, held formatted. It must be formatted again
+    // at every call to be compared, since it may see objects changing behind it.
+    template <typename E, typename = void>
+    class WatchSlot
+    {
+    public:
+        template <typename T>
+        WatchSlot(T const& element, Config_ const& config)
+            : text_(make_printing_branch(element, "", config).print())
+        {}
+
+        // Stores the `element`, and returns whether it differs from the previous one. When
+        // so, `before` and `after` are set to both formatted values.
+        template <typename T>
+        auto update(
+            T const& element, Config_ const& config, std::string& before, std::string& after
+        ) -> bool
+        {
+            auto text = make_printing_branch(element, "", config).print();
+            if (text == this->text_)
             {
-                auto n = count_utf8_code_point(prefix);
+                return false;
+            }
 
-                for (auto const& name_tree : forest)
-                {
-                    n +=
-                        count_utf8_code_point(std::get<0>(name_tree))
-                        + count_utf8_code_point(": ")
-                        + std::get<1>(name_tree).code_point_length();
-                }
+            before = std::move(this->text_);
+            this->text_ = std::move(text);
+            after = this->text_;
+            return true;
+        }
 
-                // The ", " separators between variables.
-                if (forest.size() > 1)
-                {
-                    n += (forest.size() - 1) * count_utf8_code_point(", ");
-                }
+        auto text(Config_ const&) const -> std::string
+        {
+            return this->text_;
+        }
 
-                return n;
-            }();
+    private:
+        std::string text_;
+    };
+
+    // A value held by a copy, and only formatted when it has changed.
+    template <typename E>
+    class WatchSlot<E, typename std::enable_if<is_watch_copyable<E>::value>::type>
+    {
+    public:
+        WatchSlot(E const& element, Config_ const&)
+            : value_(element)
+        {}
 
-        if (one_line_forest_n_code_points > config.line_wrap_width())
+        auto update(
+            E const& element, Config_ const& config, std::string& before, std::string& after
+        ) -> bool
         {
-            config.write_to_output(
-                config.transcode_output(
-                    print_multi_line_forest(
-                        prefix, context, forest, config.line_wrap_width()
-                    ).append("\n")
-                )
-            );
+            if (watch_copy_t<E>::equal(element, this->value_))
+            {
+                return false;
+            }
+
+            before = this->text(config);
+            this->value_ = element;
+            after = this->text(config);
+            return true;
         }
-        else
+
+        auto text(Config_ const& config) const -> std::string
         {
-            config.write_to_output(
-                config.transcode_output(
-                    print_one_line_forest(prefix, context, delimiter, forest).append("\n")
-                )
-            );
+            return make_printing_branch(this->value_, "", config).print();
         }
-    }
 
-    // Handles the printing of a nullary IC() call.
-    inline auto print_nullary(
-        Config_& config,
-        StringView file,
-        int line,
-        StringView function
-    ) -> void
+    private:
+        E value_;
+    };
+
+    // The key of a watched associative container element, held formatted. The `hash`
+    // function sets `text` to the formatted `key`, to be matched and stored without being
+    // formatted again.
+    template <typename K, typename = void>
+    class WatchKey
     {
-      #if defined(ICECREAM_DISABLE)
-        return;
-      #endif
+    public:
+        WatchKey(K const&, std::string&& text)
+            : text_(std::move(text))
+        {}
 
-        if (!config.is_enabled()) return;
+        static auto hash(K const& key, Config_ const& config, std::string& text) -> uint64_t
+        {
+            text = make_printing_branch(key, "", config).print();
+            auto hasher = Xxh64{};
+            hasher.update(text.data(), text.size());
+            return hasher.digest();
+        }
 
-        auto const prefix = config.gen_prefix();
-        auto const context =
-            [&]() -> std::string
-            {
-              #if defined(_MSC_VER)
-                auto const n = file.rfind('\\');
-              #else
-                auto const n = file.rfind('/');
-              #endif
+        auto matches(K const&, std::string const& text) const -> bool
+        {
+            return text == this->text_;
+        }
 
-                return
-                    file.substr(n+1).to_string()
-                    + ":"
-                    + std::to_string(line)
-                    + " in \""
-                    + function.to_string()
-                    + '"';
-            }();
+        auto text(Config_ const&) const -> std::string
+        {
+            return this->text_;
+        }
 
-        config.write_to_output(config.transcode_output(prefix + context + "\n"));
-    }
+    private:
+        std::string text_;
+    };
 
-    /** This function will receive a string as "foo, bar, baz" and return a vector with
-     * all the arguments split, such as ["foo", "bar", "baz"].
-     */
-    inline auto split_arguments(StringView all_names) -> std::vector<StringView>
+    // A key held by a copy, and only formatted when printed.
+    template <typename K>
+    class WatchKey<K, typename std::enable_if<is_watch_copyable<K>::value>::type>
     {
-        if (all_names.empty())
+    public:
+        WatchKey(K const& key, std::string&&)
+            : key_(key)
+        {}
+
+        static auto hash(K const& key, Config_ const&, std::string&) -> uint64_t
         {
-            return {};
+            auto hasher = Xxh64{};
+            watch_copy_t<K>::hash(hasher, key);
+            return hasher.digest();
         }
 
-        // Check if the '>' char is the closing of a template arguments listing. It will
-        // be a template closing at `std::is_same<int, int>::value` but not at `5 > 2`
-        auto is_closing_template =
-            [&all_names](size_t idx, size_t const last_idx) -> bool
-            {
-                auto curr_char = all_names[idx];
-                if (curr_char != '>' || idx == last_idx)
-                {
-                    return false;
-                }
+        auto matches(K const& key, std::string const&) const -> bool
+        {
+            return watch_copy_t<K>::equal(key, this->key_);
+        }
 
-                do
-                {
-                    ++idx;
-                    curr_char = all_names[idx];
-                } while (
-                    idx != last_idx
-                    && (
-                        curr_char == ' '
-                        || curr_char == '\t'
-                        || curr_char == '\n'
-                        || curr_char == '\r'
-                        || curr_char == '\f'
-                        || curr_char == '\v'
-                    )
-                );
+        auto text(Config_ const& config) const -> std::string
+        {
+            return make_printing_branch(this->key_, "", config).print();
+        }
 
-                return curr_char == ':' && idx != last_idx && all_names[idx + 1] == ':';
-            };
+    private:
+        K key_;
+    };
 
-        auto parenthesis_count = int{0};
-        auto angle_bracket_count = int{0};
-        auto curly_bracket_count = int{0};
-        auto is_within_double_quote = false;
-        auto is_within_single_quote = false;
+    // The slot of a set key, having no value besides the key itself.
+    struct EmptyWatchSlot
+    {
+        template <typename T>
+        EmptyWatchSlot(T const&, Config_ const&)
+        {}
 
-        // Parse the arguments string backward. It is easier this way to check if a '<' or
-        // '>' character is either a comparison operator, or a opening and closing of
-        // templates arguments.
-        auto comma_idxs = std::vector<size_t>{};
-        auto last_idx = all_names.size() - 1;
-        for (auto idx = all_names.size(); idx-- > 0;)
+        template <typename T>
+        auto update(T const&, Config_ const&, std::string&, std::string&) -> bool
         {
-            auto const curr_char = all_names[idx];
-            auto const prev_char = idx > 0 ? all_names[idx-1] : '\0';
+            return false;
+        }
 
-            if (is_within_double_quote)
-            {
-                // if current char is the left double quote
-                if (curr_char == '"' && prev_char != '\\') is_within_double_quote = false;
-            }
+        auto text(Config_ const&) const -> std::string
+        {
+            return std::string{};
+        }
+    };
 
-            else if (is_within_single_quote)
+    // The last seen elements of a watched sequence, identified by their positions.
+    template <typename R>
+    class SequenceWatchState
+    {
+    public:
+        using Slot = WatchSlot<remove_cvref_t<get_reference_t<get_iterator_t<R const>>>>;
+
+        auto update(
+            R const& range,
+            bool is_first,
+            Config_ const& config,
+            std::vector<WatchChange>& changes
+        ) -> void
+        {
+            auto before = std::string{};
+            auto after = std::string{};
+            auto idx = size_t{0};
+            for (auto it = begin(range), last = end(range); it != last; ++it, ++idx)
             {
-                // if current char is the left single quote
-                if (curr_char == '\'' && prev_char != '\\') is_within_single_quote = false;
+                if (idx < this->slots_.size())
+                {
+                    if (this->slots_[idx].update(*it, config, before, after))
+                    {
+                        changes.push_back(
+                            WatchChange{
+                                WatchChange::Kind::modified,
+                                "[" + std::to_string(idx) + "]",
+                                std::move(before),
+                                std::move(after)
+                            }
+                        );
+                    }
+                }
+                else
+                {
+                    this->slots_.push_back(Slot(*it, config));
+                    if (!is_first)
+                    {
+                        changes.push_back(
+                            WatchChange{
+                                WatchChange::Kind::added,
+                                "[" + std::to_string(idx) + "]",
+                                "",
+                                this->slots_.back().text(config)
+                            }
+                        );
+                    }
+                }
             }
 
-            else if (curr_char == '"' && prev_char != '\\')
+            for (auto i = idx; i < this->slots_.size(); ++i)
             {
-                is_within_double_quote = true;
+                changes.push_back(
+                    WatchChange{
+                        WatchChange::Kind::removed,
+                        "[" + std::to_string(i) + "]",
+                        this->slots_[i].text(config),
+                        ""
+                    }
+                );
             }
+            this->slots_.erase(
+                this->slots_.begin() + static_cast<std::ptrdiff_t>(idx), this->slots_.end()
+            );
+        }
 
-            else if (curr_char == '\'' && prev_char != '\\')
-            {
-                is_within_single_quote = true;
-            }
+    private:
+        std::vector<Slot> slots_;
+    };
 
-            // If it have found the comma separating two arguments
-            else if (
-                curr_char == ','
-                && parenthesis_count == 0
-                && angle_bracket_count == 0
-                && curly_bracket_count == 0
-            ) {
-                comma_idxs.push_back(idx);
-                last_idx = idx - 1;
-            }
+    template <typename E>
+    auto get_watch_key(E const& element, std::true_type) -> decltype((element.first))
+    {
+        return element.first;
+    }
 
-            // It won't cut on a comma within parentheses, such as when the argument is a
-            // function call, as in IC(foo(1, 2))
-            else if (curr_char == ')')
-            {
-                ++parenthesis_count;
-            }
+    template <typename E>
+    auto get_watch_key(E const& element, std::false_type) -> E const&
+    {
+        return element;
+    }
 
-            else if (curr_char == '(')
-            {
-                --parenthesis_count;
-            }
+    template <typename E>
+    auto get_watch_value(E const& element, std::true_type) -> decltype((element.second))
+    {
+        return element.second;
+    }
 
-            else if (curr_char == '}')
-            {
-                ++curly_bracket_count;
-            }
+    template <typename E>
+    auto get_watch_value(E const& element, std::false_type) -> E const&
+    {
+        return element;
+    }
 
-            else if (curr_char == '{')
+    // The slot of the values mapped by a keyed range, if any.
+    template <typename R, typename = void>
+    struct get_keyed_watch_slot
+    {
+        using type = EmptyWatchSlot;
+    };
+
+    template <typename R>
+    struct get_keyed_watch_slot<R, typename std::enable_if<is_mapped_range<R>::value>::type>
+    {
+        using type = WatchSlot<typename remove_cvref_t<R>::mapped_type>;
+    };
+
+    // The last seen elements of a watched associative container, identified by their keys.
+    // The entries are bucketed by the hashes of their keys, and within a bucket, matched
+    // by comparing the keys themselves. The elements of a multimap or a multiset having
+    // equal keys are matched in their iteration order. The removed elements are reported
+    // in the order they were last seen.
+    template <typename R>
+    class KeyedWatchState
+    {
+    public:
+        using Slot = typename get_keyed_watch_slot<R>::type;
+
+        auto update(
+            R const& range,
+            bool is_first,
+            Config_ const& config,
+            std::vector<WatchChange>& changes
+        ) -> void
+        {
+            auto const is_mapped = is_mapped_range<R>{};
+
+            ++this->generation_;
+            auto before = std::string{};
+            auto after = std::string{};
+            auto key_text = std::string{};
+            auto position = size_t{0};
+            for (auto it = begin(range), last = end(range); it != last; ++it, ++position)
             {
-                --curly_bracket_count;
+                auto const& key = get_watch_key(*it, is_mapped);
+                auto const& value = get_watch_value(*it, is_mapped);
+                auto& bucket = this->buckets_[Key::hash(key, config, key_text)];
+
+                // The first entry with an equal key not yet matched by this update
+                auto entry_it = bucket.begin();
+                while (
+                    entry_it != bucket.end()
+                    && (
+                        entry_it->generation == this->generation_
+                        || !entry_it->key.matches(key, key_text)
+                    )
+                ) {
+                    ++entry_it;
+                }
+
+                if (entry_it == bucket.end())
+                {
+                    auto entry = Entry{
+                        Key(key, std::move(key_text)),
+                        Slot(value, config),
+                        this->generation_,
+                        position
+                    };
+                    if (!is_first)
+                    {
+                        changes.push_back(
+                            WatchChange{
+                                WatchChange::Kind::added,
+                                "[" + entry.key.text(config) + "]",
+                                "",
+                                entry.slot.text(config)
+                            }
+                        );
+                    }
+                    bucket.push_back(std::move(entry));
+                }
+                else
+                {
+                    entry_it->generation = this->generation_;
+                    entry_it->position = position;
+
+                    if (entry_it->slot.update(value, config, before, after))
+                    {
+                        changes.push_back(
+                            WatchChange{
+                                WatchChange::Kind::modified,
+                                "[" + entry_it->key.text(config) + "]",
+                                std::move(before),
+                                std::move(after)
+                            }
+                        );
+                    }
+                }
             }
 
-            // It won't cut on a comma within a template argument list, such as in
-            // IC(std::is_same<int, int>::value)
-            else if (is_closing_template(idx, last_idx))
+            auto removed = std::vector<std::pair<size_t, WatchChange>>{};
+            for (auto bucket_it = this->buckets_.begin(); bucket_it != this->buckets_.end();)
             {
-                ++angle_bracket_count;
+                auto& bucket = bucket_it->second;
+                auto kept = bucket.begin();
+                for (auto it = bucket.begin(); it != bucket.end(); ++it)
+                {
+                    if (it->generation == this->generation_)
+                    {
+                        if (kept != it)
+                        {
+                            *kept = std::move(*it);
+                        }
+                        ++kept;
+                        continue;
+                    }
+
+                    removed.emplace_back(
+                        it->position,
+                        WatchChange{
+                            WatchChange::Kind::removed,
+                            "[" + it->key.text(config) + "]",
+                            it->slot.text(config),
+                            ""
+                        }
+                    );
+                }
+                bucket.erase(kept, bucket.end());
+
+                if (bucket.empty())
+                {
+                    bucket_it = this->buckets_.erase(bucket_it);
+                }
+                else
+                {
+                    ++bucket_it;
+                }
             }
 
-            else if (curr_char == '<' && angle_bracket_count > 0)
+            std::sort(
+                removed.begin(),
+                removed.end(),
+                [](
+                    std::pair<size_t, WatchChange> const& a,
+                    std::pair<size_t, WatchChange> const& b
+                ) {
+                    return a.first < b.first;
+                }
+            );
+            for (auto& item : removed)
             {
-                --angle_bracket_count;
+                changes.push_back(std::move(item.second));
             }
         }
 
-        auto result = split(all_names, {comma_idxs.rbegin(), comma_idxs.rend()});
-        for (auto& name : result)
+    private:
+        using Key = WatchKey<
+            remove_cvref_t<
+                decltype(
+                    get_watch_key(
+                        std::declval<get_reference_t<get_iterator_t<R const>>>(),
+                        is_mapped_range<R>{}
+                    )
+                )
+            >
+        >;
+
+        struct Entry
         {
-            name.trim();
-        }
+            Key key;
+            Slot slot;
+            size_t generation;
+            size_t position;
+        };
 
-        return result;
-    }
+        std::unordered_map<uint64_t, std::vector<Entry>> buckets_;
+        size_t generation_ = 0;
+    };
 
-    template <typename T>
-    auto get_value(T&& t) ->
-        typename std::enable_if<
-            !is_instantiation<FormattingArgument, remove_cvref_t<T>>::value,
-            T&&
-        >::type
+    // Compares a sequence `range` to the elements last seen by the `cache` call site,
+    // collecting the changes and storing the new elements. Returns whether this was the
+    // first call, that has nothing to compare to.
+    template <typename R>
+    auto update_watch(
+        SiteWatchCache& cache, R const& range, Config_ const& config, WatchChanges& result
+    ) -> typename std::enable_if<
+        is_range<R const&>::value && !is_keyed_range<R>::value, bool
+    >::type
     {
-        return std::forward<T>(t);
+        std::lock_guard<std::mutex> guard(cache.mutex);
+        auto is_first = false;
+        auto& state = cache.get_state<SequenceWatchState<R>>(is_first);
+        state.update(range, is_first, config, result.changes);
+        result.is_range = true;
+        return is_first;
     }
 
-    template <typename T>
-    auto get_value(T&& t) ->
-        typename std::enable_if<
-            is_instantiation<FormattingArgument, remove_cvref_t<T>>::value,
-            decltype(t.value)
-        >::type
+    // Compares an associative container `range`
+    template <typename R>
+    auto update_watch(
+        SiteWatchCache& cache, R const& range, Config_ const& config, WatchChanges& result
+    ) -> typename std::enable_if<
+        is_range<R const&>::value && is_keyed_range<R>::value, bool
+    >::type
     {
-        return std::forward<decltype(t.value)>(t.value);
+        std::lock_guard<std::mutex> guard(cache.mutex);
+        auto is_first = false;
+        auto& state = cache.get_state<KeyedWatchState<R>>(is_first);
+        state.update(range, is_first, config, result.changes);
+        result.is_range = true;
+        return is_first;
     }
 
     template <typename T>
-    auto get_fmt(T const&, StringView default_format) -> StringView
+    auto update_watch(
+        SiteWatchCache&, T const&, Config_ const&, WatchChanges& result
+    ) -> typename std::enable_if<!is_range<T const&>::value, bool>::type
     {
-        return default_format;
+        result.is_range = false;
+        return false;
     }
 
     template <typename T>
-    auto get_fmt(FormattingArgument<T> const& t, StringView) -> StringView
+    auto make_printing_branch(
+        T&& value, StringView, Config_ const& config
+    ) -> typename std::enable_if<is_watch_changes<remove_cvref_t<T>>::value, PrintingNode>::type
     {
-        return t.fmt;
+        if (!value.is_range)
+        {
+            return PrintingNode("<IC_WATCH argument must be a range>");
+        }
+
+        auto children = RangeChildren(config.max_range_elements());
+        for (auto const& change : value.changes)
+        {
+            if (children.is_full())
+            {
+                auto const n_left = value.changes.size() - children.n_elements();
+                children.push_marker("..., <" + std::to_string(n_left) + " more>");
+                break;
+            }
+
+            auto text = std::string{};
+            switch (change.kind)
+            {
+            case WatchChange::Kind::added:
+                text = change.after.empty() ? "added" : "added " + change.after;
+                break;
+            case WatchChange::Kind::removed:
+                text = change.before.empty() ? "removed" : "removed " + change.before;
+                break;
+            case WatchChange::Kind::modified:
+                text = change.before + " -> " + change.after;
+                break;
+            }
+            children.push_node(make_labeled_node(change.path + ": ", PrintingNode(text)));
+        }
+
+        return PrintingNode("{", ", ", "}", children.release());
     }
 
     // The use of this struct instead of a free function is a needed hack because of the
@@ -5389,16 +12091,23 @@ namespace detail {
         Dispatcher(
             bool is_ic_apply,
             Config_& config,
+            SiteSlot<SiteFilterCache>& site_slot,
+            SiteTag tag,
             StringView file,
             int line,
+            int column,
             StringView function,
             StringView default_format,
             StringView arg_names
         )
             : is_ic_apply_(is_ic_apply)
+            , is_enabled_(config.is_enabled())
             , config_(config)
+            , site_slot_(&site_slot)
+            , tag_(tag)
             , file_(file)
             , line_{line}
+            , column_{column}
             , function_(function)
             , default_format_(default_format)
             , arg_names_(arg_names)
@@ -5409,29 +12118,188 @@ namespace detail {
         Dispatcher(
             bool is_ic_apply,
             Config_& config,
+            SiteSlot<SiteFilterCache>& site_slot,
+            SiteTag tag,
             StringView file,
             int line,
+            int column,
             StringView function,
             StringView default_format
         )
-            : Dispatcher(is_ic_apply, config, file, line, function, default_format, "")
+            : Dispatcher(
+                is_ic_apply,
+                config,
+                site_slot,
+                tag,
+                file,
+                line,
+                column,
+                function,
+                default_format,
+                ""
+            )
         {}
 
+        // The Dispatcher of a call site whose `config` was found disabled by the IC macro,
+        // before building the call site information. It will never print anything.
+        static auto disabled(Config_& config) -> Dispatcher
+        {
+            return Dispatcher(config);
+        }
+
+        // Sets the severity `level` of a leveled IC call, to be checked against the level
+        // of each sink. An empty `level` is the one of an unleveled call.
+        auto at_level(Optional<Level> level) -> Dispatcher&
+        {
+            this->level_ = std::move(level);
+            return *this;
+        }
+
+        // Whether this call site should print, given the enabled state of its config and
+        // the call site filter. A call site with a non constant tag will decide it again at
+        // every call. The decision doesn't depend on the IC arguments, so they are left out
+        // of the key of the cached one.
+        auto is_active() -> bool
+        {
+            if (!this->is_enabled_)
+            {
+                return false;
+            }
+
+            if (ICECREAM_LIKELY(this->tag_.is_constant))
+            {
+                return this->site_slot_
+                    ->get(this->site_key("", this->tag_.text))
+                    .is_allowed(this->file_, this->line_, this->function_, this->tag_.text);
+            }
+
+            auto const state = SiteFilter::global().decide(
+                this->file_, this->line_, this->function_, this->tag_.text
+            );
+            return (state & 1u) != 0;
+        }
+
         // Runs the Dispatcher and returns the same unique argument.
         // It is called when printing only one value, e.g.: IC(v0)
         template <typename T>
         auto unary_run(T&& arg) -> T&&
         {
-            this->dispatch(make_int_sequence<1>(), arg);
+          #if !defined(ICECREAM_DISABLE)
+            if (ICECREAM_UNLIKELY(this->is_active()))
+            {
+                this->dispatch(make_int_sequence<1>(), arg);
+            }
+          #endif
+            return std::forward<T>(arg);
+        }
+
+        // Runs the Dispatcher printing the object representation of `arg`, and returns it.
+        // It is called by the IC_BYTES macro.
+        template <typename T>
+        auto bytes_run(T&& arg) -> T&&
+        {
+          #if !defined(ICECREAM_DISABLE)
+            if (ICECREAM_UNLIKELY(this->is_active()))
+            {
+                this->dispatch(make_int_sequence<1>(), ObjectBytes(arg));
+            }
+          #endif
+            return std::forward<T>(arg);
+        }
+
+        // Runs the Dispatcher only if `arg` has changed since the last value seen by the
+        // `cache`, and returns it. It is called by the IC_ON_CHANGE macro.
+        template <typename T>
+        auto change_run(SiteSlot<SiteChangeCache>& slot, T&& arg) -> T&&
+        {
+          #if !defined(ICECREAM_DISABLE)
+            if (
+                ICECREAM_UNLIKELY(this->is_active())
+                && slot.get(this->site_key(this->arg_names_, ""))
+                    .update(hash_change(arg, this->config_))
+            ) {
+                this->dispatch(make_int_sequence<1>(), arg);
+            }
+          #else
+            (void) slot;
+          #endif
+            return std::forward<T>(arg);
+        }
+
+        // Runs the Dispatcher printing the elements of the `arg` range that have changed
+        // since the last call at the same site, and returns it. The whole range is printed
+        // on the first call. It is called by the IC_WATCH macro.
+        template <typename T>
+        auto watch_run(SiteSlot<SiteWatchCache>& slot, T&& arg) -> T&&
+        {
+          #if !defined(ICECREAM_DISABLE)
+            if (ICECREAM_UNLIKELY(this->is_active()))
+            {
+                auto& cache = slot.get(this->site_key(this->arg_names_, ""));
+                auto result = WatchChanges{{}, false};
+                if (update_watch(cache, arg, this->config_, result))
+                {
+                    this->dispatch(make_int_sequence<1>(), arg);
+                }
+                else if (!result.changes.empty() || !result.is_range)
+                {
+                    this->dispatch(make_int_sequence<1>(), result);
+                }
+            }
+          #else
+            (void) slot;
+          #endif
             return std::forward<T>(arg);
         }
 
+        // Runs the Dispatcher printing the mismatches between the `left` and `right` ranges,
+        // or tuples, under the name "left vs right". It is called by the IC_CMP macro.
+        template <typename L, typename R>
+        auto cmp_run(L const& left, R const& right, double tolerance = 0.0) -> void
+        {
+          #if !defined(ICECREAM_DISABLE)
+            if (ICECREAM_UNLIKELY(this->is_active()))
+            {
+                auto const names = split_arguments(this->arg_names_);
+                auto const name = names.at(0).to_string() + " vs " + names.at(1).to_string();
+                this->arg_names_ = name;
+                this->dispatch(
+                    make_int_sequence<1>(), Comparison<L, R>{left, right, tolerance}
+                );
+            }
+          #else
+            (void) left;
+            (void) right;
+            (void) tolerance;
+          #endif
+        }
+
         // Runs the Dispatcher and returns nothing.
         // It is called when printing zero or multiple values, e.g.: IC(), IC(v0, v1)
         template <typename... Ts>
         auto unary_run(Ts&&... args) -> void
         {
+          #if !defined(ICECREAM_DISABLE)
+            if (ICECREAM_UNLIKELY(this->is_active()))
+            {
+                this->dispatch(make_int_sequence<sizeof...(Ts)>(), args...);
+            }
+          #else
+            (void) std::initializer_list<int>{((void) args, 0)...};
+          #endif
+        }
+
+        // Runs the Dispatcher and returns nothing, without checking again whether it is
+        // active. It is called by the IC_IF macro, that has checked it before evaluating
+        // the arguments.
+        template <typename... Ts>
+        auto if_run(Ts&&... args) -> void
+        {
+          #if !defined(ICECREAM_DISABLE)
             this->dispatch(make_int_sequence<sizeof...(Ts)>(), args...);
+          #else
+            (void) std::initializer_list<int>{((void) args, 0)...};
+          #endif
         }
 
         // Runs the Dispatcher and returns a tuple with all the arguments.
@@ -5444,13 +12312,21 @@ namespace detail {
         template <typename... Ts>
         auto tuple_run(Ts&&... args) -> std::tuple<custody_t<Ts>...>
         {
-            this->dispatch(make_int_sequence<sizeof...(Ts)>(), args...);
+          #if !defined(ICECREAM_DISABLE)
+            if (ICECREAM_UNLIKELY(this->is_active()))
+            {
+                this->dispatch(make_int_sequence<sizeof...(Ts)>(), args...);
+            }
+          #endif
             return std::tuple<custody_t<Ts>...>(std::forward<Ts>(args)...);
         }
 
     private:
+        // All the printing work lives here, out of line, so that a disabled IC call will
+        // cost only the `is_enabled` test at the call site. When ICECREAM_DISABLE is
+        // defined this method isn't even instantiated.
         template <size_t... N, typename... Ts>
-        auto dispatch(int_sequence<N...>, Ts&&... args) -> void
+        ICECREAM_COLD auto dispatch(int_sequence<N...>, Ts&&... args) -> void
         {
             // Pick the name of an IC macro's "to be printed" argument. Usually that would
             // just return the argument string itself. However, when using the IC_ macro
@@ -5491,7 +12367,7 @@ namespace detail {
             {
                 // Even if it has no arguments (besides the callable name), an `IC_A`
                 // macro isn't a nullary `IC()` call.
-                print_nullary(config_, file_, line_, function_);
+                print_nullary(config_, file_, line_, function_, level_);
             }
             else
             {
@@ -5500,6 +12376,7 @@ namespace detail {
                     file_,
                     line_,
                     function_,
+                    level_,
                     PrintingArgument<formatting_argumet_type<Ts>>{
                         arg_names.at(N),
                         get_fmt(args, this->default_format_),
@@ -5509,13 +12386,40 @@ namespace detail {
             }
         }
 
+        auto site_key(StringView names, StringView tag) const -> SiteKey
+        {
+            return SiteKey{
+                this->file_, this->line_, this->column_, this->function_, names, tag
+            };
+        }
+
+        explicit Dispatcher(Config_& config)
+            : is_ic_apply_(false)
+            , is_enabled_(false)
+            , config_(config)
+            , site_slot_(nullptr)
+            , tag_{StringView{}, true}
+            , line_{0}
+            , column_{0}
+        {}
+
         bool is_ic_apply_;
+
+        // Whether the `config` was enabled when this Dispatcher was built.
+        bool is_enabled_;
+
         Config_& config_;
+        SiteSlot<SiteFilterCache>* site_slot_;
+        SiteTag tag_;
         StringView file_;
         int line_;
+        int column_;
         StringView function_;
         StringView default_format_;
         StringView arg_names_;
+
+        // The severity of a leveled IC call.
+        Optional<Level> level_;
     };
 
     // --------------------------------------------------- Range View
@@ -5527,11 +12431,21 @@ namespace detail {
         Proj proj_;
         std::string elements_fmt_;
         Optional<Slice> mb_slice_;
+
+        // The slicing before a "stats" keyword, when printing the statistics of the
+        // elements instead of each one of them.
+        Optional<std::string> mb_stats_slicing_;
+
+        // If only the elements whose projections aren't zero will be printed.
+        bool is_nonzero_ = false;
+
         Config_* config_ = nullptr;
+        SiteSlot<SiteFilterCache>* site_slot_ = nullptr;
         int line_;
+        int column_;
         std::string src_location_;
-        std::string file_;
-        std::string function_;
+        StringView file_;
+        StringView function_;
 
         RangeViewArgs(Optional<std::string> const& name, std::string const& fmt, Proj&& proj)
             : mb_name_(name)
@@ -5541,21 +12455,39 @@ namespace detail {
             auto elements_fmt = StringView{};
             std::tie(view_fmt, elements_fmt) = split_range_fmt_string(fmt);
             this->elements_fmt_ = elements_fmt.to_string();
+
+            auto const mb_stats_slicing = split_range_fmt_keyword(view_fmt, "stats");
+            auto const mb_nonzero_slicing = split_range_fmt_keyword(view_fmt, "nonzero");
+            if (mb_stats_slicing)
+            {
+                view_fmt = *mb_stats_slicing;
+                this->mb_stats_slicing_ = view_fmt.to_string();
+            }
+            else if (mb_nonzero_slicing)
+            {
+                view_fmt = *mb_nonzero_slicing;
+                this->is_nonzero_ = true;
+            }
+
             this->mb_slice_ = Slice::build(view_fmt);
         }
 
         auto complete(
             Config_& config,
+            SiteSlot<SiteFilterCache>& site_slot,
             int line,
-            std::string file,
-            std::string function
+            int column,
+            StringView file,
+            StringView function
           #if defined(ICECREAM_SOURCE_LOCATION)
             ,std::source_location const location = std::source_location::current()
           #endif
         ) -> RangeViewArgs&
         {
             this->config_ = &config;
+            this->site_slot_ = &site_slot;
             this->line_ = line;
+            this->column_ = column;
             this->file_ = file;
             this->function_ = function;
 
@@ -5610,6 +12542,30 @@ namespace detail {
     }
 
 
+    // Holds the statistics of the elements yielded by a range view with a "stats"
+    // formatting string, and prints them when the last copy of that view is destroyed.
+    struct ViewStatsPrinter
+    {
+        // The RangeStats of the yielded elements type, built when that type is known,
+        // either with the viewed range or with the first yielded element.
+        std::shared_ptr<void> stats;
+
+        std::function<void()> print;
+
+        ~ViewStatsPrinter()
+        {
+            if (this->print)
+            {
+                try
+                {
+                    this->print();
+                }
+                catch (...)
+                {}
+            }
+        }
+    };
+
     template <typename Proj>
     struct RangeView
     {
@@ -5618,9 +12574,11 @@ namespace detail {
         Optional<Slice> mb_slice;
         std::string elements_fmt;
         Config_& config;
+        SiteSlot<SiteFilterCache>& site_slot;
         int line;
-        std::string file;
-        std::string function;
+        int column;
+        StringView file;
+        StringView function;
 
         int current_idx = 0;
         ptrdiff_t start;
@@ -5628,6 +12586,12 @@ namespace detail {
         ptrdiff_t step;
         Optional<std::string> slice_error;
 
+        // Shared among all the copies of this view when printing the elements statistics.
+        std::shared_ptr<ViewStatsPrinter> stats_printer;
+        std::string stats_slicing;
+
+        bool is_nonzero;
+
         explicit RangeView(RangeViewArgs<Proj> par)
             : name(
                 par.mb_name_ ? *par.mb_name_ : std::string{"range_view_"} + par.src_location_
@@ -5636,10 +12600,20 @@ namespace detail {
             , mb_slice(par.mb_slice_)
             , elements_fmt(par.elements_fmt_)
             , config(*par.config_)
+            , site_slot(*par.site_slot_)
             , line(par.line_)
+            , column(par.column_)
             , file(par.file_)
             , function(par.function_)
-        {}
+            , stats_printer(par.mb_stats_slicing_ ? new ViewStatsPrinter : nullptr)
+            , stats_slicing(par.mb_stats_slicing_ ? *par.mb_stats_slicing_ : std::string{})
+            , is_nonzero(par.is_nonzero_)
+        {
+            if (this->stats_printer)
+            {
+                this->print_empty_stats_at_end();
+            }
+        }
 
         auto normalize_slice() -> void
         {
@@ -5675,6 +12649,14 @@ namespace detail {
         template <typename R>
         auto normalize_slice(R&& range) -> void
         {
+            if (this->stats_printer)
+            {
+                using TConst = typename std::add_const<
+                    remove_ref_t<get_reference_t<get_iterator_t<R>>>
+                >::type;
+                this->init_stats<remove_cvref_t<decltype(this->proj(std::declval<TConst&>()))>>();
+            }
+
             if (!this->mb_slice)
             {
                 this->slice_error = std::string{"<invalid slice formatting string>"};
@@ -5720,12 +12702,54 @@ namespace detail {
         auto operator()(T&& element) -> T&&
         {
             auto const idx = this->current_idx++;
+
+          #if !defined(ICECREAM_DISABLE)
+            if (
+                ICECREAM_UNLIKELY(
+                    this->config.is_enabled()
+                    && this->site_slot
+                        .get(
+                            SiteKey{this->file, this->line, this->column, this->function, "", ""}
+                        )
+                        .is_allowed(this->file, this->line, this->function, "")
+                )
+            ){
+                this->print_element(idx, element);
+            }
+          #else
+            (void) idx;
+          #endif
+
+            return std::forward<T>(element);
+        }
+
+    private:
+        template <typename T>
+        ICECREAM_COLD auto print_element(int idx, T& element) -> void
+        {
+            auto const is_selected =
+                this->start <= idx && idx < this->stop
+                && ((idx - this->start) % this->step) == 0;
+
+            if (this->stats_printer && !this->slice_error)
+            {
+                if (is_selected)
+                {
+                    using TConst = typename std::add_const<remove_ref_t<T>>::type;
+                    this->push_stats(this->proj(const_cast<TConst&>(element)));
+                }
+                return;
+            }
+
             auto const arg_name = this->name + "[" + std::to_string(idx) + "]";
             auto dispatcher = Dispatcher{
                 false,
                 this->config,
+                this->site_slot,
+                make_site_tag(""),
                 this->file,
                 this->line,
+                this->column,
                 this->function,
                 this->elements_fmt,
                 arg_name
@@ -5735,15 +12759,118 @@ namespace detail {
             {
                 dispatcher.unary_run(*this->slice_error);
             }
-            else if (
-                this->start <= idx && idx < this->stop
-                && ((idx - this->start) % this->step) == 0
-            ) {
+            else if (is_selected && this->is_nonzero)
+            {
+                using TConst = typename std::add_const<remove_ref_t<T>>::type;
+                this->print_nonzero(dispatcher, this->proj(const_cast<TConst&>(element)));
+            }
+            else if (is_selected)
+            {
                 using TConst = typename std::add_const<remove_ref_t<T>>::type;
                 dispatcher.unary_run(this->proj(const_cast<TConst&>(element)));
             }
+        }
 
-            return std::forward<T>(element);
+        template <typename T>
+        auto print_nonzero(Dispatcher& dispatcher, T&& value) ->
+            typename std::enable_if<is_nonzero_number<T>::value>::type
+        {
+            if (value != 0)
+            {
+                dispatcher.unary_run(std::forward<T>(value));
+            }
+        }
+
+        template <typename T>
+        auto print_nonzero(Dispatcher& dispatcher, T&&) ->
+            typename std::enable_if<!is_nonzero_number<T>::value>::type
+        {
+            dispatcher.unary_run(std::string{"<this range doesn't support nonzero formatting>"});
+        }
+
+        // Prints `value`, which will be a RangeStats or an error message, as the view
+        // argument when the `stats_printer` is destroyed.
+        template <typename T>
+        auto print_at_end(std::shared_ptr<T> value) -> void
+        {
+            auto& config_ = this->config;
+            auto& site_slot_ = this->site_slot;
+            auto const file_ = this->file;
+            auto const line_ = this->line;
+            auto const column_ = this->column;
+            auto const function_ = this->function;
+            auto const elements_fmt_ = this->elements_fmt;
+            auto const name_ = this->name;
+
+            this->stats_printer->stats = value;
+            this->stats_printer->print =
+                [
+                    &config_, &site_slot_, file_, line_, column_, function_, elements_fmt_,
+                    name_, value
+                ]()
+                {
+                    Dispatcher{
+                        false,
+                        config_,
+                        site_slot_,
+                        make_site_tag(""),
+                        file_,
+                        line_,
+                        column_,
+                        function_,
+                        elements_fmt_,
+                        name_
+                    }.unary_run(*value);
+                };
+        }
+
+        // While the type of the elements isn't known, the statistics of no elements are
+        // printed as the ones of an integer range.
+        auto print_empty_stats_at_end() -> void
+        {
+            this->print_at_end(std::make_shared<RangeStats<int>>(this->stats_slicing));
+            this->stats_printer->stats.reset();
+        }
+
+        // Builds the statistics of elements of type T, if not built yet.
+        template <typename T>
+        auto init_stats() ->
+            typename std::enable_if<is_stats_number<T>::value>::type
+        {
+            if (!this->stats_printer->stats)
+            {
+                this->print_at_end(std::make_shared<RangeStats<T>>(this->stats_slicing));
+            }
+        }
+
+        template <typename T>
+        auto init_stats() ->
+            typename std::enable_if<!is_stats_number<T>::value>::type
+        {
+            if (!this->stats_printer->stats)
+            {
+                this->print_at_end(
+                    std::make_shared<std::string>("<this range doesn't support stats formatting>")
+                );
+            }
+        }
+
+        template <typename T>
+        auto push_stats(T const& value) ->
+            typename std::enable_if<is_stats_number<T>::value>::type
+        {
+            using Stats = RangeStats<remove_cvref_t<T>>;
+            this->init_stats<remove_cvref_t<T>>();
+
+            // All the elements yielded by a view have the same type.
+            static_cast<Stats*>(this->stats_printer->stats.get())->push(value);
+        }
+
+        template <typename T>
+        auto push_stats(T const&) ->
+            typename std::enable_if<!is_stats_number<T>::value>::type
+        {
+            this->init_stats<remove_cvref_t<T>>();
         }
     };
 
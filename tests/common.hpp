@@ -2,6 +2,7 @@
 #define TESTS_COMMON_HPP_INCLUDED
 
 #include <ostream>
+#include <string>
 
 #if defined(_MSC_VER)
   #pragma warning(push)
@@ -22,6 +23,16 @@ inline auto sum(int i0, int i1) -> int
 }
 
 
+// An IC_ON_CHANGE call site within an inline function, shared by all the translation
+// units including this header.
+inline auto print_on_change(std::string& str, int value) -> void
+{
+    IC_CONFIG_SCOPE();
+    IC_CONFIG.output(str);
+    IC_ON_CHANGE(value);
+}
+
+
 class MyClass
 {
 public:
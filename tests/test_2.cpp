@@ -1,3 +1,10 @@
 // Header used to catch multiple symbol definition
 
 #include "icecream.hpp"
+#include "common.hpp"
+
+
+auto print_on_change_in_test_2(std::string& str, int value) -> void
+{
+    print_on_change(str, value);
+}
@@ -16,8 +16,12 @@
 #include <boost/optional/optional_io.hpp>
 #include <boost/smart_ptr.hpp>
 #include <boost/variant2/variant.hpp>
-
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <forward_list>
 #include <list>
+#include <map>
 #include <sstream>
 #include <type_traits>
 #include <utility>
@@ -63,6 +67,19 @@ auto operator<<(std::ostream& os, MyIterable<NonPrintable> const&) -> std::ostre
 }
 
 
+struct Padded
+{
+    char c;
+    int i;
+};
+
+auto operator<<(std::ostream& os, Padded const& value) -> std::ostream&
+{
+    os << value.c << value.i;
+    return os;
+}
+
+
 auto return_7() -> int
 {
     return 7;
@@ -242,7 +259,7 @@ TEST_CASE("base")
         auto str = std::string{};
 
         test_empty_ic(str);
-        REQUIRE_THAT(str, Catch::StartsWith("ic| test_c++11.cpp:36 in"));
+        REQUIRE_THAT(str, Catch::StartsWith("ic| test_c++11.cpp:40 in"));
         REQUIRE_THAT(str, Catch::Contains("test_empty_ic("));
     }
 
@@ -417,6 +434,16 @@ TEST_CASE("base")
         REQUIRE(str == "ic| v1: 97\n");
     }
 
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        signed char v1{-3};
+        IC(v1);
+        REQUIRE(str == "ic| v1: -3\n");
+    }
+
     {
         IC_CONFIG_SCOPE();
         auto str = std::string{};
@@ -467,6 +494,49 @@ TEST_CASE("return")
 }
 
 
+TEST_CASE("conditional")
+{
+    auto n_calls = 0;
+    auto counted = [&](int i) {++n_calls; return i;};
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        IC_IF(n_calls == 0, counted(1), 2);
+        REQUIRE(str == "ic| counted(1): 1, 2: 2\n");
+        REQUIRE(n_calls == 1);
+
+        str.clear();
+        IC_IF(n_calls == 0, counted(3));
+        REQUIRE(str.empty());
+        REQUIRE(n_calls == 1);
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+        IC_CONFIG.disable();
+
+        IC_IF(true, counted(4));
+        REQUIRE(str.empty());
+        REQUIRE(n_calls == 1);
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = 10;
+        IC_IF(v0 > 5, IC_("#x", v0));
+        REQUIRE(str == "ic| v0: 0xa\n");
+    }
+}
+
+
 TEST_CASE("boost_optional")
 {
     IC_CONFIG_SCOPE();
@@ -963,6 +1033,912 @@ TEST_CASE("line_wrap")
 }
 
 
+TEST_CASE("printing_limits")
+{
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+        IC_CONFIG.max_range_elements(3);
+
+        auto v0 = std::vector<int>(1000, 7);
+        IC(v0);
+        REQUIRE(str == "ic| v0: [7, 7, 7, ..., <997 more>]\n");
+        str.clear();
+
+        auto v1 = std::vector<int>{1, 2, 3};
+        IC(v1);
+        REQUIRE(str == "ic| v1: [1, 2, 3]\n");
+        str.clear();
+
+        auto v2 = std::forward_list<int>{1, 2, 3, 4, 5};
+        IC(v2);
+        REQUIRE(str == "ic| v2: [1, 2, 3, ...]\n");
+        str.clear();
+
+        IC_F("[1:]", v0);
+        REQUIRE(str == "ic| v0: [1:]->[7, 7, 7, ...]\n");
+        str.clear();
+
+        IC_CONFIG.max_range_elements(0);
+        IC(v1);
+        REQUIRE(str == "ic| v1: [..., <3 more>]\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+        IC_CONFIG.max_nesting_depth(2);
+
+        auto v0 = std::vector<std::vector<std::vector<int>>>{{{1, 2}}, {}};
+        IC(v0);
+        REQUIRE(str == "ic| v0: [[[...]], []]\n");
+        str.clear();
+
+        auto v1 = std::vector<std::tuple<int, std::pair<int, int>>>{
+            std::make_tuple(1, std::make_pair(2, 3))
+        };
+        IC(v1);
+        REQUIRE(str == "ic| v1: [(1, (...))]\n");
+        str.clear();
+
+        IC_CONFIG.max_nesting_depth(0);
+        IC(v0);
+        REQUIRE(str == "ic| v0: [...]\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+        IC_CONFIG.max_string_length(5);
+
+        auto s0 = std::string{"abcdefgh"};
+        IC(s0);
+        REQUIRE(str == "ic| s0: \"abcde\"...<3 more>\n");
+        str.clear();
+
+        IC_F("s", s0);
+        REQUIRE(str == "ic| s0: abcde...<3 more>\n");
+        str.clear();
+
+        auto s1 = "abcde";
+        IC(s1);
+        REQUIRE(str == "ic| s1: \"abcde\"\n");
+        str.clear();
+
+        // A multi byte character is never split
+        auto s2 = std::string{"abcd\xc3\xa9"};
+        IC(s2);
+        REQUIRE(str == "ic| s2: \"abcd\"...<2 more>\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+        IC_CONFIG.max_output_bytes(10);
+
+        auto v0 = std::vector<int>{100, 200, 300, 400, 500};
+        auto i0 = 7;
+        IC(v0, i0);
+        REQUIRE(str == "ic| v0: [100, 200, 300, 400, ..., <1 more>], i0: ...\n");
+        str.clear();
+
+        IC_CONFIG.max_output_bytes(2);
+        auto t0 = std::make_tuple(10, 20, 30);
+        IC(t0);
+        REQUIRE(str == "ic| t0: (10, 20, ...)\n");
+        str.clear();
+
+        IC_CONFIG.max_output_bytes(4);
+        auto s0 = std::string{"abcdefgh"};
+        IC(s0);
+        REQUIRE(str == "ic| s0: \"abcd\"...<4 more>\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+        IC_CONFIG.range_edge_items(2);
+
+        auto v0 = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        IC(v0);
+        REQUIRE(str == "ic| v0: [0, 1, ..., <6 more>, 8, 9]\n");
+        str.clear();
+
+        auto v1 = std::vector<int>{1, 2, 3, 4};
+        IC(v1);
+        REQUIRE(str == "ic| v1: [1, 2, 3, 4]\n");
+        str.clear();
+
+        auto v2 = std::forward_list<int>{0, 1, 2, 3, 4, 5, 6};
+        IC(v2);
+        REQUIRE(str == "ic| v2: [0, 1, ..., <3 more>, 5, 6]\n");
+        str.clear();
+
+        auto v3 = std::forward_list<int>{1, 2, 3};
+        IC(v3);
+        REQUIRE(str == "ic| v3: [1, 2, 3]\n");
+        str.clear();
+
+        IC_F("[1:]", v0);
+        REQUIRE(str == "ic| v0: [1:]->[1, 2, ..., <5 more>, 8, 9]\n");
+        str.clear();
+
+        IC_F("[1::2]", v0);
+        REQUIRE(str == "ic| v0: [1::2]->[1, 3, ..., <1 more>, 7, 9]\n");
+        str.clear();
+
+        IC_F("[8:0:-1]", v0);
+        REQUIRE(str == "ic| v0: [8:0:-1]->[8, 7, ..., <4 more>, 2, 1]\n");
+        str.clear();
+
+        auto v4 = std::list<std::vector<int>>(5, v0);
+        IC_CONFIG.line_wrap_width(200);
+        IC(v4);
+        REQUIRE(
+            str ==
+            "ic| v4: ["
+                "[0, 1, ..., <6 more>, 8, 9], [0, 1, ..., <6 more>, 8, 9], ..., <1 more>, "
+                "[0, 1, ..., <6 more>, 8, 9], [0, 1, ..., <6 more>, 8, 9]"
+            "]\n"
+        );
+        str.clear();
+
+        // The edges are clamped to the max_range_elements limit
+        IC_CONFIG.max_range_elements(3);
+        IC(v0);
+        REQUIRE(str == "ic| v0: [0, 1, ..., <7 more>, 9]\n");
+        str.clear();
+
+        IC(v2);
+        REQUIRE(str == "ic| v2: [0, 1, ...]\n");
+        str.clear();
+
+        IC_CONFIG.max_range_elements(1);
+        IC(v0);
+        REQUIRE(str == "ic| v0: [0, ..., <9 more>]\n");
+    }
+}
+
+
+TEST_CASE("range_streaming")
+{
+    auto print_all =
+        [](size_t threshold, std::string& str)
+        {
+            IC_CONFIG_SCOPE();
+            IC_CONFIG.output(str);
+            IC_CONFIG.range_streaming_threshold(threshold);
+
+            auto i0 = 7;
+            auto v0 = std::vector<int>{1, 2};
+            auto v1 = std::vector<std::vector<int>>(50, std::vector<int>{1, 2, 3});
+            auto v2 = std::vector<int>(100000, 42);
+            auto v3 = std::vector<std::string>{"a", "b"};
+
+            IC(v0);
+            IC(i0, v1, v0);
+            IC(v2, i0, v2, v3);
+            IC_F("[1:40]", v1);
+
+            IC_CONFIG.line_wrap_width(10);
+            IC(v0, v3);
+        };
+
+    auto expected = std::string{};
+    print_all(std::numeric_limits<size_t>::max(), expected);
+
+    auto streamed = std::string{};
+    print_all(0, streamed);
+
+    REQUIRE(streamed == expected);
+}
+
+
+TEST_CASE("coalesce_repeats")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+    IC_CONFIG.coalesce_repeats(true);
+
+    auto n = 0;
+    IC_CONFIG.prefix([&]{return std::to_string(n++) + "| ";});
+
+    auto v0 = 7;
+    for (auto i = 0; i < 5; ++i)
+    {
+        IC(v0);
+    }
+    IC(v0);
+    for (auto i = 0; i < 4; ++i)
+    {
+        auto v1 = i / 2;
+        IC(v1);
+    }
+    REQUIRE(
+        str ==
+            "0| v0: 7\n"
+            "5| ... last line repeated 4 times\n"
+            "5| v0: 7\n"
+            "6| v1: 0\n"
+            "8| ... last line repeated 1 time\n"
+            "8| v1: 1\n"
+    );
+
+    {
+        // The held "v1: 1" repeat is noticed when the output is replaced, and the new
+        // output has its own repeats.
+        IC_CONFIG_SCOPE();
+        str.clear();
+        IC_CONFIG.output(str);
+        REQUIRE(str == "8| ... last line repeated 1 time\n");
+
+        str.clear();
+        IC_CONFIG.prefix("ic| ");
+        IC_CONFIG.coalesce_flush_interval(std::chrono::milliseconds{0});
+        IC_CONFIG.output_transcoder(
+            [](char const* strg, std::size_t count) -> std::string
+            {
+                return std::string(strg, count) + "|";
+            }
+        );
+
+        for (auto i = 0; i < 3; ++i)
+        {
+            IC(v0);
+        }
+        REQUIRE(
+            str ==
+                "ic| v0: 7\n|"
+                "ic| ... last line repeated 1 time\n|"
+                "ic| ... last line repeated 1 time\n|"
+        );
+    }
+
+    {
+        // Adding an output also notices the held repeats of the current ones.
+        IC_CONFIG_SCOPE();
+        auto other = std::string{};
+        IC_CONFIG.output(other);
+        IC_CONFIG.prefix("ic| ");
+
+        for (auto i = 0; i < 3; ++i)
+        {
+            IC(v0);
+        }
+        REQUIRE(other == "ic| v0: 7\n");
+
+        str.clear();
+        IC_CONFIG.add_output(str);
+        REQUIRE(
+            other ==
+                "ic| v0: 7\n"
+                "ic| ... last line repeated 2 times\n"
+        );
+        REQUIRE(str.empty());
+    }
+
+    // The repeats held when the scope ends are dropped, and never written to the output
+    // destroyed before it.
+    for (auto i = 0; i < 3; ++i)
+    {
+        IC(v0);
+    }
+}
+
+TEST_CASE("outputs")
+{
+    IC_CONFIG_SCOPE();
+    auto str0 = std::string{};
+    auto str1 = std::string{};
+    auto str2 = std::string{};
+    IC_CONFIG
+        .output(str0)
+        .add_output(str1, icecream::Level::warn, icecream::Renderer::single_line)
+        .line_wrap_width(23);
+
+    {
+        IC_CONFIG_SCOPE();
+        IC_CONFIG.add_output(str2, icecream::Level::info);
+
+        auto v0 = std::vector<int>{1, 2, 3};
+        auto v1 = 7;
+        IC(v0, v1);
+        IC_DEBUG(v1);
+        IC_INFO(v1);
+        IC_WARN(v1);
+    }
+
+    auto v2 = 8;
+    IC_ERROR(v2);
+
+    REQUIRE(
+        str0 ==
+            "ic| \n"
+            "    v0: [1, 2, 3],\n"
+            "    v1: 7\n"
+            "ic| v1: 7\n"
+            "ic| v1: 7\n"
+            "ic| v1: 7\n"
+            "ic| v2: 8\n"
+    );
+    REQUIRE(
+        str1 ==
+            "ic| v0: [1, 2, 3], v1: 7\n"
+            "ic| v1: 7\n"
+            "ic| v2: 8\n"
+    );
+    REQUIRE(
+        str2 ==
+            "ic| \n"
+            "    v0: [1, 2, 3],\n"
+            "    v1: 7\n"
+            "ic| v1: 7\n"
+            "ic| v1: 7\n"
+    );
+
+    // Setting an output replaces all of them
+    str0.clear();
+    str1.clear();
+    IC_CONFIG.output(str0, icecream::Level::error);
+    IC_WARN(v2);
+    IC(v2);
+    REQUIRE(str0 == "ic| v2: 8\n");
+    REQUIRE(str1.empty());
+}
+
+TEST_CASE("ndjson")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str, icecream::Level::trace, icecream::Renderer::ndjson);
+
+    auto const get_args =
+        [&]() -> std::string
+        {
+            auto const args = str.substr(str.find(",\"args\":"));
+            str.clear();
+            return args;
+        };
+
+    auto v0 = std::vector<int>{1, 2, 3};
+    auto v1 = std::string{"a\tb"};
+    auto v2 = std::make_tuple(1, 2.5);
+    auto v3 = std::map<char, int>{{'a', 1}};
+    auto v4 = true;
+    IC(v0, v1, v2, v3, v4);
+    REQUIRE(str.find("{\"file\":\"") == 0);
+    REQUIRE(str.find("test_c++11.cpp\",\"line\":") != std::string::npos);
+    REQUIRE(str.find(",\"timestamp\":\"") != std::string::npos);
+    REQUIRE(str.find(",\"thread\":") != std::string::npos);
+    REQUIRE(str.find(",\"level\":null") != std::string::npos);
+    REQUIRE(
+        get_args() ==
+            ",\"args\":["
+            "{\"name\":\"v0\",\"type\":\"range\",\"value\":[1,2,3]},"
+            "{\"name\":\"v1\",\"type\":\"string\",\"value\":\"a\\tb\"},"
+            "{\"name\":\"v2\",\"type\":\"tuple\",\"value\":[1,2.5]},"
+            "{\"name\":\"v3\",\"type\":\"range\",\"value\":[[\"a\",1]]},"
+            "{\"name\":\"v4\",\"type\":\"boolean\",\"value\":true}"
+            "]}\n"
+    );
+
+    IC_WARN(v4);
+    REQUIRE(str.find(",\"level\":\"warn\"") != std::string::npos);
+    REQUIRE(
+        get_args() ==
+            ",\"args\":[{\"name\":\"v4\",\"type\":\"boolean\",\"value\":true}]}\n"
+    );
+
+    IC();
+    REQUIRE(get_args() == ",\"args\":[]}\n");
+
+    // Strings and characters are written by their raw contents, with any ill-formed UTF-8
+    // replaced. The records aren't transcoded.
+    IC_CONFIG.output_transcoder(
+        [](char const* strg, std::size_t count) -> std::string
+        {
+            return std::string(strg, count) + "|";
+        }
+    );
+    auto v5 = std::string{"12"};
+    auto v6 = std::string{"a\xff\xc3\xa9\xed\xa0\x80"};
+    auto v7 = 'x';
+    IC(v5, v6, v7);
+    REQUIRE(
+        get_args() ==
+            ",\"args\":["
+            "{\"name\":\"v5\",\"type\":\"string\",\"value\":\"12\"},"
+            "{\"name\":\"v6\",\"type\":\"string\",\"value\":\"a\\ufffd\xc3\xa9\\ufffd\\ufffd\\ufffd\"},"
+            "{\"name\":\"v7\",\"type\":\"character\",\"value\":\"x\"}"
+            "]}\n"
+    );
+}
+
+TEST_CASE("hex")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<unsigned char>{};
+    for (auto c : std::string{"Hello, world!\n"})
+    {
+        v0.push_back(static_cast<unsigned char>(c));
+    }
+    v0.push_back(0x00);
+    v0.push_back(0xff);
+    v0.push_back(0x7f);
+
+    IC_F("hex", v0);
+    IC_F("hexdump", v0);
+
+    auto v1 = std::list<char>{'a', 'b'};
+    IC_F("hexdump", v1);
+
+    auto v2 = std::vector<int>{1, 2};
+    IC_F("hex", v2);
+
+    struct Point { char x; char y; };
+    auto v3 = Point{'a', '\t'};
+    auto& v4 = IC_BYTES(v3);
+
+    REQUIRE(&v4 == &v3);
+    REQUIRE(
+        str ==
+            "ic| v0: [48 65 6c 6c 6f 2c 20 77 6f 72 6c 64 21 0a 00 ff 7f]\n"
+            "ic| \n"
+            "    v0: [\n"
+            "        00000000  48 65 6c 6c 6f 2c 20 77  6f 72 6c 64 21 0a 00 ff  |Hello, world!...| \n"
+            "        00000010  7f                                                |.|\n"
+            "    ]\n"
+            "ic| \n"
+            "    v1: [\n"
+            "        00000000  61 62                                             |ab|\n"
+            "    ]\n"
+            "ic| v2: <this range doesn't support hex formatting>\n"
+            "ic| \n"
+            "    v3: [\n"
+            "        00000000  61 09                                             |a.|\n"
+            "    ]\n"
+    );
+
+    str.clear();
+    IC_CONFIG.max_range_elements(20);
+    auto v5 = std::vector<unsigned char>(100, 0x41);
+    IC_F("hex", v5);
+    REQUIRE(
+        str ==
+            "ic| \n"
+            "    v5: [\n"
+            "        41 41 41 41 41 41 41 41 41 41 41 41 41 41 41 41 \n"
+            "        41 41 41 41 \n"
+            "        ...\n"
+            "    ]\n"
+    );
+}
+
+
+TEST_CASE("bits")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<bool>(300, true);
+    v0.resize(312, false);
+    v0.push_back(true);
+    IC_F("rle", v0);
+    IC_F("[298:305]bits", v0);
+    IC_F("[300:]ones", v0);
+    IC_F("[::-1]rle", v0);
+
+    auto v1 = std::bitset<10>{0x205};
+    IC_F("ones", v1);
+    IC_F("rle", v1);
+    IC_F("bits", v1);
+    IC_F("[1:5]bits", v1);
+    IC_F("[1:]rle", v1);
+    IC_F("[::-1]ones", v1);
+
+    auto v2 = std::vector<int>{1, 0};
+    IC_F("ones", v2);
+
+    IC_CONFIG.max_range_elements(2);
+    IC_F("rle", v0);
+    IC_F("ones", v1);
+    IC_F("bits", v1);
+
+    REQUIRE(
+        str ==
+            "ic| v0: [1x300, 0x12, 1x1]\n"
+            "ic| v0: [298:305]->[1100000]\n"
+            "ic| v0: [300:]->[12]\n"
+            "ic| v0: [::-1]->[1x1, 0x12, 1x300]\n"
+            "ic| v1: [0, 2, 9]\n"
+            "ic| v1: [1x1, 0x1, 1x1, 0x6, 1x1]\n"
+            "ic| v1: [0b1000000101]\n"
+            "ic| v1: [1:5]->[0b0010]\n"
+            "ic| v1: [1:]->[0x1, 1x1, 0x6, 1x1]\n"
+            "ic| v1: [::-1]->[0, 7, 9]\n"
+            "ic| v2: <this range doesn't support bits formatting>\n"
+            "ic| v0: [1x300, 0x12, ...]\n"
+            "ic| v1: [0, 2, ...]\n"
+            "ic| v1: [0b...01]\n"
+    );
+}
+
+TEST_CASE("stats")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<int>{2, 4, 4, 4, 5, 5, 7, 9};
+    IC_F("stats", v0);
+    IC_F("[:2]stats", v0);
+    IC_F("stats:#x", v0);
+
+    auto v1 = std::list<double>{0.5, std::numeric_limits<double>::quiet_NaN(), 2.5};
+    v1.push_back(std::numeric_limits<double>::infinity());
+    IC_F("stats", v1);
+
+    auto v2 = std::vector<double>{};
+    IC_F("stats", v2);
+
+    auto v3 = std::vector<std::string>{"a"};
+    IC_F("stats", v3);
+
+    auto v4 = std::vector<uint8_t>{0, 128, 255};
+    IC_F("stats", v4);
+
+    auto v5 = std::vector<int8_t>{-3, 5};
+    IC_F("stats", v5);
+
+    auto v6 = std::vector<char>{'a'};
+    IC_F("stats", v6);
+
+    REQUIRE(
+        str ==
+            "ic| v0: {count: 8, min: 2, max: 9, mean: 5, stddev: 2}\n"
+            "ic| v0: [:2]->{count: 2, min: 2, max: 4, mean: 3, stddev: 1}\n"
+            "ic| v0: {count: 8, min: 0x2, max: 0x9, mean: 5, stddev: 2}\n"
+            "ic| \n"
+            "    v1: {\n"
+            "        count: 4, \n"
+            "        min: 0.5, \n"
+            "        max: inf, \n"
+            "        mean: 1.5, \n"
+            "        stddev: 1, \n"
+            "        nan: 1, \n"
+            "        inf: 1\n"
+            "    }\n"
+            "ic| v2: {count: 0, nan: 0, inf: 0}\n"
+            "ic| v3: <this range doesn't support stats formatting>\n"
+            "ic| v4: {count: 3, min: 0, max: 255, mean: 127.667, stddev: 104.104}\n"
+            "ic| v5: {count: 2, min: -3, max: 5, mean: 1, stddev: 4}\n"
+            "ic| v6: <this range doesn't support stats formatting>\n"
+    );
+}
+
+TEST_CASE("nonzero")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<double>(1000, 0.0);
+    v0[3] = 1.5;
+    v0[700] = -2.0;
+    v0[999] = 0.25;
+    IC_F("nonzero", v0);
+    IC_F("[500:]nonzero", v0);
+    IC_F("[::-1]nonzero", v0);
+
+    auto v1 = std::list<int>{0, 10, 0, 0, 255};
+    IC_F("nonzero:#x", v1);
+
+    auto v2 = std::vector<int>{0, 0};
+    IC_F("nonzero", v2);
+
+    auto v3 = std::vector<std::string>{"a"};
+    IC_F("nonzero", v3);
+
+    auto v4 = std::vector<uint8_t>{0, 7, 0, 200};
+    IC_F("nonzero", v4);
+
+    auto v5 = std::vector<char>{'a'};
+    IC_F("nonzero", v5);
+
+    IC_CONFIG.max_range_elements(2);
+    IC_F("nonzero", v0);
+
+    REQUIRE(
+        str ==
+            "ic| v0: {3: 1.5, 700: -2, 999: 0.25}\n"
+            "ic| v0: [500:]->{700: -2, 999: 0.25}\n"
+            "ic| v0: [::-1]->{999: 0.25, 700: -2, 3: 1.5}\n"
+            "ic| v1: {1: 0xa, 4: 0xff}\n"
+            "ic| v2: {}\n"
+            "ic| v3: <this range doesn't support nonzero formatting>\n"
+            "ic| v4: {1: 7, 3: 200}\n"
+            "ic| v5: <this range doesn't support nonzero formatting>\n"
+            "ic| v0: {3: 1.5, 700: -2, ...}\n"
+    );
+}
+
+TEST_CASE("compare")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<double>{1.0, 2.0, 3.0, 4.0};
+    auto v1 = std::vector<double>{1.0, 2.5, 3.0, 5.0};
+    IC_CMP(v0, v1);
+    IC_CMP(v0, v1, 0.5);
+    IC_CMP(v0, v0);
+
+    auto v2 = std::list<int>{1, 2};
+    auto v3 = std::vector<int>{1, 3, 3};
+    IC_CMP(v2, v3);
+
+    auto v4 = std::make_tuple(1, 2.5, std::string{"a"});
+    auto v5 = std::make_tuple(1, 2.0, std::string{"b"});
+    IC_CMP(v4, v5, 1.0);
+
+    auto v6 = 10;
+    IC_CMP(v0, v6);
+
+    IC_CONFIG.max_range_elements(1);
+    IC_CMP(v0, v1);
+
+    REQUIRE(
+        str ==
+            "ic| v0 vs v1: {mismatches: 2, 1: (2, 2.5), 3: (4, 5)}\n"
+            "ic| v0 vs v1: {mismatches: 1, 3: (4, 5)}\n"
+            "ic| v0 vs v0: {mismatches: 0}\n"
+            "ic| v2 vs v3: {sizes: (2, 3), mismatches: 1, 1: (2, 3)}\n"
+            "ic| v4 vs v5: {mismatches: 1, 2: (\"a\", \"b\")}\n"
+            "ic| v0 vs v6: <IC_CMP arguments must be two ranges or two tuples>\n"
+            "ic| v0 vs v1: {mismatches: 2, 1: (2, 2.5), ...}\n"
+    );
+}
+
+TEST_CASE("hash")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::string{"abc"};
+    auto v1 = std::vector<unsigned char>{'a', 'b', 'c'};
+    auto v2 = std::string{};
+    IC_F("hash", v0);
+    IC_F("hash", "abc");
+    IC_F("hash", v1);
+    IC_F("hash", v2);
+    REQUIRE(
+        str ==
+            "ic| v0: {size: 3, hash: 44bc2cf5ad770999}\n"
+            "ic| \"abc\": {size: 3, hash: 44bc2cf5ad770999}\n"
+            "ic| v1: {size: 3, hash: 44bc2cf5ad770999}\n"
+            "ic| v2: {size: 0, hash: ef46db3751d8e999}\n"
+    );
+
+    auto const hash_of =
+        [&](std::function<void()> const& print) -> std::string
+        {
+            str.clear();
+            print();
+            return str.substr(str.find(':'));
+        };
+
+    auto v3 = std::vector<int>(1000, 7);
+    auto v4 = std::list<int>(1000, 7);
+    auto v5 = std::vector<int>(999, 7);
+    REQUIRE(hash_of([&]{IC_F("hash", v3);}) == hash_of([&]{IC_F("hash", v4);}));
+    REQUIRE(hash_of([&]{IC_F("hash", v3);}) != hash_of([&]{IC_F("hash", v5);}));
+    REQUIRE(
+        hash_of([&]{IC_F("[1:]hash", v3);})
+            == ": [1:]->" + hash_of([&]{IC_F("hash", v5);}).substr(2)
+    );
+
+    auto v6 = std::vector<std::string>{"a", "bc"};
+    auto v7 = std::vector<std::string>{"ab", "c"};
+    REQUIRE(hash_of([&]{IC_F("hash", v6);}) != hash_of([&]{IC_F("hash", v7);}));
+
+    auto v8 = std::vector<std::string>{"a"};
+    str.clear();
+    IC_F(":hash", v8);
+    REQUIRE(str == "ic| v8: [{size: 1, hash: d24ec4f1a98c6e5b}]\n");
+
+    // Equal values with different padding bytes
+    auto v9 = Padded{};
+    auto v10 = Padded{};
+    std::memset(&v9, 0x00, sizeof(Padded));
+    std::memset(&v10, 0xff, sizeof(Padded));
+    v9.c = v10.c = 'a';
+    v9.i = v10.i = 7;
+    REQUIRE(hash_of([&]{IC_F("hash", v9);}) == hash_of([&]{IC_F("hash", v10);}));
+}
+
+TEST_CASE("on change")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    for (auto v0 : {1, 1, 2, 2, 2, 1})
+    {
+        auto& r = IC_ON_CHANGE(v0);
+        REQUIRE(&r == &v0);
+    }
+    REQUIRE(str == "ic| v0: 1\nic| v0: 2\nic| v0: 1\n");
+
+    str.clear();
+    for (auto v1 : {"a", "a", "b"})
+    {
+        auto v2 = std::vector<std::string>{v1};
+        IC_ON_CHANGE(v2);
+    }
+    REQUIRE(str == "ic| v2: [\"a\"]\nic| v2: [\"b\"]\n");
+
+    // The cache isn't updated while disabled
+    str.clear();
+    for (auto v3 : {1, 2, 2, 3})
+    {
+        if (v3 == 2) IC_CONFIG.disable(); else IC_CONFIG.enable();
+        IC_ON_CHANGE(v3);
+    }
+    IC_CONFIG.enable();
+    REQUIRE(str == "ic| v3: 1\nic| v3: 3\n");
+
+    // Padding bytes don't tell a change
+    str.clear();
+    for (auto i : {0x00, 0xff})
+    {
+        auto v4 = Padded{};
+        std::memset(&v4, i, sizeof(Padded));
+        v4.c = 'a';
+        v4.i = 7;
+        IC_ON_CHANGE(v4);
+    }
+    REQUIRE(str == "ic| v4: a7\n");
+
+    // Call sites written on the same line have their own states
+    str.clear();
+    for (auto i = 0; i < 3; ++i)
+    {
+        auto v5 = 1, v6 = i < 2 ? 2 : 3;
+        IC_ON_CHANGE(v5); IC_ON_CHANGE(v6);
+    }
+    REQUIRE(str == "ic| v5: 1\nic| v6: 2\nic| v6: 3\n");
+}
+
+TEST_CASE("watch")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<int>{1, 2, 3};
+    auto v1 = std::map<char, int>{{'a', 1}, {'b', 2}};
+    auto v2 = 7;
+    for (auto i = 0; i < 4; ++i)
+    {
+        auto& r = IC_WATCH(v0);
+        REQUIRE(&r == &v0);
+        IC_WATCH(v1);
+        IC_WATCH(v2);
+
+        if (i == 0)
+        {
+            v0[1] = 5;
+            v1['b'] = 3;
+        }
+        else if (i == 1)
+        {
+            v0.push_back(4);
+            v1.erase('a');
+            v1['c'] = 0;
+        }
+        else if (i == 2)
+        {
+            v0.pop_back();
+        }
+    }
+
+    REQUIRE(
+        str ==
+            "ic| v0: [1, 2, 3]\n"
+            "ic| v1: [('a', 1), ('b', 2)]\n"
+            "ic| v2: <IC_WATCH argument must be a range>\n"
+            "ic| v0: {[1]: 2 -> 5}\n"
+            "ic| v1: {['b']: 2 -> 3}\n"
+            "ic| v2: <IC_WATCH argument must be a range>\n"
+            "ic| v0: {[3]: added 4}\n"
+            "ic| v1: {['c']: added 0, ['a']: removed 1}\n"
+            "ic| v2: <IC_WATCH argument must be a range>\n"
+            "ic| v0: {[3]: removed 4}\n"
+            "ic| v2: <IC_WATCH argument must be a range>\n"
+    );
+
+    str.clear();
+    IC_CONFIG.max_range_elements(2);
+    auto v3 = std::vector<std::string>{"a", "b", "c"};
+    for (auto i = 0; i < 2; ++i)
+    {
+        IC_WATCH(v3);
+        for (auto& s : v3) s += "x";
+    }
+    REQUIRE(
+        str ==
+            "ic| v3: [\"a\", \"b\", ..., <1 more>]\n"
+            "ic| v3: {[0]: \"a\" -> \"ax\", [1]: \"b\" -> \"bx\", ..., <1 more>}\n"
+    );
+
+    // Equal keys are matched in their iteration order
+    str.clear();
+    IC_CONFIG.max_range_elements(10);
+    auto v4 = std::multimap<char, int>{{'a', 1}, {'a', 2}};
+    for (auto i = 0; i < 3; ++i)
+    {
+        IC_WATCH(v4);
+        if (i == 0) std::next(v4.begin())->second = 3;
+        if (i == 1) v4.emplace('a', 4);
+    }
+    REQUIRE(
+        str ==
+            "ic| v4: [('a', 1), ('a', 2)]\n"
+            "ic| v4: {['a']: 2 -> 3}\n"
+            "ic| v4: {['a']: added 4}\n"
+    );
+
+    // Nested containers are compared by their copies, and a NaN is equal to itself
+    str.clear();
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    auto v7 = std::vector<std::vector<double>>{{1.5, nan}, {2.5}};
+    auto v8 = std::map<std::string, std::pair<int, std::string>>{{"a", {1, "x"}}};
+    for (auto i = 0; i < 3; ++i)
+    {
+        IC_WATCH(v7);
+        IC_WATCH(v8);
+        if (i == 0) v7[1].push_back(3.5);
+        if (i == 1) v8["a"].second = "y";
+    }
+    REQUIRE(
+        str ==
+            "ic| v7: [[1.5, nan], [2.5]]\n"
+            "ic| v8: [(\"a\", (1, \"x\"))]\n"
+            "ic| v7: {[1]: [2.5] -> [2.5, 3.5]}\n"
+            "ic| v8: {[\"a\"]: (1, \"x\") -> (1, \"y\")}\n"
+    );
+
+    // Call sites written on the same line have their own states
+    str.clear();
+    auto v5 = std::vector<int>{0, 0};
+    auto v6 = std::vector<int>{4, 4};
+    auto v9 = std::map<char, int>{{'a', 1}};
+    for (auto i = 0; i < 3; ++i)
+    {
+        IC_WATCH(v5); IC_WATCH(v6); IC_WATCH(v9);
+        if (i == 1) v6[0] = 5;
+    }
+    REQUIRE(
+        str ==
+            "ic| v5: [0, 0]\n"
+            "ic| v6: [4, 4]\n"
+            "ic| v9: [('a', 1)]\n"
+            "ic| v6: {[0]: 4 -> 5}\n"
+    );
+}
+
 TEST_CASE("exception")
 {
     {
@@ -1154,6 +2130,115 @@ TEST_CASE("formatting")
         IC_F("#B", v0);
         REQUIRE(str == "ic| v0: 0B1100010\n");
     }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::vector<double>{1.5, -0.0, 1e16, 1e-7, 123456789.0};
+        auto v1 = std::vector<int>{1, 22, 333};
+        auto v2 = std::vector<int>{4, 5};
+        auto v3 = std::vector<unsigned char>{65, 200};
+        IC(v0);
+        IC_F(":*>4", v1);
+        IC_F(":#x", v1);
+        IC_F(":oA", v2);
+        IC_F(":x", v3);
+        REQUIRE(
+            str ==
+                "ic| v0: [1.5, -0, 1e+16, 1e-07, 1.23457e+08]\n"
+                "ic| v1: [***1, **22, *333]\n"
+                "ic| v1: [0x1, 0x16, 0x14d]\n"
+                "ic| v2: [*Error* in formatting string, *Error* in formatting string]\n"
+                "ic| v3: [41, c8]\n"
+        );
+    }
+
+    {
+        // Exact binary fractions printed by the reused range element formatter
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::vector<double>{0.25, -0.5};
+        IC(v0);
+        REQUIRE(str == "ic| v0: [0.25, -0.5]\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::uint64_t{0x8000000000000005u};
+        auto v1 = std::int16_t{-2};
+        IC_F("b", v0, v1);
+        IC_F("*>8b", 5);
+        IC_F("<#8b", 5);
+        REQUIRE(
+            str ==
+                "ic| \n"
+                "    v0: 1000000000000000000000000000000000000000000000000000000000000101,\n"
+                "    v1: 1111111111111110\n"
+                "ic| 5: *****101\n"
+                "ic| 5: 0b101   \n"
+        );
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::bitset<8>{0x2c};
+        auto v1 = std::bitset<70>{};
+        v1.set(69);
+        v1.set(3);
+        IC(v0);
+        IC_F("#b", v0);
+        IC_F("#X", v0, v1);
+        IC_F("d", v1);
+        IC_F("c", v1);
+        REQUIRE(
+            str ==
+                "ic| v0: 00101100\n"
+                "ic| v0: 0b101100\n"
+                "ic| v0: 0X2C, v1: 0X200000000000000008\n"
+                "ic| v1: 590295810358705651720\n"
+                "ic| v1: *Error* in formatting string\n"
+        );
+    }
+
+  #if defined(__SIZEOF_INT128__)
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        __extension__ typedef __int128 int128;
+        __extension__ typedef unsigned __int128 uint128;
+
+        auto v0 = -(int128{1} << 100);
+        auto v1 = ~uint128{0};
+        auto v2 = int128{42};
+        IC(v0);
+        IC(v1);
+        IC_F("#x", v2);
+        IC_F("+", v2);
+        IC_F("#o", v2);
+        IC_F("#b", v2);
+        REQUIRE(
+            str ==
+                "ic| v0: -1267650600228229401496703205376\n"
+                "ic| v1: 340282366920938463463374607431768211455\n"
+                "ic| v2: 0x2a\n"
+                "ic| v2: +42\n"
+                "ic| v2: 052\n"
+                "ic| v2: 0b101010\n"
+        );
+    }
+  #endif
 }
 
 
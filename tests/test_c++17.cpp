@@ -116,6 +116,23 @@ TEST_CASE("std_filesystem")
 #endif
 
 
+TEST_CASE("on change string_view")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    // A view to the same memory, whose contents have changed
+    char buffer[] = "abc";
+    for (auto c : {'a', 'a', 'x'})
+    {
+        buffer[0] = c;
+        auto v0 = std::string_view(buffer);
+        IC_ON_CHANGE(v0);
+    }
+    REQUIRE(str == "ic| v0: \"abc\"\nic| v0: \"xbc\"\n");
+}
+
 TEST_CASE("output transcoding")
 {
     {
@@ -178,6 +178,51 @@ TEST_CASE("ranges view")
             "ic| v1[3]: 0xd\n";
         REQUIRE(str == result);
     }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto arr = std::vector<std::pair<double, int>>{{0.1, 10}, {1.1, 11}, {2.1, 12}, {3.1, 13}};
+        {
+            auto v0 = arr | IC_FV("[2:]stats", "v1", [](auto i){return i.second;}) | rv::drop(0);
+            for (auto i : v0){(void)i;}
+            REQUIRE(str.empty());
+        }
+        REQUIRE(str == "ic| v1: [2:]->{count: 2, min: 12, max: 13, mean: 12.5, stddev: 0.5}\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto arr = std::vector<double>{};
+        {
+            auto v0 = arr | IC_FV("stats", "v1") | rv::drop(0);
+            for (auto i : v0){(void)i;}
+        }
+        REQUIRE(str == "ic| v1: {count: 0, nan: 0, inf: 0}\n");
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto arr = std::vector<int>{0, 5, 0, 120, 7};
+        auto v0 = arr | IC_FV("nonzero", "v1") | rv::drop(0);
+        for (auto i : v0){(void)i;}
+        auto v1 = arr | IC_FV("[2:]nonzero", "v2", [](int i){return i > 100 ? i : 0;}) | rv::drop(0);
+        for (auto i : v1){(void)i;}
+        auto const result =
+            "ic| v1[1]: 5\n"
+            "ic| v1[3]: 120\n"
+            "ic| v1[4]: 7\n"
+            "ic| v2[3]: 120\n";
+        REQUIRE(str == result);
+    }
 }
 
 
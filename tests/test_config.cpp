@@ -1,4 +1,5 @@
 #include "icecream.hpp"
+#include "common.hpp"
 
 #if defined(_MSC_VER)
   #pragma warning(disable: 4571 4868 5045)
@@ -10,10 +11,31 @@
     #pragma GCC diagnostic ignored "-Wshadow"
 #endif
 
+#include <chrono>
+#include <thread>
+
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 
 
+auto filtered_function(std::string& str) -> void
+{
+    IC_CONFIG_SCOPE();
+    IC_CONFIG.output(str);
+    IC(1);
+}
+
+template <typename T>
+auto filtered_template(std::string& str, T v) -> void
+{
+    IC_CONFIG_SCOPE();
+    IC_CONFIG.output(str);
+    IC(v);
+}
+
+// Defined at test_2.cpp, another translation unit.
+auto print_on_change_in_test_2(std::string& str, int value) -> void;
+
 TEST_CASE("Hereditary")
 {
     {
@@ -65,3 +87,158 @@ TEST_CASE("Configure")
     }
     REQUIRE(IC_CONFIG.is_enabled());
 }
+
+
+TEST_CASE("Call site filter")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    REQUIRE(IC_CONFIG.filter().empty());
+
+    {
+        IC_CONFIG.filter("-file=test_config.cpp");
+        REQUIRE(IC_CONFIG.filter() == "-file=test_config.cpp");
+        IC(2);
+        filtered_function(str);
+        REQUIRE(str.empty());
+    }
+
+    {
+        IC_CONFIG.filter("func=filtered_function");
+        IC(3);
+        filtered_function(str);
+        REQUIRE(str == "ic| 1: 1\n");
+        str.clear();
+    }
+
+    {
+        IC_CONFIG.filter("tag=net, -func=filtered_function");
+        IC_TAG("net", 4);
+        IC_TAG("io", 5);
+        IC(6);
+        filtered_function(str);
+        REQUIRE(str == "ic| 4: 4\n");
+        str.clear();
+    }
+
+    {
+        IC_CONFIG.filter("file=*_config.cpp & line=" + std::to_string(__LINE__ + 1));
+        IC(7);
+        IC(8);
+        REQUIRE(str == "ic| 7: 7\n");
+        str.clear();
+    }
+
+    {
+        // Invalid directives are ignored
+        IC_CONFIG.filter("foo=bar, line=a-b, -, -file=*.hpp");
+        IC(9);
+        REQUIRE(str == "ic| 9: 9\n");
+        str.clear();
+    }
+
+    {
+        // The decision cached at a call site is refreshed after a filter change
+        for (auto i = 0; i < 3; ++i)
+        {
+            IC_CONFIG.filter(i == 1 ? "-file=*" : "");
+            IC(i);
+        }
+        REQUIRE(str == "ic| i: 0\nic| i: 2\n");
+        str.clear();
+    }
+
+    {
+        // A call site with a non constant tag decides it at every call
+        IC_CONFIG.filter("-tag=noisy");
+        for (auto const& tag : {std::string{"ok"}, std::string{"noisy"}, std::string{"ok"}})
+        {
+            IC_TAG(tag, 10);
+        }
+        REQUIRE(str == "ic| 10: 10\nic| 10: 10\n");
+        str.clear();
+    }
+
+    {
+        // Each instantiation of a function template has its own decision
+        IC_CONFIG.filter("-func=double");
+        filtered_template(str, 11);
+        filtered_template(str, 12.5);
+        filtered_template(str, 13);
+        REQUIRE(str == "ic| v: 11\nic| v: 13\n");
+        str.clear();
+    }
+
+    {
+        // Call sites written on the same line are filtered by their own tags
+        IC_CONFIG.filter("-tag=io");
+        for (auto i = 0; i < 2; ++i)
+        {
+            IC_TAG("net", 14); IC_TAG("io", 15); IC(16);
+        }
+        REQUIRE(str == "ic| 14: 14\nic| 16: 16\nic| 14: 14\nic| 16: 16\n");
+        str.clear();
+    }
+
+    {
+        IC_CONFIG.filter("-file=*");
+        auto n_calls = 0;
+        IC_IF(true, ++n_calls);
+        REQUIRE(n_calls == 0);
+        REQUIRE(str.empty());
+    }
+
+    IC_CONFIG.filter("");
+}
+
+
+TEST_CASE("Call site states")
+{
+    auto str = std::string{};
+
+    // A call site within an inline function has the same state in all the translation
+    // units
+    print_on_change(str, 1);
+    print_on_change_in_test_2(str, 1);
+    print_on_change_in_test_2(str, 2);
+    print_on_change(str, 2);
+    REQUIRE(str == "ic| value: 1\nic| value: 2\n");
+}
+
+
+TEST_CASE("Repeats notice")
+{
+    IC_CONFIG_SCOPE();
+    auto warnings = std::string{};
+    auto str = std::string{};
+    IC_CONFIG.output(warnings, icecream::Level::warn).add_output(str);
+    IC_CONFIG.coalesce_repeats(true);
+    IC_CONFIG.coalesce_flush_interval(std::chrono::milliseconds{50});
+
+    // The repeats of the last line written to `warnings` are noticed by the first IC call
+    // after the flush interval, even if that call doesn't write to `warnings`.
+    auto v0 = 7;
+    for (auto i = 0; i < 5; ++i)
+    {
+        IC_WARN(v0);
+    }
+    IC_DEBUG(v0);
+    REQUIRE(warnings == "ic| v0: 7\n");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    IC_DEBUG(v0);
+    REQUIRE(
+        warnings ==
+            "ic| v0: 7\n"
+            "ic| ... last line repeated 4 times\n"
+    );
+    REQUIRE(
+        str ==
+            "ic| v0: 7\n"
+            "ic| ... last line repeated 4 times\n"
+            "ic| v0: 7\n"
+            "ic| v0: 7\n"
+    );
+}
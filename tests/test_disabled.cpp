@@ -62,6 +62,40 @@ TEST_CASE("printing")
         REQUIRE(str.empty());
     }
 
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::vector<int>{1, 2};
+        auto v1 = std::vector<int>{1, 3};
+        REQUIRE(std::is_same<decltype(IC_CMP(v0, v1)), void>::value);
+        IC_CMP(v0, v1, 0.5);
+        REQUIRE(str.empty());
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = int{7};
+        auto& r = IC_ON_CHANGE(v0);
+        REQUIRE(&r == &v0);
+        REQUIRE(str.empty());
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::vector<int>{1, 2};
+        auto& r = IC_WATCH(v0);
+        REQUIRE(&r == &v0);
+        REQUIRE(str.empty());
+    }
+
     {
         IC_CONFIG_SCOPE();
         auto str = std::string{};
@@ -94,6 +128,31 @@ TEST_CASE("printing")
         REQUIRE(str == "");
         REQUIRE(r == 30);
     }
+
+    {
+        // No printing code is instantiated, so even non printable types are accepted.
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto nf = NonFormattable{7};
+        auto& r = IC(nf);
+        IC(nf, 1);
+        REQUIRE(str.empty());
+        REQUIRE(&r == &nf);
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto n_calls = 0;
+        auto counted = [&](int i) {++n_calls; return i;};
+        IC_IF(counted(1) == 1, counted(2));
+        REQUIRE(str.empty());
+        REQUIRE(n_calls == 0);
+    }
 }
 
 
@@ -0,0 +1,81 @@
+#define ICECREAM_MIN_LEVEL ICECREAM_LEVEL_DEBUG
+#include "icecream.hpp"
+#include "common.hpp"
+
+#if defined(_MSC_VER)
+  #pragma warning(disable: 4365 4435 4626 4820 4571 4710 4711 4868 5045 5262)
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ <= 6)
+    // GCC at version 6 and older has a bug when processing a `_Pragma` directive within
+    // macro expansions. https://gcc.gnu.org/bugzilla/show_bug.cgi?id=69126
+    #pragma GCC diagnostic ignored "-Wshadow"
+#endif
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("runtime level")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    REQUIRE(IC_CONFIG.level() == icecream::Level::trace);
+
+    {
+        auto v0 = 1;
+        IC_DEBUG(v0);
+        IC_INFO(v0, 2);
+        IC_WARN(IC_("#x", 10));
+        IC_ERROR(v0);
+        REQUIRE(str == "ic| v0: 1\nic| v0: 1, 2: 2\nic| 10: 0xa\nic| v0: 1\n");
+        str.clear();
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        IC_CONFIG.level(icecream::Level::warn);
+        REQUIRE(IC_CONFIG.level() == icecream::Level::warn);
+        REQUIRE(::IC_CONFIG.level() == icecream::Level::trace);
+
+        auto n_calls = 0;
+        auto counted = [&](int i) {++n_calls; return i;};
+        IC_DEBUG(counted(1));
+        IC_INFO(counted(2));
+        IC_WARN(counted(3));
+        IC_ERROR(counted(4));
+        REQUIRE(str == "ic| counted(3): 3\nic| counted(4): 4\n");
+        REQUIRE(n_calls == 2);
+        str.clear();
+    }
+
+    {
+        IC_CONFIG_SCOPE();
+        IC_CONFIG.disable();
+        IC_ERROR(1);
+        REQUIRE(str.empty());
+    }
+}
+
+
+TEST_CASE("compile time level")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto n_calls = 0;
+    auto counted = [&](int i) {++n_calls; return i;};
+
+    // Stripped out sites aren't instantiated, so even non printable types are accepted.
+    auto nf = NonFormattable{7};
+    IC_TRACE(counted(1), nf);
+    REQUIRE(str.empty());
+    REQUIRE(n_calls == 0);
+
+    IC_DEBUG(counted(2));
+    REQUIRE(str == "ic| counted(2): 2\n");
+    REQUIRE(n_calls == 1);
+}
@@ -0,0 +1,168 @@
+#define ICECREAM_PARALLEL
+#include "icecream.hpp"
+#include "common.hpp"
+
+#if defined(_MSC_VER)
+  #pragma warning(disable: 4365 4435 4626 4820 4571 4710 4711 4868 5045 5262)
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ <= 6)
+    // GCC at version 6 and older has a bug when processing a `_Pragma` directive within
+    // macro expansions. https://gcc.gnu.org/bugzilla/show_bug.cgi?id=69126
+    #pragma GCC diagnostic ignored "-Wshadow"
+#endif
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <deque>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+    struct Throwing
+    {
+        int value;
+    };
+
+    auto operator<<(std::ostream& os, Throwing const& t) -> std::ostream&
+    {
+        if (t.value < 0)
+        {
+            throw std::runtime_error("negative value");
+        }
+        return os << t.value;
+    }
+
+    // Records the threads where it was formatted.
+    struct Recording
+    {
+        static auto threads() -> std::set<std::thread::id>&
+        {
+            static auto ids = std::set<std::thread::id>{};
+            return ids;
+        }
+
+        static auto mutex() -> std::mutex&
+        {
+            static std::mutex m;
+            return m;
+        }
+    };
+
+    auto operator<<(std::ostream& os, Recording const&) -> std::ostream&
+    {
+        std::lock_guard<std::mutex> guard(Recording::mutex());
+        Recording::threads().insert(std::this_thread::get_id());
+        return os << 'r';
+    }
+}
+
+
+TEST_CASE("parallel formatting")
+{
+    auto print_all =
+        [](size_t threshold, std::string& str)
+        {
+            IC_CONFIG_SCOPE();
+            IC_CONFIG.output(str);
+            IC_CONFIG.parallel_range_threshold(threshold);
+
+            auto v0 = std::vector<int>(100000);
+            for (auto i = size_t{0}; i < v0.size(); ++i)
+            {
+                v0[i] = static_cast<int>(i);
+            }
+            auto v1 = std::vector<std::vector<double>>(40000, std::vector<double>{1.5, 2.5});
+            auto v2 = std::deque<std::string>(50000, "abc");
+            auto v3 = std::list<int>(100, 7);
+            auto v4 = std::vector<int>{1, 2, 3};
+
+            IC(v0);
+            IC(v1, v4);
+            IC_F(":#x", v0);
+            IC(v2, v3);
+
+            IC_CONFIG.max_range_elements(70000);
+            IC(v0);
+
+            IC_CONFIG.max_nesting_depth(1);
+            IC(v1);
+
+            IC_CONFIG.max_nesting_depth(std::numeric_limits<size_t>::max());
+            IC_CONFIG.max_range_elements(std::numeric_limits<size_t>::max());
+            IC_CONFIG.range_streaming_threshold(0);
+            IC(v0, v4);
+        };
+
+    auto expected = std::string{};
+    print_all(std::numeric_limits<size_t>::max(), expected);
+
+    auto parallel = std::string{};
+    print_all(0, parallel);
+
+    REQUIRE(parallel == expected);
+}
+
+TEST_CASE("parallel formatting exception")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+    IC_CONFIG.parallel_range_threshold(0);
+
+    auto v0 = std::vector<Throwing>(100000, Throwing{1});
+    v0[90000].value = -1;
+
+    auto is_thrown = false;
+    try
+    {
+        IC(v0);
+    }
+    catch (std::runtime_error const&)
+    {
+        is_thrown = true;
+    }
+
+    REQUIRE(is_thrown);
+    REQUIRE(str.empty());
+}
+
+TEST_CASE("parallel formatting threads")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+    IC_CONFIG.parallel_range_threshold(100);
+
+    // A range that isn't the first printed argument is formatted in parallel too
+    auto i0 = 7;
+    auto v0 = std::vector<Recording>(20000);
+    IC(i0, v0);
+    REQUIRE(Recording::threads().count(std::this_thread::get_id()) == 0);
+    Recording::threads().clear();
+
+    // The nested ranges are formatted by the thread formatting the element containing
+    // them, without launching more threads.
+    auto const n_threads = std::thread::hardware_concurrency() > 1 ?
+        size_t{std::thread::hardware_concurrency()} : size_t{1};
+    auto v1 = std::vector<std::vector<Recording>>(200, std::vector<Recording>(200));
+    IC(v1);
+    REQUIRE(Recording::threads().size() <= n_threads);
+    REQUIRE(Recording::threads().count(std::this_thread::get_id()) == 0);
+
+    // The worker threads are reused by all the IC calls
+    for (auto i = 0; i < 3; ++i)
+    {
+        IC(v0);
+    }
+    REQUIRE(Recording::threads().size() <= n_threads);
+    Recording::threads().clear();
+}
@@ -1,6 +1,11 @@
 #include "icecream.hpp"
 
 #include <forward_list>
+#include <iterator>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
 
 #if defined(_MSC_VER)
   #pragma warning(disable: 4571 4868 5045)
@@ -9,6 +14,28 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 
+// A single pass range, reading its elements from a stream.
+class StreamRange
+{
+public:
+    explicit StreamRange(std::string const& text)
+        : strm_(text)
+    {}
+
+    auto begin() const -> std::istream_iterator<int>
+    {
+        return std::istream_iterator<int>(this->strm_);
+    }
+
+    auto end() const -> std::istream_iterator<int>
+    {
+        return std::istream_iterator<int>();
+    }
+
+private:
+    mutable std::istringstream strm_;
+};
+
 class SizedForwardList
     : public std::forward_list<int>
 {
@@ -27,6 +54,23 @@ public:
     }
 };
 
+// A bidirectional range without a size method
+class UnsizedList
+{
+public:
+    std::list<int> list;
+
+    auto begin() const -> std::list<int>::const_iterator
+    {
+        return this->list.begin();
+    }
+
+    auto end() const -> std::list<int>::const_iterator
+    {
+        return this->list.end();
+    }
+};
+
 
 TEST_CASE("bidirectional positive step")
 {
@@ -290,6 +334,32 @@ TEST_CASE("bidirectional - wrong formatting")
 }
 
 
+TEST_CASE("random access long strides")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = std::vector<int>(1000);
+    for (auto i = 0; i < 1000; ++i) v0[static_cast<size_t>(i)] = i;
+
+    IC_F("[997:1000000]", v0);
+    REQUIRE(str == "ic| v0: [997:1000000]->[997, 998, 999]\n");
+    str.clear();
+
+    IC_F("[1:1000:400]", v0);
+    REQUIRE(str == "ic| v0: [1:1000:400]->[1, 401, 801]\n");
+    str.clear();
+
+    IC_F("[-2::-450]", v0);
+    REQUIRE(str == "ic| v0: [-2::-450]->[998, 548, 98]\n");
+    str.clear();
+
+    IC_F("[11:-995:-3]", v0);
+    REQUIRE(str == "ic| v0: [11:-995:-3]->[11, 8]\n");
+}
+
+
 TEST_CASE("forward unknown size")
 {
     {
@@ -361,6 +431,100 @@ TEST_CASE("forward unknown size")
         IC_F("[3]", v0);
         REQUIRE(str == "ic| v0: [3]->[13]\n");
     }
+
+    {
+        IC_CONFIG_SCOPE();
+        auto str = std::string{};
+        IC_CONFIG.output(str);
+
+        auto v0 = std::forward_list<int>{10, 11, 12, 13, 14};
+        IC_F("[-1]", v0);
+        REQUIRE(str == "ic| v0: [-1]->[14]\n");
+        str.clear();
+
+        IC_F("[-2:]", v0);
+        REQUIRE(str == "ic| v0: [-2:]->[13, 14]\n");
+        str.clear();
+
+        IC_F("[-4:-1:2]", v0);
+        REQUIRE(str == "ic| v0: [-4:-1:2]->[11, 13]\n");
+        str.clear();
+
+        IC_F("[-10:2]", v0);
+        REQUIRE(str == "ic| v0: [-10:2]->[10, 11]\n");
+        str.clear();
+
+        IC_F("[1:-1]", v0);
+        REQUIRE(str == "ic| v0: [1:-1]->[11, 12, 13]\n");
+        str.clear();
+
+        IC_F("[:-3]", v0);
+        REQUIRE(str == "ic| v0: [:-3]->[10, 11]\n");
+        str.clear();
+
+        IC_F("[::3]", v0);
+        REQUIRE(str == "ic| v0: [::3]->[10, 13]\n");
+        str.clear();
+
+        IC_F("[:-1:3]", v0);
+        REQUIRE(str == "ic| v0: [:-1:3]->[10, 13]\n");
+        str.clear();
+
+        IC_F("[-3:-4]", v0);
+        REQUIRE(str == "ic| v0: [-3:-4]->[]\n");
+        str.clear();
+
+        auto v1 = std::forward_list<int>{};
+        IC_F("[-3:]", v1);
+        REQUIRE(str == "ic| v1: [-3:]->[]\n");
+    }
+}
+
+
+TEST_CASE("input unknown size")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = StreamRange{"10 11 12 13 14"};
+    IC_F("[-2:]", v0);
+    REQUIRE(str == "ic| v0: [-2:]->[13, 14]\n");
+    str.clear();
+
+    auto v1 = StreamRange{"10 11 12 13 14"};
+    IC_F("[:-2]", v1);
+    REQUIRE(str == "ic| v1: [:-2]->[10, 11, 12]\n");
+    str.clear();
+
+    auto v2 = StreamRange{"10 11 12 13 14 15 16"};
+    IC_F("[-6:-1:2]", v2);
+    REQUIRE(str == "ic| v2: [-6:-1:2]->[11, 13, 15]\n");
+}
+
+
+TEST_CASE("nonzero source positions")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto v0 = UnsizedList{{0, 5, 0, 7, 0, 9}};
+    IC_F("[::-1]nonzero", v0);
+    IC_F("[3:0:-2]nonzero", v0);
+
+    auto v1 = StreamRange{"0 5 0 7 0 9"};
+    IC_F("[:-1]nonzero", v1);
+
+    auto v2 = StreamRange{"0 5 0 7 0 9"};
+    IC_F("[-5::2]nonzero", v2);
+
+    auto const result =
+        "ic| v0: [::-1]->{5: 9, 3: 7, 1: 5}\n"
+        "ic| v0: [3:0:-2]->{3: 7, 1: 5}\n"
+        "ic| v1: [:-1]->{1: 5, 3: 7}\n"
+        "ic| v2: [-5::2]->{1: 5, 3: 7, 5: 9}\n";
+    REQUIRE(str == result);
 }
 
 
@@ -371,9 +535,11 @@ TEST_CASE("forward unknown size - wrong formatting")
         auto str = std::string{};
         IC_CONFIG.output(str);
 
-        auto v0 = std::forward_list<int>{10, 11, 12, 13, 14};
-        IC_F("[-1]", v0);
-        REQUIRE(str == "ic| \n    v0: <this range supports only non-negative start and stop slice indexes>\n");
+        auto v0 = UnsizedList{{10, 11, 12, 13, 14}};
+        IC_F("[-1::-1]", v0);
+        REQUIRE(
+            str == "ic| \n    v0: <this range supports negative slice indexes only with positive steps>\n"
+        );
     }
 
     {
@@ -508,6 +674,10 @@ TEST_CASE("forward known size")
         auto v0 = SizedForwardList{10, 11, 12, 13, 14};
         IC_F("[-3]", v0);
         REQUIRE(str == "ic| v0: [-3]->[12]\n");
+        str.clear();
+
+        IC_F("[-1]", v0);
+        REQUIRE(str == "ic| v0: [-1]->[14]\n");
     }
 }
 
@@ -534,3 +704,45 @@ TEST_CASE("forward known size - wrong formatting")
         REQUIRE(str == "ic| v0: <slice step cannot be zero>\n");
     }
 }
+
+
+TEST_CASE("key slicing")
+{
+    IC_CONFIG_SCOPE();
+    auto str = std::string{};
+    IC_CONFIG.output(str);
+
+    auto m0 = std::map<int, char>{{10, 'a'}, {20, 'b'}, {30, 'c'}, {40, 'd'}};
+    IC_F("{15..30}", m0);
+    REQUIRE(str == "ic| m0: {15..30}->[(20, 'b'), (30, 'c')]\n");
+    str.clear();
+
+    IC_F("{..20}:m", m0);
+    REQUIRE(str == "ic| m0: {..20}->[10: 'a', 20: 'b']\n");
+    str.clear();
+
+    IC_F("{ 35 .. }", m0);
+    REQUIRE(str == "ic| m0: { 35 .. }->[(40, 'd')]\n");
+    str.clear();
+
+    IC_F("{30..10}", m0);
+    REQUIRE(str == "ic| m0: {30..10}->[]\n");
+    str.clear();
+
+    IC_F("{a..10}", m0);
+    REQUIRE(str == "ic| m0: <invalid slicing key>\n");
+    str.clear();
+
+    IC_F("{10:20}", m0);
+    REQUIRE(str == "ic| m0: <invalid range slicing>\n");
+    str.clear();
+
+    auto s0 = std::set<std::string>{"apple", "banana", "cherry", "date"};
+    IC_F("{b..cz}", s0);
+    REQUIRE(str == "ic| s0: {b..cz}->[\"banana\", \"cherry\"]\n");
+    str.clear();
+
+    auto v0 = std::vector<int>{10, 20, 30};
+    IC_F("{10..20}", v0);
+    REQUIRE(str == "ic| v0: <this range doesn't support key slicing>\n");
+}